@@ -0,0 +1,10 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+/* Main function for the micro-benchmarks, which are all registered
+   through the BENCHMARK macros in the individual *_bench.cpp files.  */
+
+#include <benchmark/benchmark.h>
+
+BENCHMARK_MAIN ();
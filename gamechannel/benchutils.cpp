@@ -0,0 +1,145 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "benchutils.hpp"
+
+#include "stateproof.hpp"
+
+#include <xayautil/hash.hpp>
+
+#include <glog/logging.h>
+
+#include <sstream>
+
+namespace xaya
+{
+
+namespace
+{
+
+/**
+ * Returns the hash that is part of the signature of the given message
+ * with the given address.
+ */
+std::string
+SignatureHash (const std::string& addr, const std::string& msg)
+{
+  SHA256 hasher;
+  hasher << addr << std::string (1, '\0') << msg;
+  return hasher.Finalise ().GetBinaryString ();
+}
+
+/**
+ * Returns the board state in the addition game for the given number,
+ * with the turn count being the number of moves since BuildProof's start.
+ */
+BoardState
+AdditionBoardState (const int number)
+{
+  std::ostringstream out;
+  out << number << " " << (number - BenchChannel::START_NUMBER);
+  return out.str ();
+}
+
+} // anonymous namespace
+
+std::string
+HashSignatureVerifier::RecoverSigner (const std::string& msg,
+                                      const std::string& sgn) const
+{
+  if (sgn.size () < uint256::NUM_BYTES)
+    return "invalid";
+
+  const std::string addr = sgn.substr (uint256::NUM_BYTES);
+  if (sgn.compare (0, uint256::NUM_BYTES, SignatureHash (addr, msg)) != 0)
+    return "invalid";
+
+  return addr;
+}
+
+std::string
+HashSignatureSigner::SignMessage (const std::string& msg)
+{
+  return SignatureHash (address, msg) + address;
+}
+
+BenchChannel::BenchChannel (const unsigned participants)
+  : channelId(SHA256::Hash ("channel"))
+{
+  CHECK_GE (participants, 2);
+
+  meta.set_reinit ("reinit");
+  for (unsigned i = 0; i < participants; ++i)
+    {
+      const std::string suffix = std::to_string (i);
+      auto* p = meta.add_participants ();
+      p->set_name ("player " + suffix);
+      p->set_address ("addr " + suffix);
+      signers.push_back (std::make_unique<HashSignatureSigner> (p->address ()));
+    }
+}
+
+HashSignatureSigner&
+BenchChannel::GetSignerForTurn (const proto::StateProof& proof)
+{
+  const auto parsed
+      = rules.ParseState (channelId, meta, UnverifiedProofEndState (proof));
+  CHECK (parsed != nullptr);
+
+  const int turn = parsed->WhoseTurn ();
+  CHECK_NE (turn, ParsedBoardState::NO_TURN);
+
+  return GetSigner (turn);
+}
+
+proto::StateProof
+BenchChannel::BuildProof (const unsigned length)
+{
+  CHECK_LE (length, MAX_LENGTH);
+
+  proto::StateProof res;
+  auto* is = res.mutable_initial_state ();
+  is->set_data (AdditionBoardState (START_NUMBER));
+  for (int i = 0; i < meta.participants_size (); ++i)
+    CHECK (SignDataForParticipant (GetSigner (i), gameId, channelId, meta,
+                                   "state", i, *is));
+
+  for (unsigned i = 1; i <= length; ++i)
+    {
+      const int number = START_NUMBER + i;
+      auto* t = res.add_transitions ();
+      t->set_move ("1");
+      auto* ns = t->mutable_new_state ();
+      ns->set_data (AdditionBoardState (number));
+
+      const int turn = (number - 1) % 2;
+      CHECK (SignDataForParticipant (GetSigner (turn), gameId, channelId, meta,
+                                     "state", turn, *ns));
+    }
+
+  return res;
+}
+
+std::vector<proto::StateProof>
+BenchChannel::BuildProofSequence (const unsigned n)
+{
+  CHECK_GT (n, 0);
+  CHECK_LE (n, MAX_LENGTH + 1);
+
+  std::vector<proto::StateProof> res;
+  res.push_back (BuildProof (0));
+
+  while (res.size () < n)
+    {
+      proto::StateProof next;
+      CHECK (ExtendStateProof (verifier, GetSignerForTurn (res.back ()), rules,
+                               gameId, channelId, meta, res.back (), "1",
+                               next));
+      res.push_back (std::move (next));
+    }
+
+  return res;
+}
+
+} // namespace xaya
@@ -0,0 +1,141 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GAMECHANNEL_BENCHUTILS_HPP
+#define GAMECHANNEL_BENCHUTILS_HPP
+
+#include "boardrules.hpp"
+#include "signatures.hpp"
+#include "testrules.hpp"
+
+#include "proto/metadata.pb.h"
+#include "proto/stateproof.pb.h"
+
+#include <xayautil/uint256.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace xaya
+{
+
+/**
+ * Signature verifier for benchmarks.  It implements a trivial (and insecure)
+ * but deterministic and fast scheme:  The signature is the SHA-256 hash of
+ * address and message, followed by the address itself.  This way, the
+ * benchmarks measure the channel logic rather than elliptic-curve maths.
+ */
+class HashSignatureVerifier : public SignatureVerifier
+{
+
+public:
+
+  std::string RecoverSigner (const std::string& msg,
+                             const std::string& sgn) const override;
+
+};
+
+/**
+ * Signer matching HashSignatureVerifier.
+ */
+class HashSignatureSigner : public SignatureSigner
+{
+
+private:
+
+  /** The address we sign for.  */
+  const std::string address;
+
+public:
+
+  explicit HashSignatureSigner (const std::string& addr)
+    : address(addr)
+  {}
+
+  std::string
+  GetAddress () const override
+  {
+    return address;
+  }
+
+  std::string SignMessage (const std::string& msg) override;
+
+};
+
+/**
+ * Setup of a channel for the addition game (see testrules.hpp) with
+ * a given number of participants, each with their own HashSignatureSigner.
+ * Participant i is named "player i" and has address "addr i".  Since turns
+ * in the addition game alternate only between the first two participants,
+ * additional ones just increase the number of signatures that need to be
+ * present and checked on the initial states of proofs.
+ */
+class BenchChannel
+{
+
+private:
+
+  /** The signers for each participant.  */
+  std::vector<std::unique_ptr<HashSignatureSigner>> signers;
+
+public:
+
+  /** The number that BuildProof starts counting from.  */
+  static constexpr int START_NUMBER = 10;
+
+  /** The maximum length of proofs that can be built.  */
+  static constexpr unsigned MAX_LENGTH = 100 - START_NUMBER;
+
+  const std::string gameId = "game id";
+  const uint256 channelId;
+
+  /** The reinitialisation state of the channel.  */
+  const BoardState reinitState = "0 0";
+
+  AdditionRules rules;
+  HashSignatureVerifier verifier;
+  proto::ChannelMetadata meta;
+
+  explicit BenchChannel (unsigned participants);
+
+  BenchChannel () = delete;
+  BenchChannel (const BenchChannel&) = delete;
+  void operator= (const BenchChannel&) = delete;
+
+  /**
+   * Returns the signer for the given participant.
+   */
+  HashSignatureSigner&
+  GetSigner (const int index)
+  {
+    return *signers.at (index);
+  }
+
+  /**
+   * Returns the signer for the participant whose turn it is at the end of
+   * the given (valid) proof.
+   */
+  HashSignatureSigner& GetSignerForTurn (const proto::StateProof& proof);
+
+  /**
+   * Builds a state proof with the given number of transitions (each adding
+   * one to the number).  The initial state of the proof is signed by all
+   * participants, and each new state by the player who made the move.
+   */
+  proto::StateProof BuildProof (unsigned length);
+
+  /**
+   * Builds a list of the given number of proofs, where the first one is
+   * BuildProof (0) and each following one is the result of ExtendStateProof
+   * from the previous one.  This is the sequence of states exchanged in
+   * a typical channel.
+   */
+  std::vector<proto::StateProof> BuildProofSequence (unsigned n);
+
+};
+
+} // namespace xaya
+
+#endif // GAMECHANNEL_BENCHUTILS_HPP
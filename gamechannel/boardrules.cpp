@@ -1,12 +1,35 @@
-// Copyright (C) 2019 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "boardrules.hpp"
 
+#include "parsedstatecache.hpp"
+
+#include <glog/logging.h>
+
+#include <utility>
+
 namespace xaya
 {
 
+SharedBoardState::SharedBoardState (BoardState&& s)
+  : data(std::make_shared<const BoardState> (std::move (s)))
+{}
+
+SharedBoardState::SharedBoardState (const BoardState& s)
+  : data(std::make_shared<const BoardState> (s))
+{}
+
+const BoardState&
+SharedBoardState::Get () const
+{
+  static const BoardState empty;
+  if (data == nullptr)
+    return empty;
+  return *data;
+}
+
 constexpr int ParsedBoardState::NO_TURN;
 
 Json::Value
@@ -15,4 +38,48 @@ ParsedBoardState::ToJson () const
   return Json::Value ();
 }
 
+bool
+BoardRules::HasCanonicalEncoding () const
+{
+  return false;
+}
+
+void
+BoardRules::SetParsedStateCache (ParsedStateCache& c)
+{
+  CHECK (cache == nullptr);
+  CHECK_EQ (&c.GetBoardRules (), this);
+  cache = &c;
+}
+
+std::shared_ptr<const ParsedBoardState>
+BoardRules::ParseStateShared (const uint256& channelId,
+                              const proto::ChannelMetadata& meta,
+                              const BoardState& s) const
+{
+  if (cache != nullptr)
+    return cache->Get (channelId, meta, s);
+
+  return ParseState (channelId, meta, s);
+}
+
+std::unique_ptr<ParsedBoardState>
+BoardRules::ParseStateBuffer (const uint256& channelId,
+                              const proto::ChannelMetadata& meta,
+                              const SharedBoardState& s) const
+{
+  return ParseState (channelId, meta, s.Get ());
+}
+
+std::shared_ptr<const ParsedBoardState>
+BoardRules::ParseStateShared (const uint256& channelId,
+                              const proto::ChannelMetadata& meta,
+                              const SharedBoardState& s) const
+{
+  if (cache != nullptr)
+    return cache->Get (channelId, meta, s);
+
+  return ParseStateBuffer (channelId, meta, s);
+}
+
 } // namespace xaya
@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2022 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -19,6 +19,7 @@ namespace xaya
 {
 
 class BoardRules;
+class ParsedStateCache;
 
 /**
  * The state of the current game board, encoded in a game-specific format.
@@ -29,6 +30,66 @@ using BoardState = std::string;
 /** The game-specific encoded data of a move in a game channel.  */
 using BoardMove = std::string;
 
+/**
+ * Immutable, reference-counted buffer holding an encoded BoardState (or
+ * other data like a BoardMove).  Copies of an instance share the same bytes,
+ * so that e.g. a large state can be held by the framework, caches and parsed
+ * states at the same time without duplicating it.  Instances convert
+ * implicitly to const BoardState&, so that they can be passed to all the
+ * functions taking the plain string type.
+ */
+class SharedBoardState
+{
+
+private:
+
+  /** The underlying data.  Null for a default-constructed instance.  */
+  std::shared_ptr<const BoardState> data;
+
+public:
+
+  /**
+   * Constructs an instance holding empty data.
+   */
+  SharedBoardState () = default;
+
+  /**
+   * Constructs an instance taking over the given data without copying.
+   */
+  explicit SharedBoardState (BoardState&& s);
+
+  /**
+   * Constructs an instance holding a copy of the given data.
+   */
+  explicit SharedBoardState (const BoardState& s);
+
+  SharedBoardState (const SharedBoardState&) = default;
+  SharedBoardState (SharedBoardState&&) = default;
+  SharedBoardState& operator= (const SharedBoardState&) = default;
+  SharedBoardState& operator= (SharedBoardState&&) = default;
+
+  /**
+   * Returns the held data.
+   */
+  const BoardState& Get () const;
+
+  operator const BoardState& () const
+  {
+    return Get ();
+  }
+
+  /**
+   * Returns true if this instance shares the underlying buffer with
+   * the other one (rather than just holding equal data).
+   */
+  bool
+  SharesBufferWith (const SharedBoardState& other) const
+  {
+    return data == other.data;
+  }
+
+};
+
 /**
  * Interface for a game-specific "parsed" representation of a board state.
  * Instances of subclasses are obtained by parsing an (encoded) BoardState
@@ -165,6 +226,14 @@ public:
 class BoardRules
 {
 
+private:
+
+  /**
+   * If set, the cache used by ParseStateShared.  This is not owned by
+   * the BoardRules instance.
+   */
+  ParsedStateCache* cache = nullptr;
+
 protected:
 
   BoardRules () = default;
@@ -173,6 +242,35 @@ public:
 
   virtual ~BoardRules () = default;
 
+  /**
+   * Sets a cache for parsed states, which is then used by ParseStateShared.
+   * The cache must be for this BoardRules instance.
+   */
+  void SetParsedStateCache (ParsedStateCache& c);
+
+  /**
+   * Parses a state like ParseState, but returns a shared, immutable instance.
+   * If a ParsedStateCache is set, then the state is looked up in there
+   * and only parsed if it is not yet cached.  This is what the game-channel
+   * framework uses internally, so that states are not parsed more than once
+   * when verifying and processing them.
+   *
+   * The same guarantee as for ParseState holds with respect to the lifetime
+   * of the passed-in ID and metadata.  (Cached instances reference copies
+   * owned by the cache instead.)
+   */
+  std::shared_ptr<const ParsedBoardState> ParseStateShared (
+      const uint256& channelId, const proto::ChannelMetadata& meta,
+      const BoardState& s) const;
+
+  /**
+   * Parses a state held in a shared buffer like ParseStateShared, but
+   * using ParseStateBuffer if the state is not cached.
+   */
+  std::shared_ptr<const ParsedBoardState> ParseStateShared (
+      const uint256& channelId, const proto::ChannelMetadata& meta,
+      const SharedBoardState& s) const;
+
   /**
    * Parses an encoded BoardState into a ParsedBoardState instance, which
    * implements the abstract methods suitably for the game at hand.
@@ -188,6 +286,29 @@ public:
       const uint256& channelId, const proto::ChannelMetadata& meta,
       const BoardState& s) const = 0;
 
+  /**
+   * Parses an encoded state held in a shared buffer.  Games whose parsed
+   * states keep the encoded data (or parts of it) around can override this
+   * to reference the buffer instead of copying the data.  The default
+   * implementation just calls ParseState.
+   */
+  virtual std::unique_ptr<ParsedBoardState> ParseStateBuffer (
+      const uint256& channelId, const proto::ChannelMetadata& meta,
+      const SharedBoardState& s) const;
+
+  /**
+   * Returns true if the game uses a canonical encoding for board states,
+   * i.e. one where byte-identical encoded states always represent the same
+   * state.  In that case, the framework compares encoded states directly
+   * where it can (e.g. the claimed new state of a state transition against
+   * the result of ApplyMove), and only falls back to ParsedBoardState::Equals
+   * if the bytes differ.  The default implementation returns false.
+   *
+   * Games should only return true if their Equals is guaranteed to return
+   * true when called on an instance parsed from identical data.
+   */
+  virtual bool HasCanonicalEncoding () const;
+
   /**
    * Returns the version to apply for StateProof protos when a channel has
    * the given metadata.
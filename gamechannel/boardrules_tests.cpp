@@ -0,0 +1,81 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "boardrules.hpp"
+
+#include "testgame.hpp"
+
+#include <xayautil/hash.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+
+namespace xaya
+{
+namespace
+{
+
+TEST (SharedBoardStateTests, Empty)
+{
+  const SharedBoardState empty;
+  EXPECT_EQ (empty.Get (), "");
+  EXPECT_TRUE (empty.SharesBufferWith (SharedBoardState ()));
+}
+
+TEST (SharedBoardStateTests, CopiesShareBuffer)
+{
+  std::string data(10'000, 'x');
+  const char* ptr = data.data ();
+
+  const SharedBoardState a(std::move (data));
+  EXPECT_EQ (a.Get ().data (), ptr);
+  EXPECT_EQ (a.Get (), std::string (10'000, 'x'));
+
+  const SharedBoardState b = a;
+  EXPECT_TRUE (b.SharesBufferWith (a));
+  EXPECT_EQ (b.Get ().data (), ptr);
+
+  const SharedBoardState c(a.Get ());
+  EXPECT_FALSE (c.SharesBufferWith (a));
+  EXPECT_EQ (c.Get (), a.Get ());
+}
+
+TEST (SharedBoardStateTests, ConvertsToBoardState)
+{
+  const SharedBoardState s(std::string ("foo"));
+  const BoardState& ref = s;
+  EXPECT_EQ (&ref, &s.Get ());
+}
+
+class ParseStateBufferTests : public TestGameFixture
+{
+
+protected:
+
+  const uint256 channelId = SHA256::Hash ("channel id");
+  proto::ChannelMetadata meta;
+
+};
+
+TEST_F (ParseStateBufferTests, DefaultUsesParseState)
+{
+  const SharedBoardState s(std::string ("10 5"));
+
+  const auto parsed = game.rules.ParseStateBuffer (channelId, meta, s);
+  ASSERT_NE (parsed, nullptr);
+  EXPECT_EQ (parsed->TurnCount (), 5);
+
+  const auto shared = game.rules.ParseStateShared (channelId, meta, s);
+  ASSERT_NE (shared, nullptr);
+  EXPECT_TRUE (shared->Equals ("10 5"));
+
+  EXPECT_EQ (game.rules.ParseStateShared (channelId, meta,
+                                          SharedBoardState (std::string ("x"))),
+             nullptr);
+}
+
+} // anonymous namespace
+} // namespace xaya
@@ -0,0 +1,172 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "broadcastrelay.hpp"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <map>
+
+namespace xaya
+{
+
+BroadcastRelay::BroadcastRelay ()
+  : BroadcastRelay(Options ())
+{}
+
+BroadcastRelay::BroadcastRelay (const Options& o)
+  : options(o)
+{
+  CHECK_GT (options.bufferSize, 0);
+  CHECK_GT (options.maxBatch, 0);
+}
+
+const BroadcastRelay::Channel*
+BroadcastRelay::GetChannel (const std::string& id) const
+{
+  const auto mit = channels.find (id);
+  if (mit == channels.end ())
+    return nullptr;
+  return &mit->second;
+}
+
+Json::Value
+BroadcastRelay::BuildResult (const Channel* ch, const uint64_t fromSeq) const
+{
+  const uint64_t seq = (ch == nullptr ? 0 : ch->seq);
+
+  Json::Value res(Json::objectValue);
+  Json::Value messages(Json::arrayValue);
+
+  if (fromSeq >= seq)
+    {
+      res["seq"] = static_cast<Json::UInt64> (seq);
+      res["messages"] = messages;
+      return res;
+    }
+
+  const uint64_t oldest = seq - std::min<uint64_t> (seq, ch->messages.size ());
+  const uint64_t start = std::max (fromSeq, oldest);
+  LOG_IF (WARNING, start > fromSeq)
+      << "Client is behind by " << (seq - fromSeq) << " messages, "
+      << (start - fromSeq) << " of them are no longer available";
+
+  const uint64_t end = std::min<uint64_t> (seq, start + options.maxBatch);
+  for (uint64_t i = start; i < end; ++i)
+    messages.append (ch->messages[i % options.bufferSize]);
+
+  res["seq"] = static_cast<Json::UInt64> (end);
+  res["messages"] = messages;
+  return res;
+}
+
+uint64_t
+BroadcastRelay::Send (const std::string& channel, const std::string& msg)
+{
+  auto& ch = channels[channel];
+
+  if (ch.messages.size () < options.bufferSize)
+    {
+      CHECK_EQ (ch.messages.size (), ch.seq);
+      ch.messages.push_back (msg);
+    }
+  else
+    ch.messages[ch.seq % options.bufferSize] = msg;
+  ++ch.seq;
+
+  if (!ch.waiters.empty () && !ch.pending)
+    {
+      ch.pending = true;
+      pendingChannels.push_back (channel);
+    }
+
+  return ch.seq;
+}
+
+uint64_t
+BroadcastRelay::GetSeq (const std::string& channel) const
+{
+  const auto* ch = GetChannel (channel);
+  return ch == nullptr ? 0 : ch->seq;
+}
+
+bool
+BroadcastRelay::CanReceive (const std::string& channel,
+                            const uint64_t fromSeq) const
+{
+  return fromSeq != GetSeq (channel);
+}
+
+Json::Value
+BroadcastRelay::Receive (const std::string& channel,
+                         const uint64_t fromSeq) const
+{
+  return BuildResult (GetChannel (channel), fromSeq);
+}
+
+void
+BroadcastRelay::AddWaiter (const std::string& channel, const WaiterId id,
+                           const uint64_t fromSeq)
+{
+  channels[channel].waiters.push_back ({id, fromSeq});
+}
+
+void
+BroadcastRelay::RemoveWaiter (const std::string& channel, const WaiterId id)
+{
+  const auto mit = channels.find (channel);
+  if (mit == channels.end ())
+    return;
+
+  auto& waiters = mit->second.waiters;
+  waiters.erase (std::remove_if (waiters.begin (), waiters.end (),
+                                 [id] (const Waiter& w) { return w.id == id; }),
+                 waiters.end ());
+}
+
+std::vector<BroadcastRelay::ReadyWaiter>
+BroadcastRelay::TakeReadyWaiters ()
+{
+  readyResults.clear ();
+  std::vector<ReadyWaiter> res;
+
+  for (const auto& id : pendingChannels)
+    {
+      auto& ch = channels.at (id);
+      CHECK (ch.pending);
+      ch.pending = false;
+
+      /* Waiters at the same position (typically all of them, since they
+         are all up-to-date) share the result.  */
+      std::map<uint64_t, const Json::Value*> resultsBySeq;
+      std::vector<Waiter> remaining;
+      for (const auto& w : ch.waiters)
+        {
+          if (w.fromSeq >= ch.seq)
+            {
+              remaining.push_back (w);
+              continue;
+            }
+
+          auto& result = resultsBySeq[w.fromSeq];
+          if (result == nullptr)
+            {
+              readyResults.push_back (BuildResult (&ch, w.fromSeq));
+              result = &readyResults.back ();
+            }
+          res.push_back ({w.id, result});
+        }
+      ch.waiters = std::move (remaining);
+    }
+  pendingChannels.clear ();
+
+  VLOG_IF (1, !res.empty ())
+      << "Delivering " << readyResults.size () << " distinct results to "
+      << res.size () << " waiting clients";
+
+  return res;
+}
+
+} // namespace xaya
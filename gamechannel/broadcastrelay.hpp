@@ -0,0 +1,202 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GAMECHANNEL_BROADCASTRELAY_HPP
+#define GAMECHANNEL_BROADCASTRELAY_HPP
+
+#include <json/json.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace xaya
+{
+
+/**
+ * The state of an off-chain broadcast relay, as used with RpcBroadcast:
+ * Messages sent to each channel are numbered by a sequence counter, and
+ * clients ask for all messages starting at some sequence number.
+ *
+ * Each channel keeps only the most recent messages in a ring buffer indexed
+ * by sequence number.  Clients that fall behind by more than the buffer size
+ * miss the oldest messages, which is fine for game channels since every
+ * message contains a full state proof anyway.
+ *
+ * Besides the messages, this also keeps track of clients waiting (through
+ * long-polling) for new messages on a channel.  Sending marks a channel for
+ * delivery, and TakeReadyWaiters then returns all waiters of channels that
+ * received messages since the last call.  That way, only the waiters of
+ * affected channels are woken up, and many messages sent in quick
+ * succession are delivered in a single batch.
+ *
+ * This class is not thread-safe.
+ */
+class BroadcastRelay
+{
+
+public:
+
+  /** Identifier for waiting clients, chosen by the user of this class.  */
+  using WaiterId = uint64_t;
+
+  /**
+   * Configuration options.
+   */
+  struct Options
+  {
+
+    /** Number of messages kept per channel.  */
+    size_t bufferSize = 1024;
+
+    /** Maximum number of messages returned in a single result.  */
+    size_t maxBatch = 256;
+
+  };
+
+  /**
+   * A waiting client that can be answered now.
+   */
+  struct ReadyWaiter
+  {
+
+    /** The waiter's ID.  */
+    WaiterId id;
+
+    /** The result to send to it.  */
+    const Json::Value* result;
+
+  };
+
+private:
+
+  /**
+   * Data for a client waiting on a channel.
+   */
+  struct Waiter
+  {
+
+    WaiterId id;
+    uint64_t fromSeq;
+
+  };
+
+  /**
+   * Data kept for each channel.
+   */
+  struct Channel
+  {
+
+    /** The current sequence number (i.e. number of messages sent).  */
+    uint64_t seq = 0;
+
+    /**
+     * The ring buffer of messages.  The message that increased the sequence
+     * number to n + 1 is at index n % bufferSize.  The buffer grows
+     * up to bufferSize as messages are sent.
+     */
+    std::vector<std::string> messages;
+
+    /** Clients waiting for new messages.  */
+    std::vector<Waiter> waiters;
+
+    /** Whether the channel is in the list of pending deliveries.  */
+    bool pending = false;
+
+  };
+
+  /** The configuration options.  */
+  const Options options;
+
+  /** The channels by ID.  */
+  std::unordered_map<std::string, Channel> channels;
+
+  /** Channels that have been sent messages since the last delivery.  */
+  std::vector<std::string> pendingChannels;
+
+  /**
+   * Results built in TakeReadyWaiters.  They are kept until the next call,
+   * so that waiters for the same position share the same result.
+   */
+  std::deque<Json::Value> readyResults;
+
+  /**
+   * Returns the channel with the given ID if it exists, and null otherwise.
+   */
+  const Channel* GetChannel (const std::string& id) const;
+
+  /**
+   * Builds the receive result for a channel from the given sequence number.
+   */
+  Json::Value BuildResult (const Channel* ch, uint64_t fromSeq) const;
+
+public:
+
+  BroadcastRelay ();
+  explicit BroadcastRelay (const Options& o);
+
+  BroadcastRelay (const BroadcastRelay&) = delete;
+  void operator= (const BroadcastRelay&) = delete;
+
+  /**
+   * Adds a message to the given channel.  Returns the new sequence number.
+   */
+  uint64_t Send (const std::string& channel, const std::string& msg);
+
+  /**
+   * Returns the current sequence number of a channel.
+   */
+  uint64_t GetSeq (const std::string& channel) const;
+
+  /**
+   * Returns true if a receive call from the given sequence number
+   * can be answered right away, i.e. without waiting.  This is the case
+   * if there are messages from that position on, and also if fromSeq
+   * is beyond the current sequence number (which happens if the relay
+   * has been restarted).
+   */
+  bool CanReceive (const std::string& channel, uint64_t fromSeq) const;
+
+  /**
+   * Returns the result for a receive call:  A JSON object with the "seq"
+   * for the next call and the "messages" from fromSeq on.  If there are
+   * no messages, the array is empty.
+   */
+  Json::Value Receive (const std::string& channel, uint64_t fromSeq) const;
+
+  /**
+   * Registers a waiter for messages on a channel.
+   */
+  void AddWaiter (const std::string& channel, WaiterId id, uint64_t fromSeq);
+
+  /**
+   * Removes a waiter again (e.g. after a timeout).  Does nothing if the
+   * waiter is not registered (e.g. it has been returned already).
+   */
+  void RemoveWaiter (const std::string& channel, WaiterId id);
+
+  /**
+   * Returns all waiters that can be answered due to messages sent since
+   * the last call, and unregisters them.  The results remain valid until
+   * the next call.
+   */
+  std::vector<ReadyWaiter> TakeReadyWaiters ();
+
+  /**
+   * Returns the number of channels that have been used.
+   */
+  size_t
+  GetNumChannels () const
+  {
+    return channels.size ();
+  }
+
+};
+
+} // namespace xaya
+
+#endif // GAMECHANNEL_BROADCASTRELAY_HPP
@@ -0,0 +1,178 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "broadcastrelay.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace xaya
+{
+namespace
+{
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+class BroadcastRelayTests : public testing::Test
+{
+
+protected:
+
+  BroadcastRelay::Options options;
+
+  BroadcastRelayTests ()
+  {
+    options.bufferSize = 4;
+    options.maxBatch = 3;
+  }
+
+  /**
+   * Extracts the messages from a receive result.
+   */
+  static std::vector<std::string>
+  Messages (const Json::Value& result)
+  {
+    std::vector<std::string> res;
+    for (const auto& m : result["messages"])
+      res.push_back (m.asString ());
+    return res;
+  }
+
+  /**
+   * Takes the ready waiters and returns their messages by ID.
+   */
+  static std::map<BroadcastRelay::WaiterId, std::vector<std::string>>
+  TakeReady (BroadcastRelay& relay)
+  {
+    std::map<BroadcastRelay::WaiterId, std::vector<std::string>> res;
+    for (const auto& w : relay.TakeReadyWaiters ())
+      res[w.id] = Messages (*w.result);
+    return res;
+  }
+
+};
+
+TEST_F (BroadcastRelayTests, SendAndReceive)
+{
+  BroadcastRelay relay(options);
+  EXPECT_EQ (relay.GetSeq ("a"), 0);
+  EXPECT_FALSE (relay.CanReceive ("a", 0));
+
+  EXPECT_EQ (relay.Send ("a", "foo"), 1);
+  EXPECT_EQ (relay.Send ("a", "bar"), 2);
+  EXPECT_EQ (relay.Send ("b", "baz"), 1);
+  EXPECT_EQ (relay.GetSeq ("a"), 2);
+  EXPECT_EQ (relay.GetNumChannels (), 2);
+
+  EXPECT_TRUE (relay.CanReceive ("a", 1));
+  EXPECT_FALSE (relay.CanReceive ("a", 2));
+
+  auto res = relay.Receive ("a", 0);
+  EXPECT_EQ (res["seq"].asUInt64 (), 2);
+  EXPECT_THAT (Messages (res), ElementsAre ("foo", "bar"));
+
+  res = relay.Receive ("a", 1);
+  EXPECT_EQ (res["seq"].asUInt64 (), 2);
+  EXPECT_THAT (Messages (res), ElementsAre ("bar"));
+
+  res = relay.Receive ("a", 2);
+  EXPECT_EQ (res["seq"].asUInt64 (), 2);
+  EXPECT_THAT (Messages (res), IsEmpty ());
+
+  res = relay.Receive ("b", 0);
+  EXPECT_THAT (Messages (res), ElementsAre ("baz"));
+}
+
+TEST_F (BroadcastRelayTests, ClientAhead)
+{
+  BroadcastRelay relay(options);
+  relay.Send ("a", "foo");
+
+  EXPECT_TRUE (relay.CanReceive ("a", 5));
+  const auto res = relay.Receive ("a", 5);
+  EXPECT_EQ (res["seq"].asUInt64 (), 1);
+  EXPECT_THAT (Messages (res), IsEmpty ());
+}
+
+TEST_F (BroadcastRelayTests, RingBufferAndBatches)
+{
+  BroadcastRelay relay(options);
+  for (unsigned i = 1; i <= 7; ++i)
+    relay.Send ("a", "msg " + std::to_string (i));
+
+  /* Only the last four messages are kept, and at most three are
+     returned per call.  */
+  auto res = relay.Receive ("a", 0);
+  EXPECT_EQ (res["seq"].asUInt64 (), 6);
+  EXPECT_THAT (Messages (res), ElementsAre ("msg 4", "msg 5", "msg 6"));
+
+  res = relay.Receive ("a", 6);
+  EXPECT_EQ (res["seq"].asUInt64 (), 7);
+  EXPECT_THAT (Messages (res), ElementsAre ("msg 7"));
+
+  res = relay.Receive ("a", 5);
+  EXPECT_THAT (Messages (res), ElementsAre ("msg 6", "msg 7"));
+}
+
+TEST_F (BroadcastRelayTests, WaitersOnlyOnAffectedChannel)
+{
+  BroadcastRelay relay(options);
+  relay.AddWaiter ("a", 1, 0);
+  relay.AddWaiter ("a", 2, 0);
+  relay.AddWaiter ("b", 3, 0);
+  EXPECT_THAT (TakeReady (relay), IsEmpty ());
+
+  relay.Send ("a", "foo");
+  relay.Send ("a", "bar");
+  const auto ready = TakeReady (relay);
+  ASSERT_EQ (ready.size (), 2);
+  EXPECT_THAT (ready.at (1), ElementsAre ("foo", "bar"));
+  EXPECT_THAT (ready.at (2), ElementsAre ("foo", "bar"));
+  EXPECT_THAT (TakeReady (relay), IsEmpty ());
+
+  relay.Send ("b", "baz");
+  EXPECT_THAT (TakeReady (relay).at (3), ElementsAre ("baz"));
+}
+
+TEST_F (BroadcastRelayTests, SharedResults)
+{
+  BroadcastRelay relay(options);
+  relay.Send ("a", "foo");
+  relay.AddWaiter ("a", 1, 1);
+  relay.AddWaiter ("a", 2, 1);
+  relay.AddWaiter ("a", 3, 5);
+
+  relay.Send ("a", "bar");
+  const auto ready = relay.TakeReadyWaiters ();
+  ASSERT_EQ (ready.size (), 2);
+  EXPECT_EQ (ready[0].result, ready[1].result);
+  EXPECT_THAT (Messages (*ready[0].result), ElementsAre ("bar"));
+
+  /* The waiter that is ahead is kept.  */
+  relay.Send ("a", "baz");
+  EXPECT_THAT (TakeReady (relay), IsEmpty ());
+}
+
+TEST_F (BroadcastRelayTests, RemoveWaiter)
+{
+  BroadcastRelay relay(options);
+  relay.AddWaiter ("a", 1, 0);
+  relay.AddWaiter ("a", 2, 0);
+  relay.RemoveWaiter ("a", 1);
+  relay.RemoveWaiter ("a", 42);
+  relay.RemoveWaiter ("b", 2);
+
+  relay.Send ("a", "foo");
+  const auto ready = TakeReady (relay);
+  ASSERT_EQ (ready.size (), 1);
+  EXPECT_EQ (ready.count (2), 1);
+}
+
+} // anonymous namespace
+} // namespace xaya
@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2022 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -11,9 +11,8 @@ namespace xaya
 {
 
 ChannelManager::DisputeData::DisputeData ()
-{
-  pendingResolution.SetNull ();
-}
+  : resolutionCount(0)
+{}
 
 ChannelManager::ChannelManager (const BoardRules& r, OpenChannel& oc,
                                 const SignatureVerifier& v, SignatureSigner& s,
@@ -24,8 +23,15 @@ ChannelManager::ChannelManager (const BoardRules& r, OpenChannel& oc,
     boardStates(rules, verifier, gameId, channelId)
 {
   blockHash.SetNull ();
-  pendingPutStateOnChain.SetNull ();
-  pendingDispute.SetNull ();
+}
+
+const ParsedBoardState*
+ChannelManager::GetLatestParsedState () const
+{
+  if (!exists)
+    return nullptr;
+
+  return &boardStates.GetLatestState ();
 }
 
 void
@@ -43,6 +49,23 @@ ChannelManager::SetMoveSender (MoveSender& s)
 }
 
 void
+ChannelManager::SetTraceRecorder (TraceRecorder& r)
+{
+  CHECK (recorder == nullptr);
+  recorder = &r;
+}
+
+proto::StateProof
+ChannelManager::GetMinimalStateProof () const
+{
+  proto::StateProof res;
+  MinimiseStateProof (verifier, boardStates.GetParticipantKeys (),
+                      gameId, channelId, boardStates.GetMetadata (),
+                      boardStates.GetStateProof (), res);
+  return res;
+}
+
+bool
 ChannelManager::TryResolveDispute ()
 {
   VLOG (1)
@@ -52,17 +75,18 @@ ChannelManager::TryResolveDispute ()
   if (!exists)
     {
       VLOG (1) << "This channel does not exist on-chain";
-      return;
+      return false;
     }
   if (dispute == nullptr)
     {
       VLOG (1) << "There is no dispute for the channel";
-      return;
+      return false;
     }
-  if (!dispute->pendingResolution.IsNull ())
+  const bool queued = dispute->pendingResolution.IsQueued ();
+  if (!dispute->pendingResolution.IsNull () && !queued)
     {
       VLOG (1) << "There may be a pending resolution already";
-      return;
+      return false;
     }
 
   CHECK_NE (dispute->turn, ParsedBoardState::NO_TURN);
@@ -75,7 +99,7 @@ ChannelManager::TryResolveDispute ()
       VLOG (1)
           << "Disputed player is " << disputedPlayer
           << ", we are " << playerName;
-      return;
+      return false;
     }
 
   const unsigned latestCnt = boardStates.GetLatestState ().TurnCount ();
@@ -84,7 +108,14 @@ ChannelManager::TryResolveDispute ()
       VLOG (1)
           << "We have no better state than the disputed turn count "
           << dispute->count;
-      return;
+      return false;
+    }
+  if (queued && latestCnt <= dispute->resolutionCount)
+    {
+      VLOG (1)
+          << "A resolution for turn count " << dispute->resolutionCount
+          << " is queued already";
+      return false;
     }
 
   LOG (INFO)
@@ -94,7 +125,10 @@ ChannelManager::TryResolveDispute ()
       << " (dispute: " << dispute->count << ")";
   CHECK (onChainSender != nullptr);
   dispute->pendingResolution
-      = onChainSender->SendResolution (boardStates.GetStateProof ());
+      = onChainSender->RequestResolution (GetMinimalStateProof ());
+  dispute->resolutionCount = latestCnt;
+
+  return true;
 }
 
 bool
@@ -161,6 +195,9 @@ void
 ChannelManager::ProcessOffChain (const std::string& reinitId,
                                  const proto::StateProof& proof)
 {
+  if (recorder != nullptr)
+    recorder->RecordOffChain (reinitId, proof);
+
   if (!boardStates.UpdateWithMove (reinitId, proof))
     return;
 
@@ -170,6 +207,9 @@ ChannelManager::ProcessOffChain (const std::string& reinitId,
 void
 ChannelManager::ProcessOnChainNonExistant (const uint256& blk, const unsigned h)
 {
+  if (recorder != nullptr)
+    recorder->RecordOnChainNonExistant (blk, h);
+
   LOG_IF (INFO, exists)
       << "Channel " << channelId.ToHex () << " no longer exists on-chain";
 
@@ -192,17 +232,29 @@ namespace
 /**
  * If a txid is non-null, check if it is pending.  If it is not,
  * reset it to null.  This is the common logic we apply for disputes and
- * resolutions when a new block comes in.
+ * resolutions when a new block comes in.  Moves that are still queued
+ * for sending are kept as they are.
  */
 void
-ResetMinedTxid (MoveSender* sender, uint256& txid)
+ResetMinedTxid (MoveSender* sender, PendingMove& mv)
 {
-  if (txid.IsNull ())
-    return;
+  if (mv.IsNull ())
+    {
+      mv.SetNull ();
+      return;
+    }
 
   /* Somehow we must have sent the previous tx!  */
   CHECK (sender != nullptr);
 
+  if (mv.IsQueued ())
+    {
+      LOG (INFO) << "Move is still queued for sending";
+      return;
+    }
+
+  const uint256 txid = mv.GetTxid ();
+
   if (sender->IsPending (txid))
     {
       LOG (INFO) << "Transaction " << txid.ToHex () << " is still pending";
@@ -210,7 +262,37 @@ ResetMinedTxid (MoveSender* sender, uint256& txid)
     }
 
   LOG (INFO) << "Transaction " << txid.ToHex () << " is no longer pending";
-  txid.SetNull ();
+  mv.SetNull ();
+}
+
+/**
+ * Returns the txid to report to callers for a move that was just requested.
+ * This is null if the move is still queued.
+ */
+uint256
+RequestedTxid (const PendingMove& mv)
+{
+  if (mv.IsQueued ())
+    {
+      LOG (INFO) << "The move has been queued for sending";
+      uint256 res;
+      res.SetNull ();
+      return res;
+    }
+
+  return mv.GetTxid ();
+}
+
+/**
+ * Adds the txid of a pending move to the JSON object of pending moves
+ * for ToJson, if the txid is known.
+ */
+void
+AddPendingTxid (Json::Value& pending, const std::string& key,
+                const PendingMove& mv)
+{
+  if (!mv.IsQueued () && !mv.IsNull ())
+    pending[key] = mv.GetTxid ().ToHex ();
 }
 
 } // anonymous namespace
@@ -222,6 +304,85 @@ ChannelManager::ProcessOnChain (const uint256& blk, const unsigned h,
                                 const proto::StateProof& proof,
                                 const unsigned disputeHeight)
 {
+  ProcessOnChainInternal (blk, h, meta, reinitState, proof, disputeHeight,
+                          false);
+}
+
+void
+ChannelManager::VerifyOnChain (const proto::ChannelMetadata& meta,
+                               const BoardState& reinitState,
+                               const proto::StateProof& proof) const
+{
+  boardStates.VerifyOnChain (meta, reinitState, proof);
+}
+
+bool
+ChannelManager::ProcessOnChainUnchanged (const uint256& blk, const unsigned h)
+{
+  if (recorder != nullptr)
+    return false;
+
+  VLOG (1)
+      << "Channel " << channelId.ToHex ()
+      << " is unchanged on-chain at height " << h;
+
+  blockHash = blk;
+  onChainHeight = h;
+
+  if (!exists)
+    {
+      NotifyStateChange ();
+      return true;
+    }
+
+  /* The state itself is the same as before, but we still have to do all
+     the per-block work that ProcessOnChain would do as well:  Check which
+     of our transactions are no longer pending, retry dispute resolutions
+     and give the game a chance to (re)send on-chain moves.  */
+  ResetMinedTxid (onChainSender, pendingPutStateOnChain);
+  ResetMinedTxid (onChainSender, pendingDispute);
+  if (dispute != nullptr)
+    ResetMinedTxid (onChainSender, dispute->pendingResolution);
+
+  ProcessStateUpdate (false);
+
+  return true;
+}
+
+unsigned
+ChannelManager::GetDisputeHeight () const
+{
+  if (!exists || dispute == nullptr)
+    return 0;
+
+  return dispute->height;
+}
+
+bool
+ChannelManager::RetryDisputeResolution ()
+{
+  if (!exists || dispute == nullptr)
+    return false;
+
+  ResetMinedTxid (onChainSender, dispute->pendingResolution);
+  if (!TryResolveDispute ())
+    return false;
+
+  NotifyStateChange ();
+  return true;
+}
+
+void
+ChannelManager::ProcessOnChainInternal (const uint256& blk, const unsigned h,
+                                        const proto::ChannelMetadata& meta,
+                                        const BoardState& reinitState,
+                                        const proto::StateProof& proof,
+                                        const unsigned disputeHeight,
+                                        const bool verified)
+{
+  if (recorder != nullptr)
+    recorder->RecordOnChain (blk, h, meta, reinitState, proof, disputeHeight);
+
   LOG_IF (INFO, !exists)
       << "Channel " << channelId.ToHex () << " is now found on-chain";
 
@@ -231,7 +392,7 @@ ChannelManager::ProcessOnChain (const uint256& blk, const unsigned h,
   ResetMinedTxid (onChainSender, pendingPutStateOnChain);
   ResetMinedTxid (onChainSender, pendingDispute);
   exists = true;
-  boardStates.UpdateOnChain (meta, reinitState, proof);
+  boardStates.UpdateOnChain (meta, reinitState, proof, verified);
 
   if (disputeHeight == 0)
     {
@@ -252,8 +413,8 @@ ChannelManager::ProcessOnChain (const uint256& blk, const unsigned h,
       dispute->height = disputeHeight;
       ResetMinedTxid (onChainSender, dispute->pendingResolution);
 
-      auto p = rules.ParseState (channelId, meta,
-                                 UnverifiedProofEndState (proof));
+      auto p = rules.ParseStateShared (channelId, meta,
+                                       UnverifiedProofEndState (proof));
       dispute->turn = p->WhoseTurn ();
       dispute->count = p->TurnCount ();
     }
@@ -272,7 +433,8 @@ ChannelManager::ApplyLocalMove (const BoardMove& mv)
   CHECK (exists);
 
   proto::StateProof newProof;
-  if (!ExtendStateProof (verifier, signer, rules, gameId, channelId,
+  if (!ExtendStateProof (verifier, boardStates.GetParticipantKeys (), signer,
+                         rules, gameId, channelId,
                          boardStates.GetMetadata (),
                          boardStates.GetStateProof (), mv, newProof))
     {
@@ -290,6 +452,9 @@ ChannelManager::ApplyLocalMove (const BoardMove& mv)
 void
 ChannelManager::ProcessLocalMove (const BoardMove& mv)
 {
+  if (recorder != nullptr)
+    recorder->RecordLocalMove (mv);
+
   LOG (INFO) << "Local move: " << mv;
 
   if (!exists)
@@ -307,6 +472,9 @@ ChannelManager::ProcessLocalMove (const BoardMove& mv)
 void
 ChannelManager::TriggerAutoMoves ()
 {
+  if (recorder != nullptr)
+    recorder->RecordTriggerAutoMoves ();
+
   if (!exists)
     {
       LOG (INFO) << "Channel does not exist on chain, not triggering automoves";
@@ -354,8 +522,8 @@ ChannelManager::PutStateOnChain ()
 
   CHECK (onChainSender != nullptr);
   pendingPutStateOnChain
-      = onChainSender->SendResolution (boardStates.GetStateProof ());
-  return pendingPutStateOnChain;
+      = onChainSender->RequestResolution (GetMinimalStateProof ());
+  return RequestedTxid (pendingPutStateOnChain);
 }
 
 uint256
@@ -383,8 +551,8 @@ ChannelManager::FileDispute ()
     }
 
   CHECK (onChainSender != nullptr);
-  pendingDispute = onChainSender->SendDispute (boardStates.GetStateProof ());
-  return pendingDispute;
+  pendingDispute = onChainSender->RequestDispute (GetMinimalStateProof ());
+  return RequestedTxid (pendingDispute);
 }
 
 Json::Value
@@ -426,12 +594,10 @@ ChannelManager::ToJson () const
     }
 
   Json::Value pending(Json::objectValue);
-  if (!pendingPutStateOnChain.IsNull ())
-    pending["putstateonchain"] = pendingPutStateOnChain.ToHex ();
-  if (!pendingDispute.IsNull ())
-    pending["dispute"] = pendingDispute.ToHex ();
-  if (dispute != nullptr && !dispute->pendingResolution.IsNull ())
-    pending["resolution"] = dispute->pendingResolution.ToHex ();
+  AddPendingTxid (pending, "putstateonchain", pendingPutStateOnChain);
+  AddPendingTxid (pending, "dispute", pendingDispute);
+  if (dispute != nullptr)
+    AddPendingTxid (pending, "resolution", dispute->pendingResolution);
   res["pending"] = pending;
 
   return res;
@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2022 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -7,6 +7,7 @@
 
 #include "boardrules.hpp"
 #include "broadcast.hpp"
+#include "channeltrace.hpp"
 #include "movesender.hpp"
 #include "openchannel.hpp"
 #include "rollingstate.hpp"
@@ -67,7 +68,14 @@ private:
      * The transaction ID of a sent resolution.  When there is no pending
      * resolution transaction, this is null.
      */
-    uint256 pendingResolution;
+    PendingMove pendingResolution;
+
+    /**
+     * The turn count of the state proof used for pendingResolution.  This
+     * is used to replace a resolution that is still queued for sending
+     * when a better state becomes known.
+     */
+    unsigned resolutionCount;
 
     DisputeData ();
 
@@ -113,6 +121,12 @@ private:
    */
   MoveSender* onChainSender = nullptr;
 
+  /**
+   * If set, then all input events (on-chain and off-chain updates as well
+   * as local moves) are recorded to this trace.
+   */
+  TraceRecorder* recorder = nullptr;
+
   /**
    * Version counter for the current state.  Whenever the state is changed,
    * this value is incremented.  It can be used to identify a certain state,
@@ -141,13 +155,13 @@ private:
    * null if there is none.  If multiple put-on-chain requests are sent,
    * this corresponds to the latest.
    */
-  uint256 pendingPutStateOnChain;
+  PendingMove pendingPutStateOnChain;
 
   /**
    * The transaction ID of a dispute move we sent (if any).  Set to null
    * if there is none.
    */
-  uint256 pendingDispute;
+  PendingMove pendingDispute;
 
   /** Callbacks registered (e.g. for state updates).  */
   std::set<Callbacks*> callbacks;
@@ -160,12 +174,19 @@ private:
    */
   bool ApplyLocalMove (const BoardMove& mv);
 
+  /**
+   * Returns the current state proof in its minimal form (as per
+   * MinimiseStateProof), which is what we put into on-chain moves.
+   */
+  proto::StateProof GetMinimalStateProof () const;
+
   /**
    * Tries to resolve the current dispute, if there is any.  This can be called
    * whenever a change may have happened that affects this, like a new state
    * being known (e.g. off-chain / local move) or an on-chain update.
+   * Returns true if a resolution move was requested.
    */
-  void TryResolveDispute ();
+  bool TryResolveDispute ();
 
   /**
    * Tries to apply a chain of automoves to the current state, if applicable.
@@ -189,7 +210,62 @@ private:
    */
   void NotifyStateChange ();
 
+  /**
+   * Processes an on-chain update.  If verified is true, then the state
+   * proof has been verified already (through VerifyOnChain).
+   */
+  void ProcessOnChainInternal (const uint256& blk, unsigned h,
+                               const proto::ChannelMetadata& meta,
+                               const BoardState& reinitState,
+                               const proto::StateProof& proof,
+                               unsigned disputeHeight, bool verified);
+
+  /**
+   * Verifies the state proof of an on-chain update without changing
+   * any state (see RollingState::VerifyOnChain).
+   */
+  void VerifyOnChain (const proto::ChannelMetadata& meta,
+                      const BoardState& reinitState,
+                      const proto::StateProof& proof) const;
+
+  /**
+   * Processes a new block, for which the on-chain data of the channel is
+   * known to be the same as for the previous block.  This does the same
+   * per-block work as ProcessOnChain (checking pending transactions,
+   * resolving disputes, OpenChannel::MaybeOnChainMove and notifying
+   * listeners), but skips verifying and applying the unchanged state proof.
+   *
+   * Returns false without doing anything if a trace is being recorded;
+   * in that case, the full on-chain update has to be processed instead.
+   */
+  bool ProcessOnChainUnchanged (const uint256& blk, unsigned h);
+
+  /**
+   * Returns the block height at which the current dispute was filed,
+   * or zero if there is no dispute (or the channel does not exist).
+   */
+  unsigned GetDisputeHeight () const;
+
+  /**
+   * Checks if a previously sent resolution for the current dispute is
+   * no longer pending (e.g. because it was dropped from the mempool),
+   * and then tries to resolve the dispute (again).  This is used by
+   * the DisputeScheduler independently of state updates.  Returns true
+   * if a resolution move was requested.
+   */
+  bool RetryDisputeResolution ();
+
   friend class ChannelManagerTestFixture;
+  friend class DisputeScheduler;
+  friend class OnChainBatchProcessor;
+
+protected:
+
+  /**
+   * Returns the latest board state if the channel exists, and null
+   * otherwise.
+   */
+  const ParsedBoardState* GetLatestParsedState () const;
 
 public:
 
@@ -206,6 +282,13 @@ public:
   void SetOffChainBroadcast (OffChainBroadcast& s);
   void SetMoveSender (MoveSender& s);
 
+  /**
+   * Sets a recorder, to which all further input events will be recorded.
+   * The trace can be replayed later with ReplayTrace, e.g. for profiling
+   * or benchmarking real workloads.
+   */
+  void SetTraceRecorder (TraceRecorder& r);
+
   const uint256&
   GetChannelId () const
   {
@@ -255,12 +338,17 @@ public:
    * sent automatically as needed, but this function can be used to
    * explicitly trigger one in situations where putting the current state
    * on-chain is useful for a different purpose.
+   *
+   * If the MoveSender has a TransactionQueue, then the move is only queued
+   * and null is returned.  The txid is reported through ToJson once it
+   * is known.
    */
   uint256 PutStateOnChain ();
 
   /**
    * Requests to file a dispute with the current state.  Returns the txid
-   * of the sent move (or null if sending failed).
+   * of the sent move (or null if sending failed).  As with PutStateOnChain,
+   * null is returned if the move has just been queued.
    */
   uint256 FileDispute ();
 
@@ -301,6 +389,71 @@ public:
 
 };
 
+/**
+ * ChannelManager for a game whose board rules (and thus the type of parsed
+ * states they produce) are known at compile time.  Since channel daemons
+ * only ever run a single game, they can use this instead of the plain
+ * ChannelManager, and then access the current state as the game's own
+ * type.  The dynamic_cast to it is only done once per state change and
+ * not on every access.
+ *
+ * The Rules type must define StateType as the ParsedBoardState subclass
+ * returned by its ParseState for all valid states.  This is the case
+ * for instance for ProtoBoardRules.
+ */
+template <typename Rules>
+  class TypedChannelManager : public ChannelManager
+{
+
+private:
+
+  /** The board rules with their concrete type.  */
+  const Rules& typedRules;
+
+public:
+
+  using StateType = typename Rules::StateType;
+
+private:
+
+  /**
+   * The state version for which typedState has been resolved, or zero
+   * if it has not been resolved yet.
+   */
+  mutable int typedVersion = 0;
+
+  /** The latest board state cast to StateType (if typedVersion matches).  */
+  mutable const StateType* typedState = nullptr;
+
+public:
+
+  explicit TypedChannelManager (const Rules& r, OpenChannel& oc,
+                                const SignatureVerifier& v,
+                                SignatureSigner& s,
+                                const std::string& gId, const uint256& id,
+                                const std::string& name)
+    : ChannelManager(r, oc, v, s, gId, id, name), typedRules(r)
+  {}
+
+  /**
+   * Returns the board rules.
+   */
+  const Rules&
+  GetBoardRules () const
+  {
+    return typedRules;
+  }
+
+  using ChannelManager::GetBoardState;
+
+  /**
+   * Returns the current board state as the game's state type, or null
+   * if no state is known yet.
+   */
+  const StateType* GetBoardState () const;
+
+};
+
 /**
  * Interface for callbacks that can be invoked by a ChannelManager.
  */
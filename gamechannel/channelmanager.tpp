@@ -13,13 +13,37 @@ template <typename State>
   const State*
   ChannelManager::GetBoardState () const
 {
-  if (!exists)
+  const auto* state = GetLatestParsedState ();
+  if (state == nullptr)
     return nullptr;
 
-  const auto& state = boardStates.GetLatestState ();
-  const auto* typedState = dynamic_cast<const State*> (&state);
+  const auto* typedState = dynamic_cast<const State*> (state);
   CHECK (typedState != nullptr);
   return typedState;
 }
 
+template <typename Rules>
+  const typename TypedChannelManager<Rules>::StateType*
+  TypedChannelManager<Rules>::GetBoardState () const
+{
+  /* The latest state only changes together with the state version, so we
+     just need to resolve the typed pointer when the version differs from
+     the one we resolved it for last time.  */
+  const int version = GetStateVersion ();
+  if (version == typedVersion)
+    return typedState;
+
+  const auto* state = GetLatestParsedState ();
+  if (state == nullptr)
+    typedState = nullptr;
+  else
+    {
+      typedState = dynamic_cast<const StateType*> (state);
+      CHECK (typedState != nullptr);
+    }
+  typedVersion = version;
+
+  return typedState;
+}
+
 } // namespace xaya
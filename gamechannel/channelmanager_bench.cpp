@@ -0,0 +1,137 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "channelmanager.hpp"
+
+#include "benchutils.hpp"
+#include "channeltrace.hpp"
+
+#include <xayautil/hash.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace xaya
+{
+namespace
+{
+
+/**
+ * ChannelManager for a BenchChannel, which has already processed the
+ * on-chain state of the channel.
+ */
+class BenchChannelManager
+{
+
+public:
+
+  AdditionChannel game;
+  ChannelManager cm;
+
+  explicit BenchChannelManager (BenchChannel& ch,
+                                const proto::StateProof& onChain)
+    : cm(ch.rules, game, ch.verifier, ch.GetSigner (0),
+         ch.gameId, ch.channelId, ch.meta.participants (0).name ())
+  {
+    /* Automoves would require an off-chain broadcast for sending the
+       resulting states, and are not what we want to measure.  */
+    game.SetAutomovesEnabled (false);
+
+    cm.ProcessOnChain (SHA256::Hash ("block"), 10, ch.meta, ch.reinitState,
+                       onChain, 0);
+  }
+
+};
+
+/**
+ * Processes the sequence of off-chain updates of a full channel game
+ * through ChannelManager::ProcessOffChain.
+ */
+void
+ChannelManagerProcessOffChain (benchmark::State& state)
+{
+  BenchChannel ch(state.range (0));
+  const auto proofs = ch.BuildProofSequence (BenchChannel::MAX_LENGTH + 1);
+
+  for (auto _ : state)
+    {
+      state.PauseTiming ();
+      auto mgr = std::make_unique<BenchChannelManager> (ch, proofs.front ());
+      state.ResumeTiming ();
+
+      for (size_t i = 1; i < proofs.size (); ++i)
+        mgr->cm.ProcessOffChain (ch.meta.reinit (), proofs[i]);
+
+      state.PauseTiming ();
+      mgr.reset ();
+      state.ResumeTiming ();
+    }
+  state.SetItemsProcessed (state.iterations () * (proofs.size () - 1));
+}
+BENCHMARK (ChannelManagerProcessOffChain)->Arg (2)->Arg (10);
+
+void
+ChannelManagerToJson (benchmark::State& state)
+{
+  BenchChannel ch(state.range (0));
+  BenchChannelManager mgr(ch, ch.BuildProof (50));
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize (mgr.cm.ToJson ());
+}
+BENCHMARK (ChannelManagerToJson)->Arg (2)->Arg (10);
+
+/**
+ * Records the off-chain updates of a full channel game to a trace file,
+ * and measures replaying it into a fresh ChannelManager.
+ */
+void
+ChannelManagerReplayTrace (benchmark::State& state)
+{
+  BenchChannel ch(state.range (0));
+  const auto proofs = ch.BuildProofSequence (BenchChannel::MAX_LENGTH + 1);
+
+  const std::string file = "channelmanager_bench_trace.bin";
+  {
+    TraceRecorder recorder(file);
+    AdditionChannel game;
+    game.SetAutomovesEnabled (false);
+    ChannelManager cm(ch.rules, game, ch.verifier, ch.GetSigner (0),
+                      ch.gameId, ch.channelId, ch.meta.participants (0).name ());
+    cm.SetTraceRecorder (recorder);
+
+    cm.ProcessOnChain (SHA256::Hash ("block"), 10, ch.meta, ch.reinitState,
+                       proofs.front (), 0);
+    for (size_t i = 1; i < proofs.size (); ++i)
+      cm.ProcessOffChain (ch.meta.reinit (), proofs[i]);
+  }
+
+  for (auto _ : state)
+    {
+      state.PauseTiming ();
+      AdditionChannel game;
+      game.SetAutomovesEnabled (false);
+      auto cm = std::make_unique<ChannelManager> (
+          ch.rules, game, ch.verifier, ch.GetSigner (0),
+          ch.gameId, ch.channelId, ch.meta.participants (0).name ());
+      state.ResumeTiming ();
+
+      TraceReader reader(file);
+      benchmark::DoNotOptimize (ReplayTrace (reader, *cm));
+
+      state.PauseTiming ();
+      cm.reset ();
+      state.ResumeTiming ();
+    }
+  state.SetItemsProcessed (state.iterations () * proofs.size ());
+
+  std::remove (file.c_str ());
+}
+BENCHMARK (ChannelManagerReplayTrace)->Arg (2)->Arg (10);
+
+} // anonymous namespace
+} // namespace xaya
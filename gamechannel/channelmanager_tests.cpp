@@ -4,10 +4,13 @@
 
 #include "channelmanager_tests.hpp"
 
+#include "protoboard.hpp"
 #include "protoutils.hpp"
 #include "stateproof.hpp"
+#include "transactionqueue.hpp"
 
 #include "proto/broadcast.pb.h"
+#include "proto/testprotos.pb.h"
 
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/message_differencer.h>
@@ -17,6 +20,8 @@
 
 #include <glog/logging.h>
 
+#include <thread>
+
 using google::protobuf::TextFormat;
 using google::protobuf::util::MessageDifferencer;
 using testing::_;
@@ -514,6 +519,23 @@ TEST_F (ResolveDisputeTests, RetryAfterBlock)
   cm.ProcessOffChain ("", ValidProof ("14 8"));
 }
 
+TEST_F (ResolveDisputeTests, QueuedResolution)
+{
+  TransactionQueue queue(txSender);
+  onChain.SetQueue (queue);
+
+  const auto txid = ExpectMove ("resolution");
+  ProcessOnChain ("0 0", ValidProof ("10 5"), 1);
+  cm.ProcessOffChain ("", ValidProof ("12 6"));
+
+  while (GetDispute ()->pendingResolution.IsQueued ())
+    std::this_thread::yield ();
+
+  auto expected = Json::Value (Json::objectValue);
+  expected["resolution"] = txid.ToHex ();
+  EXPECT_EQ (cm.ToJson ()["pending"], expected);
+}
+
 /* ************************************************************************** */
 
 using PutStateOnChainTests = ChannelManagerTests;
@@ -719,5 +741,120 @@ TEST_F (ChannelToJsonTests, PendingResolution)
 
 /* ************************************************************************** */
 
+using TypedTestSuperState
+    = ProtoBoardState<proto::TestBoardState, proto::TestBoardMove>;
+
+/**
+ * Simple proto-based game for testing TypedChannelManager.  States are
+ * never anyone's turn, and the turn count is always one.
+ */
+class TypedTestState : public TypedTestSuperState
+{
+
+protected:
+
+  bool
+  ApplyMoveProto (const proto::TestBoardMove& mv,
+                  proto::TestBoardState& newState) const override
+  {
+    return false;
+  }
+
+public:
+
+  using TypedTestSuperState::TypedTestSuperState;
+
+  int
+  WhoseTurn () const override
+  {
+    return NO_TURN;
+  }
+
+  unsigned
+  TurnCount () const override
+  {
+    return 1;
+  }
+
+};
+
+class TypedTestRules : public ProtoBoardRules<TypedTestState>
+{
+
+public:
+
+  ChannelProtoVersion
+  GetProtoVersion (const proto::ChannelMetadata& meta) const override
+  {
+    return ChannelProtoVersion::ORIGINAL;
+  }
+
+};
+
+class TypedTestChannel : public OpenChannel
+{
+
+public:
+
+  Json::Value
+  ResolutionMove (const uint256& channelId,
+                  const proto::StateProof& proof) const override
+  {
+    return Json::Value ();
+  }
+
+  Json::Value
+  DisputeMove (const uint256& channelId,
+               const proto::StateProof& proof) const override
+  {
+    return Json::Value ();
+  }
+
+};
+
+TEST_F (ChannelManagerTestFixture, TypedChannelManager)
+{
+  TypedTestRules rules;
+  TypedTestChannel channel;
+  TypedChannelManager<TypedTestRules> typedCm(rules, channel, verifier, signer,
+                                              "game id", channelId, "player");
+  EXPECT_EQ (&typedCm.GetBoardRules (), &rules);
+  EXPECT_EQ (typedCm.GetBoardState (), nullptr);
+
+  proto::TestBoardState pb;
+  pb.set_msg ("foo");
+  BoardState state;
+  CHECK (pb.SerializeToString (&state));
+
+  proto::StateProof proof;
+  proof.mutable_initial_state ()->set_data (state);
+  typedCm.ProcessOnChain (blockHash, height, meta, state, proof, 0);
+
+  const TypedTestState* typedState = typedCm.GetBoardState ();
+  ASSERT_NE (typedState, nullptr);
+  EXPECT_EQ (typedState->GetState ().msg (), "foo");
+  EXPECT_EQ (typedCm.GetBoardState<TypedTestState> (), typedState);
+  EXPECT_EQ (typedCm.GetBoardState (), typedState);
+
+  /* The turn count is always the same, so the state can only change
+     through a reinitialisation.  */
+  proto::ChannelMetadata reinitMeta = meta;
+  reinitMeta.set_reinit ("other reinit");
+  pb.set_msg ("bar");
+  CHECK (pb.SerializeToString (&state));
+  proof.mutable_initial_state ()->set_data (state);
+  typedCm.ProcessOnChain (blockHash, height + 1, reinitMeta, state, proof, 0);
+
+  typedState = typedCm.GetBoardState ();
+  ASSERT_NE (typedState, nullptr);
+  EXPECT_EQ (typedState->GetState ().msg (), "bar");
+  EXPECT_EQ (typedCm.GetBoardState<TypedTestState> (), typedState);
+
+  typedCm.ProcessOnChainNonExistant (blockHash, height + 2);
+  EXPECT_EQ (typedCm.GetBoardState (), nullptr);
+}
+
+/* ************************************************************************** */
+
 } // anonymous namespace
 } // namespace xaya
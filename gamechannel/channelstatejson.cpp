@@ -42,7 +42,7 @@ BoardStateToJson (const BoardRules& r,
   Json::Value res(Json::objectValue);
   res["base64"] = EncodeBase64 (state);
 
-  auto parsed = r.ParseState (channelId, meta, state);
+  auto parsed = r.ParseStateShared (channelId, meta, state);
   CHECK (parsed != nullptr)
       << "Channel " << channelId.ToHex () << " has invalid state: "
       << state;
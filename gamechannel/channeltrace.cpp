@@ -0,0 +1,297 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "channeltrace.hpp"
+
+#include "channelmanager.hpp"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include <glog/logging.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace xaya
+{
+
+using google::protobuf::io::CodedInputStream;
+using google::protobuf::io::CodedOutputStream;
+using google::protobuf::io::StringOutputStream;
+
+/* ************************************************************************** */
+
+const std::string TraceRecorder::MAGIC = "xaya-channel-trace-v1";
+
+TraceRecorder::TraceRecorder (const std::string& file)
+  : out(file, std::ios::binary | std::ios::trunc)
+{
+  CHECK (out) << "Failed to open trace file for writing: " << file;
+  out.write (MAGIC.data (), MAGIC.size ());
+  out.flush ();
+  LOG (INFO) << "Recording ChannelManager trace to " << file;
+}
+
+void
+TraceRecorder::Write (const proto::TraceEvent& ev)
+{
+  std::string buf;
+  {
+    StringOutputStream stream(&buf);
+    CodedOutputStream coded(&stream);
+    coded.WriteVarint32 (ev.ByteSizeLong ());
+    CHECK (ev.SerializeToCodedStream (&coded));
+  }
+
+  out.write (buf.data (), buf.size ());
+  out.flush ();
+  CHECK (out) << "Failed to write to trace file";
+}
+
+void
+TraceRecorder::RecordOnChain (const uint256& blk, const unsigned h,
+                              const proto::ChannelMetadata& meta,
+                              const BoardState& reinitState,
+                              const proto::StateProof& proof,
+                              const unsigned disputeHeight)
+{
+  proto::TraceEvent ev;
+  auto& data = *ev.mutable_on_chain ();
+  data.set_block_hash (blk.GetBinaryString ());
+  data.set_height (h);
+  *data.mutable_meta () = meta;
+  data.set_reinit_state (reinitState);
+  *data.mutable_proof () = proof;
+  data.set_dispute_height (disputeHeight);
+  Write (ev);
+}
+
+void
+TraceRecorder::RecordOnChainNonExistant (const uint256& blk, const unsigned h)
+{
+  proto::TraceEvent ev;
+  auto& data = *ev.mutable_on_chain_non_existant ();
+  data.set_block_hash (blk.GetBinaryString ());
+  data.set_height (h);
+  Write (ev);
+}
+
+void
+TraceRecorder::RecordOffChain (const std::string& reinitId,
+                               const proto::StateProof& proof)
+{
+  proto::TraceEvent ev;
+  auto& data = *ev.mutable_off_chain ();
+  data.set_reinit (reinitId);
+  *data.mutable_proof () = proof;
+  Write (ev);
+}
+
+void
+TraceRecorder::RecordLocalMove (const BoardMove& mv)
+{
+  proto::TraceEvent ev;
+  ev.mutable_local_move ()->set_move (mv);
+  Write (ev);
+}
+
+void
+TraceRecorder::RecordTriggerAutoMoves ()
+{
+  proto::TraceEvent ev;
+  ev.mutable_trigger_auto_moves ();
+  Write (ev);
+}
+
+/* ************************************************************************** */
+
+TraceReader::TraceReader (const std::string& file)
+  : data(nullptr), pos(0)
+{
+  fd = open (file.c_str (), O_RDONLY);
+  PCHECK (fd >= 0) << "Failed to open trace file " << file;
+
+  struct stat st;
+  PCHECK (fstat (fd, &st) == 0) << "Failed to stat trace file " << file;
+  size = st.st_size;
+
+  if (size > 0)
+    {
+      void* mapped = mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      PCHECK (mapped != MAP_FAILED) << "Failed to map trace file " << file;
+      data = static_cast<const char*> (mapped);
+    }
+
+  const auto& magic = TraceRecorder::MAGIC;
+  CHECK (size >= magic.size ()
+            && std::memcmp (data, magic.data (), magic.size ()) == 0)
+      << "File is not a ChannelManager trace: " << file;
+  pos = magic.size ();
+}
+
+TraceReader::~TraceReader ()
+{
+  if (data != nullptr)
+    munmap (const_cast<char*> (data), size);
+  close (fd);
+}
+
+bool
+TraceReader::Next (proto::TraceEvent& ev)
+{
+  if (pos == size)
+    return false;
+
+  /* The length prefix is at most this long.  Limiting the stream to it
+     also keeps the remaining file size (which may exceed the int range
+     of CodedInputStream) out of the constructor.  */
+  const size_t maxLenBytes = CodedOutputStream::VarintSize32 (~uint32_t (0));
+
+  const auto* begin = reinterpret_cast<const uint8_t*> (data + pos);
+  CodedInputStream in(begin, std::min<size_t> (size - pos, maxLenBytes));
+
+  /* If the recording process crashed, the last event may have been written
+     only partially.  That is treated as end of the trace, so that everything
+     before it can still be replayed.  Only invalid data that is not at the
+     end of the file is an error.  */
+
+  uint32_t len;
+  if (!in.ReadVarint32 (&len))
+    {
+      CHECK_LT (size - pos, maxLenBytes)
+          << "Invalid event length in trace";
+      for (size_t i = pos; i < size; ++i)
+        CHECK (static_cast<uint8_t> (data[i]) & 0x80)
+            << "Invalid event length in trace";
+      LOG (WARNING) << "Ignoring truncated event length at end of trace";
+      pos = size;
+      return false;
+    }
+  pos += in.CurrentPosition ();
+
+  if (len > size - pos)
+    {
+      LOG (WARNING)
+          << "Ignoring truncated event at end of trace: "
+          << (size - pos) << " of " << len << " bytes present";
+      pos = size;
+      return false;
+    }
+
+  CHECK (ev.ParseFromArray (data + pos, len)) << "Invalid event in trace";
+  pos += len;
+
+  return true;
+}
+
+/* ************************************************************************** */
+
+namespace
+{
+
+/**
+ * Extracts a uint256 from its binary representation in a trace event.
+ */
+uint256
+ParseBlockHash (const std::string& bin)
+{
+  CHECK_EQ (bin.size (), uint256::NUM_BYTES) << "Invalid block hash in trace";
+
+  uint256 res;
+  res.FromBlob (reinterpret_cast<const unsigned char*> (bin.data ()));
+  return res;
+}
+
+/**
+ * Passes a single event on to the ChannelManager.
+ */
+void
+ProcessEvent (const proto::TraceEvent& ev, ChannelManager& cm)
+{
+  switch (ev.event_case ())
+    {
+    case proto::TraceEvent::kOnChain:
+      {
+        const auto& data = ev.on_chain ();
+        cm.ProcessOnChain (ParseBlockHash (data.block_hash ()), data.height (),
+                           data.meta (), data.reinit_state (), data.proof (),
+                           data.dispute_height ());
+        break;
+      }
+
+    case proto::TraceEvent::kOnChainNonExistant:
+      {
+        const auto& data = ev.on_chain_non_existant ();
+        cm.ProcessOnChainNonExistant (ParseBlockHash (data.block_hash ()),
+                                      data.height ());
+        break;
+      }
+
+    case proto::TraceEvent::kOffChain:
+      cm.ProcessOffChain (ev.off_chain ().reinit (), ev.off_chain ().proof ());
+      break;
+
+    case proto::TraceEvent::kLocalMove:
+      cm.ProcessLocalMove (ev.local_move ().move ());
+      break;
+
+    case proto::TraceEvent::kTriggerAutoMoves:
+      cm.TriggerAutoMoves ();
+      break;
+
+    default:
+      LOG (FATAL) << "Unknown event in trace: " << ev.DebugString ();
+    }
+}
+
+} // anonymous namespace
+
+TraceReplayStats
+ReplayTrace (TraceReader& reader, ChannelManager& cm)
+{
+  using Clock = std::chrono::steady_clock;
+
+  const auto* oneof = proto::TraceEvent::descriptor ()->oneof_decl (0);
+
+  TraceReplayStats res;
+  proto::TraceEvent ev;
+  while (reader.Next (ev))
+    {
+      const auto start = Clock::now ();
+      ProcessEvent (ev, cm);
+      const auto duration = Clock::now () - start;
+
+      const auto* field = ev.GetReflection ()->GetOneofFieldDescriptor (
+          ev, oneof);
+      auto& entry = res.byType[field->name ()];
+      ++entry.count;
+      entry.duration += duration;
+      res.total += duration;
+    }
+
+  for (const auto& entry : res.byType)
+    LOG (INFO)
+        << "Replayed " << entry.second.count << " " << entry.first
+        << " events in "
+        << std::chrono::duration_cast<std::chrono::microseconds> (
+              entry.second.duration).count ()
+        << " us";
+  LOG (INFO)
+      << "Total replay time: "
+      << std::chrono::duration_cast<std::chrono::microseconds> (
+            res.total).count ()
+      << " us";
+
+  return res;
+}
+
+/* ************************************************************************** */
+
+} // namespace xaya
@@ -0,0 +1,158 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GAMECHANNEL_CHANNELTRACE_HPP
+#define GAMECHANNEL_CHANNELTRACE_HPP
+
+#include "boardrules.hpp"
+
+#include "proto/metadata.pb.h"
+#include "proto/stateproof.pb.h"
+#include "proto/trace.pb.h"
+
+#include <xayautil/uint256.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <map>
+#include <string>
+
+namespace xaya
+{
+
+class ChannelManager;
+
+/**
+ * Records the input events of a ChannelManager (on-chain and off-chain
+ * updates, local moves and triggered automoves) to a trace file.  Such a
+ * trace can then be replayed offline (see ReplayTrace) for profiling or
+ * regression benchmarks with real workloads.
+ *
+ * The file starts with a fixed magic string, followed by the events.  Each
+ * event is a serialised TraceEvent protocol buffer, prefixed by its length
+ * as varint.  Events are flushed to the file as they are recorded, so that
+ * the trace is complete also if the process crashes.
+ */
+class TraceRecorder
+{
+
+private:
+
+  /** The output stream we write to.  */
+  std::ofstream out;
+
+  /**
+   * Appends the given event to the file.
+   */
+  void Write (const proto::TraceEvent& ev);
+
+public:
+
+  /** The magic string at the start of trace files.  */
+  static const std::string MAGIC;
+
+  /**
+   * Opens the given file for writing (replacing it if it exists already).
+   */
+  explicit TraceRecorder (const std::string& file);
+
+  TraceRecorder () = delete;
+  TraceRecorder (const TraceRecorder&) = delete;
+  void operator= (const TraceRecorder&) = delete;
+
+  void RecordOnChain (const uint256& blk, unsigned h,
+                      const proto::ChannelMetadata& meta,
+                      const BoardState& reinitState,
+                      const proto::StateProof& proof,
+                      unsigned disputeHeight);
+  void RecordOnChainNonExistant (const uint256& blk, unsigned h);
+  void RecordOffChain (const std::string& reinitId,
+                       const proto::StateProof& proof);
+  void RecordLocalMove (const BoardMove& mv);
+  void RecordTriggerAutoMoves ();
+
+};
+
+/**
+ * Reader for a trace file written by TraceRecorder.  The file is mapped
+ * into memory, and events are parsed directly from there.
+ */
+class TraceReader
+{
+
+private:
+
+  /** File descriptor of the opened file.  */
+  int fd;
+
+  /** The mapped file data (or null for an empty file).  */
+  const char* data;
+
+  /** Size of the file and mapped memory.  */
+  size_t size;
+
+  /** Current read position in the data.  */
+  size_t pos;
+
+public:
+
+  /**
+   * Opens and maps the given file.  CHECK-fails if it cannot be read or
+   * is not a trace file.
+   */
+  explicit TraceReader (const std::string& file);
+
+  ~TraceReader ();
+
+  TraceReader () = delete;
+  TraceReader (const TraceReader&) = delete;
+  void operator= (const TraceReader&) = delete;
+
+  /**
+   * Reads the next event.  Returns false if the end of the file has been
+   * reached.  An incomplete event at the very end (e.g. because the recording
+   * process crashed) is ignored with a warning and also treated as end of
+   * the trace.  CHECK-fails if the data is otherwise invalid.
+   */
+  bool Next (proto::TraceEvent& ev);
+
+};
+
+/**
+ * Timing results of replaying a trace, per type of event.
+ */
+struct TraceReplayStats
+{
+
+  /** Statistics for one type of event.  */
+  struct Entry
+  {
+    /** Number of events of this type.  */
+    unsigned count = 0;
+    /** Total time spent processing them.  */
+    std::chrono::nanoseconds duration{0};
+  };
+
+  /** The entries, keyed by the name of the event type.  */
+  std::map<std::string, Entry> byType;
+
+  /** Total time spent processing events of all types.  */
+  std::chrono::nanoseconds total{0};
+
+};
+
+/**
+ * Feeds all (remaining) events from the given reader into the given
+ * ChannelManager as quickly as possible, and measures the time spent
+ * in processing them.  The statistics are logged and returned.
+ *
+ * The ChannelManager should be fresh, and set up with the same game,
+ * signer and other parameters as the one the trace was recorded from.
+ */
+TraceReplayStats ReplayTrace (TraceReader& reader, ChannelManager& cm);
+
+} // namespace xaya
+
+#endif // GAMECHANNEL_CHANNELTRACE_HPP
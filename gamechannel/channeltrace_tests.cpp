@@ -0,0 +1,182 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "channeltrace.hpp"
+
+#include "channelmanager_tests.hpp"
+
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/util/message_differencer.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+
+using google::protobuf::TextFormat;
+using google::protobuf::util::MessageDifferencer;
+
+namespace xaya
+{
+namespace
+{
+
+class ChannelTraceTests : public ChannelManagerTestFixture
+{
+
+protected:
+
+  /** The file used for the trace.  */
+  const std::string file;
+
+  ChannelTraceTests ()
+    : file(testing::TempDir () + "/channeltrace_tests.bin")
+  {}
+
+  ~ChannelTraceTests ()
+  {
+    std::remove (file.c_str ());
+  }
+
+  /**
+   * Reads all events from our trace file.
+   */
+  std::vector<proto::TraceEvent>
+  ReadAll () const
+  {
+    TraceReader reader(file);
+    std::vector<proto::TraceEvent> res;
+    proto::TraceEvent ev;
+    while (reader.Next (ev))
+      res.push_back (ev);
+    return res;
+  }
+
+};
+
+TEST_F (ChannelTraceTests, EmptyTrace)
+{
+  {
+    TraceRecorder recorder(file);
+  }
+  EXPECT_TRUE (ReadAll ().empty ());
+}
+
+TEST_F (ChannelTraceTests, RecordAndRead)
+{
+  const auto proof = ValidProof ("10 5");
+  {
+    TraceRecorder recorder(file);
+    recorder.RecordOnChain (blockHash, height, meta, "0 0", proof, 10);
+    recorder.RecordOnChainNonExistant (blockHash, 100);
+    recorder.RecordOffChain ("reinit", proof);
+    recorder.RecordLocalMove (std::string ("move\0data", 9));
+    recorder.RecordTriggerAutoMoves ();
+  }
+
+  const auto events = ReadAll ();
+  ASSERT_EQ (events.size (), 5);
+
+  const auto& onChain = events[0].on_chain ();
+  EXPECT_EQ (onChain.block_hash (), blockHash.GetBinaryString ());
+  EXPECT_EQ (onChain.height (), height);
+  EXPECT_TRUE (MessageDifferencer::Equals (onChain.meta (), meta));
+  EXPECT_EQ (onChain.reinit_state (), "0 0");
+  EXPECT_TRUE (MessageDifferencer::Equals (onChain.proof (), proof));
+  EXPECT_EQ (onChain.dispute_height (), 10);
+
+  EXPECT_EQ (events[1].on_chain_non_existant ().height (), 100);
+  EXPECT_EQ (events[2].off_chain ().reinit (), "reinit");
+  EXPECT_TRUE (MessageDifferencer::Equals (events[2].off_chain ().proof (),
+                                           proof));
+  EXPECT_EQ (events[3].local_move ().move (), std::string ("move\0data", 9));
+  EXPECT_TRUE (events[4].has_trigger_auto_moves ());
+}
+
+TEST_F (ChannelTraceTests, InvalidFile)
+{
+  {
+    std::ofstream out(file, std::ios::binary);
+    out << "not a trace";
+  }
+  EXPECT_DEATH (ReadAll (), "not a ChannelManager trace");
+}
+
+TEST_F (ChannelTraceTests, TruncatedEvent)
+{
+  {
+    TraceRecorder recorder(file);
+    recorder.RecordOffChain ("reinit", ValidProof ("10 5"));
+  }
+  {
+    std::ofstream out(file, std::ios::binary | std::ios::app);
+    out << '\x10' << "short";
+  }
+
+  const auto events = ReadAll ();
+  ASSERT_EQ (events.size (), 1);
+  EXPECT_EQ (events[0].off_chain ().reinit (), "reinit");
+}
+
+TEST_F (ChannelTraceTests, TruncatedLength)
+{
+  {
+    TraceRecorder recorder(file);
+    recorder.RecordTriggerAutoMoves ();
+  }
+  {
+    std::ofstream out(file, std::ios::binary | std::ios::app);
+    out << '\x80';
+  }
+
+  EXPECT_EQ (ReadAll ().size (), 1);
+}
+
+TEST_F (ChannelTraceTests, CorruptEvent)
+{
+  {
+    TraceRecorder recorder(file);
+    recorder.RecordTriggerAutoMoves ();
+  }
+  {
+    std::ofstream out(file, std::ios::binary | std::ios::app);
+    out << '\x03' << "\xff\xff\xff";
+  }
+  EXPECT_DEATH (ReadAll (), "Invalid event in trace");
+}
+
+TEST_F (ChannelTraceTests, RecordAndReplay)
+{
+  {
+    TraceRecorder recorder(file);
+    cm.SetTraceRecorder (recorder);
+
+    ProcessOnChain ("0 0", ValidProof ("10 5"), 0);
+    cm.ProcessOffChain ("", ValidProof ("12 6"));
+    cm.ProcessOffChain ("", ValidProof ("11 5"));
+    ProcessOnChainNonExistant ();
+    ProcessOnChain ("0 0", ValidProof ("20 10"), 0);
+    cm.TriggerAutoMoves ();
+  }
+
+  ChannelManager fresh(game.rules, game.channel, verifier, signer,
+                       "game id", channelId, "player");
+  fresh.SetMoveSender (onChain);
+
+  TraceReader reader(file);
+  const auto stats = ReplayTrace (reader, fresh);
+
+  EXPECT_EQ (fresh.ToJson (), cm.ToJson ());
+
+  EXPECT_EQ (stats.byType.at ("on_chain").count, 2);
+  EXPECT_EQ (stats.byType.at ("on_chain_non_existant").count, 1);
+  EXPECT_EQ (stats.byType.at ("off_chain").count, 2);
+  EXPECT_EQ (stats.byType.at ("trigger_auto_moves").count, 1);
+  EXPECT_EQ (stats.byType.count ("local_move"), 0);
+}
+
+} // anonymous namespace
+} // namespace xaya
@@ -0,0 +1,94 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "digestcache.hpp"
+
+#include <xayautil/hash.hpp>
+
+#include <glog/logging.h>
+
+namespace xaya
+{
+
+DataDigestCache::DataDigestCache (const size_t minSize, const size_t maxSize)
+  : minDataSize(minSize), maxTotalSize(maxSize)
+{
+  CHECK_GT (maxTotalSize, 0);
+}
+
+uint256
+DataDigestCache::Get (const std::string& data)
+{
+  if (data.size () < minDataSize || data.size () > maxTotalSize)
+    return SHA256::Hash (data);
+
+  {
+    std::lock_guard<std::mutex> lock(mut);
+    const auto mit = entries.find (data);
+    if (mit != entries.end ())
+      {
+        ++hits;
+        lru.splice (lru.begin (), lru, mit->second.pos);
+        return mit->second.digest;
+      }
+    ++misses;
+  }
+
+  /* Hash without holding the lock, so that other threads are not blocked
+     while a large state is hashed.  If another thread adds the same data
+     in the meantime, we just keep its entry.  */
+  const uint256 digest = SHA256::Hash (data);
+
+  std::lock_guard<std::mutex> lock(mut);
+  const auto ins = entries.emplace (data, Entry ());
+  if (!ins.second)
+    return digest;
+
+  ins.first->second.digest = digest;
+  lru.push_front (&ins.first->first);
+  ins.first->second.pos = lru.begin ();
+  totalSize += data.size ();
+
+  while (totalSize > maxTotalSize)
+    {
+      VLOG (2) << "Evicting least recently used data digest";
+      const auto mit = entries.find (*lru.back ());
+      CHECK (mit != entries.end ());
+      lru.pop_back ();
+      totalSize -= mit->first.size ();
+      entries.erase (mit);
+    }
+
+  return digest;
+}
+
+size_t
+DataDigestCache::GetSize () const
+{
+  std::lock_guard<std::mutex> lock(mut);
+  return entries.size ();
+}
+
+unsigned
+DataDigestCache::GetHits () const
+{
+  std::lock_guard<std::mutex> lock(mut);
+  return hits;
+}
+
+unsigned
+DataDigestCache::GetMisses () const
+{
+  std::lock_guard<std::mutex> lock(mut);
+  return misses;
+}
+
+DataDigestCache&
+DataDigestCache::Global ()
+{
+  static DataDigestCache instance;
+  return instance;
+}
+
+} // namespace xaya
@@ -0,0 +1,126 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GAMECHANNEL_DIGESTCACHE_HPP
+#define GAMECHANNEL_DIGESTCACHE_HPP
+
+#include <xayautil/uint256.hpp>
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace xaya
+{
+
+/**
+ * LRU memo of SHA-256 digests of data strings (typically encoded board
+ * states in SignedData).  The same state data is hashed many times as it
+ * moves through the framework, e.g. when signing it, when finding the
+ * minimal state proof, when verifying the proof on each peer and when it
+ * ends up on chain.  With the memo, each distinct payload is hashed only
+ * once (as long as it stays in the cache).
+ *
+ * Entries are keyed by the full data, so that a lookup (which only needs
+ * a non-cryptographic hash and a comparison) is always exact.  Only data
+ * of at least a minimum size is cached, since hashing small strings
+ * directly is cheaper than the lookup.  The total size of cached data is
+ * bounded; when it is exceeded, the least recently used entries are
+ * evicted.  The cache is thread-safe.
+ */
+class DataDigestCache
+{
+
+private:
+
+  /**
+   * Data held for a cached digest.
+   */
+  struct Entry
+  {
+
+    /** The digest of the data.  */
+    uint256 digest;
+
+    /** Position of this entry in the LRU list.  */
+    std::list<const std::string*>::iterator pos;
+
+  };
+
+  /** Minimum size of data that gets cached.  */
+  const size_t minDataSize;
+
+  /** Maximum total size of data to keep.  */
+  const size_t maxTotalSize;
+
+  /** Lock for this instance.  */
+  mutable std::mutex mut;
+
+  /** The cached entries, keyed by data.  */
+  std::unordered_map<std::string, Entry> entries;
+
+  /**
+   * Keys of the entries (pointing into the map, whose nodes are stable)
+   * with the most recently used one at the front.
+   */
+  std::list<const std::string*> lru;
+
+  /** Total size of all cached data.  */
+  size_t totalSize = 0;
+
+  /** Number of lookups that were answered from the cache.  */
+  unsigned hits = 0;
+
+  /** Number of lookups that required hashing the data.  */
+  unsigned misses = 0;
+
+public:
+
+  /** Default minimum size for data to be cached.  */
+  static constexpr size_t DEFAULT_MIN_DATA_SIZE = 256;
+
+  /** Default bound for the total size of cached data.  */
+  static constexpr size_t DEFAULT_MAX_TOTAL_SIZE = 16 << 20;
+
+  explicit DataDigestCache (size_t minSize = DEFAULT_MIN_DATA_SIZE,
+                            size_t maxSize = DEFAULT_MAX_TOTAL_SIZE);
+
+  DataDigestCache (const DataDigestCache&) = delete;
+  void operator= (const DataDigestCache&) = delete;
+
+  /**
+   * Returns the SHA-256 digest of the given data, either from the cache
+   * or by hashing it (and adding it to the cache if it is large enough).
+   */
+  uint256 Get (const std::string& data);
+
+  /**
+   * Returns the number of entries currently in the cache.
+   */
+  size_t GetSize () const;
+
+  /**
+   * Returns the number of cache hits so far.
+   */
+  unsigned GetHits () const;
+
+  /**
+   * Returns the number of cache misses so far (not counting data
+   * too small to be cached).
+   */
+  unsigned GetMisses () const;
+
+  /**
+   * Returns the process-wide instance, which is used to hash the data
+   * for channel signature messages.
+   */
+  static DataDigestCache& Global ();
+
+};
+
+} // namespace xaya
+
+#endif // GAMECHANNEL_DIGESTCACHE_HPP
@@ -0,0 +1,113 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "digestcache.hpp"
+
+#include <xayautil/hash.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xaya
+{
+namespace
+{
+
+class DataDigestCacheTests : public testing::Test
+{
+
+protected:
+
+  /** Minimum data size for the cache under test.  */
+  static constexpr size_t MIN_SIZE = 10;
+
+  DataDigestCache cache;
+
+  DataDigestCacheTests ()
+    : cache(MIN_SIZE, 100)
+  {}
+
+  /**
+   * Returns a string of the given size, made up of the given character.
+   */
+  static std::string
+  Data (const size_t n, const char c)
+  {
+    return std::string (n, c);
+  }
+
+};
+
+TEST_F (DataDigestCacheTests, ReturnsCorrectDigests)
+{
+  for (const auto& d : {Data (0, 'a'), Data (5, 'a'), Data (20, 'a'),
+                        Data (20, 'b'), Data (20, 'a'), Data (200, 'x')})
+    EXPECT_EQ (cache.Get (d), SHA256::Hash (d));
+}
+
+TEST_F (DataDigestCacheTests, HitsAndMisses)
+{
+  cache.Get (Data (20, 'a'));
+  cache.Get (Data (20, 'a'));
+  cache.Get (Data (21, 'a'));
+  cache.Get (Data (20, 'a'));
+
+  EXPECT_EQ (cache.GetSize (), 2);
+  EXPECT_EQ (cache.GetHits (), 2);
+  EXPECT_EQ (cache.GetMisses (), 2);
+}
+
+TEST_F (DataDigestCacheTests, SmallAndHugeDataNotCached)
+{
+  cache.Get (Data (MIN_SIZE - 1, 'a'));
+  cache.Get (Data (MIN_SIZE - 1, 'a'));
+  cache.Get (Data (101, 'a'));
+  EXPECT_EQ (cache.GetSize (), 0);
+  EXPECT_EQ (cache.GetHits (), 0);
+  EXPECT_EQ (cache.GetMisses (), 0);
+}
+
+TEST_F (DataDigestCacheTests, EvictsLeastRecentlyUsed)
+{
+  cache.Get (Data (40, 'a'));
+  cache.Get (Data (40, 'b'));
+  cache.Get (Data (40, 'a'));
+
+  /* This exceeds the total size, so that "b" gets evicted.  */
+  cache.Get (Data (40, 'c'));
+  EXPECT_EQ (cache.GetSize (), 2);
+
+  const unsigned hits = cache.GetHits ();
+  cache.Get (Data (40, 'a'));
+  cache.Get (Data (40, 'c'));
+  EXPECT_EQ (cache.GetHits (), hits + 2);
+
+  const unsigned misses = cache.GetMisses ();
+  EXPECT_EQ (cache.Get (Data (40, 'b')), SHA256::Hash (Data (40, 'b')));
+  EXPECT_EQ (cache.GetMisses (), misses + 1);
+}
+
+TEST_F (DataDigestCacheTests, Threads)
+{
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < 4; ++t)
+    threads.emplace_back ([this, t] ()
+      {
+        for (unsigned i = 0; i < 100; ++i)
+          {
+            const std::string d = Data (MIN_SIZE + i % 7, 'a' + t);
+            EXPECT_EQ (cache.Get (d), SHA256::Hash (d));
+          }
+      });
+  for (auto& t : threads)
+    t.join ();
+
+  EXPECT_LE (cache.GetSize (), 100 / MIN_SIZE);
+}
+
+} // anonymous namespace
+} // namespace xaya
@@ -0,0 +1,214 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "disputescheduler.hpp"
+
+#include <glog/logging.h>
+
+#include <iterator>
+
+namespace xaya
+{
+
+/**
+ * Callbacks registered with each manager, which refresh the dispute data
+ * of the channel in the scheduler.
+ */
+class DisputeScheduler::ChannelCallbacks : public ChannelManager::Callbacks
+{
+
+private:
+
+  DisputeScheduler& scheduler;
+  const uint256 channelId;
+
+public:
+
+  explicit ChannelCallbacks (DisputeScheduler& s, const uint256& id)
+    : scheduler(s), channelId(id)
+  {}
+
+  void
+  StateChanged () override
+  {
+    scheduler.Update (channelId);
+  }
+
+};
+
+DisputeScheduler::DisputeScheduler (const unsigned blocks)
+  : disputeBlocks(blocks)
+{
+  CHECK_GT (disputeBlocks, 0);
+}
+
+DisputeScheduler::~DisputeScheduler ()
+{
+  for (auto& entry : channels)
+    entry.second.manager->UnregisterCallback (*entry.second.callbacks);
+}
+
+void
+DisputeScheduler::AddChannel (ChannelManager& cm)
+{
+  const uint256& id = cm.GetChannelId ();
+
+  Channel ch;
+  ch.manager = &cm;
+  ch.callbacks = std::make_unique<ChannelCallbacks> (*this, id);
+  const auto ins = channels.emplace (id, std::move (ch));
+  CHECK (ins.second) << "Channel " << id.ToHex () << " is already registered";
+
+  cm.RegisterCallback (*ins.first->second.callbacks);
+  Update (id);
+}
+
+void
+DisputeScheduler::RemoveChannel (const uint256& channelId)
+{
+  const auto mit = channels.find (channelId);
+  CHECK (mit != channels.end ())
+      << "Channel " << channelId.ToHex () << " is not registered";
+
+  Channel& ch = mit->second;
+  ch.manager->UnregisterCallback (*ch.callbacks);
+  if (ch.expiry != 0)
+    queue.erase (std::make_pair (ch.expiry, channelId));
+
+  channels.erase (mit);
+}
+
+void
+DisputeScheduler::Update (const uint256& channelId)
+{
+  const auto mit = channels.find (channelId);
+  CHECK (mit != channels.end ());
+  Channel& ch = mit->second;
+
+  const unsigned disputeHeight = ch.manager->GetDisputeHeight ();
+  const unsigned expiry = (disputeHeight == 0 ? 0
+                                              : disputeHeight + disputeBlocks);
+  if (expiry == ch.expiry)
+    return;
+
+  if (ch.expiry != 0)
+    queue.erase (std::make_pair (ch.expiry, channelId));
+  ch.expiry = expiry;
+  if (ch.expiry != 0)
+    {
+      VLOG (1)
+          << "Dispute on channel " << channelId.ToHex ()
+          << " expires at height " << ch.expiry;
+      queue.emplace (ch.expiry, channelId);
+    }
+}
+
+DisputeScheduler::QueueSet::const_iterator
+DisputeScheduler::FirstUnexpired (const unsigned h) const
+{
+  uint256 minId;
+  minId.SetNull ();
+
+  return queue.lower_bound (std::make_pair (h + 1, minId));
+}
+
+unsigned
+DisputeScheduler::ProcessBlock (const unsigned h, const unsigned maxResolutions)
+{
+  /* Resolving a dispute notifies about a state change, which updates the
+     queue through our callbacks.  Thus we first collect the channels
+     to process.  */
+  std::vector<uint256> due;
+  for (auto it = FirstUnexpired (h); it != queue.end (); ++it)
+    due.push_back (it->second);
+
+  unsigned requested = 0;
+  for (size_t i = 0; i < due.size (); ++i)
+    {
+      if (maxResolutions > 0 && requested >= maxResolutions)
+        {
+          LOG (WARNING)
+              << "Resolution limit reached, deferring "
+              << (due.size () - i) << " disputes";
+          break;
+        }
+
+      const uint256& id = due[i];
+      const auto mit = channels.find (id);
+      CHECK (mit != channels.end ());
+      if (!mit->second.manager->RetryDisputeResolution ())
+        continue;
+
+      LOG (INFO)
+          << "Requested resolution for channel " << id.ToHex ()
+          << ", expiring at height " << mit->second.expiry;
+      ++requested;
+    }
+
+  resolutionsRequested += requested;
+  return requested;
+}
+
+unsigned
+DisputeScheduler::GetExpiryHeight (const uint256& channelId) const
+{
+  const auto mit = channels.find (channelId);
+  CHECK (mit != channels.end ())
+      << "Channel " << channelId.ToHex () << " is not registered";
+  return mit->second.expiry;
+}
+
+std::vector<uint256>
+DisputeScheduler::GetDisputedChannels () const
+{
+  std::vector<uint256> res;
+  for (const auto& entry : queue)
+    res.push_back (entry.second);
+  return res;
+}
+
+DisputeScheduler::Metrics
+DisputeScheduler::GetMetrics (const unsigned h) const
+{
+  Metrics res;
+  res.disputes = queue.size ();
+  res.resolutionsRequested = resolutionsRequested;
+
+  const auto firstOpen = FirstUnexpired (h);
+  res.expired = std::distance (queue.begin (), firstOpen);
+  if (firstOpen != queue.end ())
+    res.minBlocksToExpiry = firstOpen->first - h;
+
+  return res;
+}
+
+Json::Value
+DisputeScheduler::ToJson (const unsigned h) const
+{
+  const Metrics metrics = GetMetrics (h);
+
+  Json::Value res(Json::objectValue);
+  res["height"] = static_cast<int> (h);
+  res["count"] = static_cast<int> (metrics.disputes);
+  res["expired"] = static_cast<int> (metrics.expired);
+  res["resolutions"] = static_cast<int> (metrics.resolutionsRequested);
+  if (metrics.disputes > metrics.expired)
+    res["minblockstoexpiry"] = static_cast<int> (metrics.minBlocksToExpiry);
+
+  Json::Value disputes(Json::arrayValue);
+  for (const auto& entry : queue)
+    {
+      Json::Value cur(Json::objectValue);
+      cur["id"] = entry.second.ToHex ();
+      cur["expiry"] = static_cast<int> (entry.first);
+      cur["blockstoexpiry"] = (entry.first > h
+                                ? static_cast<int> (entry.first - h) : 0);
+      disputes.append (cur);
+    }
+  res["disputes"] = disputes;
+
+  return res;
+}
+
+} // namespace xaya
@@ -0,0 +1,177 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GAMECHANNEL_DISPUTESCHEDULER_HPP
+#define GAMECHANNEL_DISPUTESCHEDULER_HPP
+
+#include "channelmanager.hpp"
+
+#include <xayautil/uint256.hpp>
+
+#include <json/json.h>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace xaya
+{
+
+/**
+ * Scheduler that keeps track of open disputes across many channels (each
+ * with its own ChannelManager), ordered by the block height at which they
+ * expire.  When called for a new block, it retries the resolution of the
+ * disputes that expire first, so that with many disputes open at once the
+ * most urgent ones are handled (and, if a TransactionQueue is used, their
+ * resolutions are queued) first.
+ *
+ * The dispute data is refreshed automatically whenever a registered manager
+ * notifies about a state change.  Like ChannelManager itself, this class
+ * does no locking; the caller has to make sure that no other operations
+ * on the managers run concurrently.
+ */
+class DisputeScheduler
+{
+
+public:
+
+  /**
+   * Metrics about the tracked disputes at some block height.
+   */
+  struct Metrics
+  {
+
+    /** Number of open disputes on the registered channels.  */
+    unsigned disputes = 0;
+
+    /** Number of disputes that have expired already.  */
+    unsigned expired = 0;
+
+    /**
+     * The minimum number of blocks left until any of the not-yet-expired
+     * disputes expires.  Zero if there are no such disputes.
+     */
+    unsigned minBlocksToExpiry = 0;
+
+    /** Total number of resolutions requested by the scheduler so far.  */
+    unsigned resolutionsRequested = 0;
+
+  };
+
+private:
+
+  class ChannelCallbacks;
+
+  /**
+   * Data kept about a registered channel.
+   */
+  struct Channel
+  {
+
+    /** The channel's manager.  */
+    ChannelManager* manager;
+
+    /** Callbacks registered with the manager.  */
+    std::unique_ptr<ChannelCallbacks> callbacks;
+
+    /** Expiry height of the channel's dispute, or zero if there is none.  */
+    unsigned expiry = 0;
+
+  };
+
+  /**
+   * Number of blocks after the block of a dispute, at which the dispute
+   * expires (i.e. at which it can no longer be resolved).
+   */
+  const unsigned disputeBlocks;
+
+  /** The registered channels by ID.  */
+  std::map<uint256, Channel> channels;
+
+  using QueueSet = std::set<std::pair<unsigned, uint256>>;
+
+  /** Disputed channels ordered by (expiry height, channel ID).  */
+  QueueSet queue;
+
+  /** Number of resolutions requested through ProcessBlock.  */
+  unsigned resolutionsRequested = 0;
+
+  /**
+   * Refreshes the dispute data of the given channel from its manager.
+   */
+  void Update (const uint256& channelId);
+
+  /**
+   * Returns an iterator to the first dispute in the queue that has not
+   * yet expired at block height h.
+   */
+  QueueSet::const_iterator FirstUnexpired (unsigned h) const;
+
+public:
+
+  /**
+   * Constructs the scheduler for a game in which disputes expire the
+   * given number of blocks after they have been filed.
+   */
+  explicit DisputeScheduler (unsigned blocks);
+
+  ~DisputeScheduler ();
+
+  DisputeScheduler () = delete;
+  DisputeScheduler (const DisputeScheduler&) = delete;
+  void operator= (const DisputeScheduler&) = delete;
+
+  /**
+   * Registers a channel manager, whose disputes will then be tracked.
+   */
+  void AddChannel (ChannelManager& cm);
+
+  /**
+   * Removes the channel with the given ID.
+   */
+  void RemoveChannel (const uint256& channelId);
+
+  /**
+   * Processes the disputes for a new block at height h (which should be
+   * called right after the on-chain updates for the block have been
+   * processed and before routine work).  This goes through the disputes
+   * that are not yet expired in order of their expiry, and retries to
+   * resolve each one (e.g. if a resolution dropped out of the mempool).
+   * If maxResolutions is non-zero, then at most that many resolutions
+   * are requested, and disputes expiring later are left for the next call.
+   *
+   * Returns the number of resolutions requested.
+   */
+  unsigned ProcessBlock (unsigned h, unsigned maxResolutions = 0);
+
+  /**
+   * Returns the expiry height of the dispute for the given channel,
+   * or zero if there is none.
+   */
+  unsigned GetExpiryHeight (const uint256& channelId) const;
+
+  /**
+   * Returns the IDs of all disputed channels, in the order in which
+   * they expire.
+   */
+  std::vector<uint256> GetDisputedChannels () const;
+
+  /**
+   * Returns metrics about the disputes at block height h.
+   */
+  Metrics GetMetrics (unsigned h) const;
+
+  /**
+   * Returns metrics and the time-to-expiry of all disputes (in order of
+   * expiry) at block height h as JSON.
+   */
+  Json::Value ToJson (unsigned h) const;
+
+};
+
+} // namespace xaya
+
+#endif // GAMECHANNEL_DISPUTESCHEDULER_HPP
@@ -0,0 +1,199 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "disputescheduler.hpp"
+
+#include "channelmanager_tests.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace xaya
+{
+namespace
+{
+
+using testing::ElementsAre;
+using testing::HasSubstr;
+using testing::InSequence;
+
+/** Number of blocks after which disputes expire in the tests.  */
+constexpr unsigned DISPUTE_BLOCKS = 10;
+
+class DisputeSchedulerTests : public ChannelManagerTestFixture
+{
+
+protected:
+
+  /**
+   * A channel managed in addition to the fixture's one.
+   */
+  struct ExtraChannel
+  {
+
+    std::unique_ptr<ChannelManager> manager;
+    std::unique_ptr<MoveSender> sender;
+
+  };
+
+  std::vector<ExtraChannel> extra;
+
+  DisputeScheduler scheduler;
+
+  DisputeSchedulerTests ()
+    : scheduler(DISPUTE_BLOCKS)
+  {
+    scheduler.AddChannel (cm);
+  }
+
+  /**
+   * Adds a new channel to the scheduler, and returns its manager.
+   */
+  ChannelManager&
+  AddChannel (const std::string& name)
+  {
+    const uint256 id = SHA256::Hash (name);
+
+    ExtraChannel ch;
+    ch.manager = std::make_unique<ChannelManager> (
+        game.rules, game.channel, verifier, signer, "game id", id, "player");
+    ch.sender = std::make_unique<MoveSender> (
+        "game id", id, "player", txSender, game.channel);
+    ch.manager->SetMoveSender (*ch.sender);
+
+    extra.push_back (std::move (ch));
+    auto& res = *extra.back ().manager;
+    scheduler.AddChannel (res);
+
+    return res;
+  }
+
+  /**
+   * Puts a channel into dispute at the given height, with a state that
+   * can be resolved by us.  The initial resolution is sent right away,
+   * and then the simulated mempool is cleared (as if it was dropped).
+   */
+  void
+  Dispute (ChannelManager& m, const unsigned disputeHeight)
+  {
+    txSender.ExpectSuccess ("player", HasSubstr (m.GetChannelId ().ToHex ()));
+    m.ProcessOnChain (blockHash, disputeHeight, meta, "0 0",
+                      ValidProof ("10 5"), disputeHeight);
+    m.ProcessOffChain ("", ValidProof ("12 6"));
+    txSender.ClearMempool ();
+  }
+
+  /**
+   * Expects resolutions to be sent for the given channels in order.
+   */
+  void
+  ExpectResolutions (const std::vector<const ChannelManager*>& managers)
+  {
+    InSequence seq;
+    for (const auto* m : managers)
+      txSender.ExpectSuccess ("player",
+                              HasSubstr (m->GetChannelId ().ToHex ()));
+  }
+
+};
+
+TEST_F (DisputeSchedulerTests, TracksDisputes)
+{
+  auto& other = AddChannel ("other");
+  EXPECT_TRUE (scheduler.GetDisputedChannels ().empty ());
+  EXPECT_EQ (scheduler.GetExpiryHeight (channelId), 0);
+
+  Dispute (cm, 20);
+  Dispute (other, 15);
+  EXPECT_EQ (scheduler.GetExpiryHeight (channelId), 30);
+  EXPECT_EQ (scheduler.GetExpiryHeight (other.GetChannelId ()), 25);
+  EXPECT_THAT (scheduler.GetDisputedChannels (),
+               ElementsAre (other.GetChannelId (), channelId));
+
+  ProcessOnChain ("0 0", ValidProof ("12 6"), 0);
+  EXPECT_EQ (scheduler.GetExpiryHeight (channelId), 0);
+  EXPECT_THAT (scheduler.GetDisputedChannels (),
+               ElementsAre (other.GetChannelId ()));
+
+  scheduler.RemoveChannel (other.GetChannelId ());
+  EXPECT_TRUE (scheduler.GetDisputedChannels ().empty ());
+}
+
+TEST_F (DisputeSchedulerTests, ResendsInOrderOfExpiry)
+{
+  auto& a = AddChannel ("a");
+  auto& b = AddChannel ("b");
+  Dispute (cm, 30);
+  Dispute (a, 10);
+  Dispute (b, 20);
+
+  ExpectResolutions ({&a, &b, &cm});
+  EXPECT_EQ (scheduler.ProcessBlock (19), 3);
+
+  /* The resolutions are pending now, so nothing is resent.  */
+  EXPECT_EQ (scheduler.ProcessBlock (19), 0);
+  EXPECT_EQ (scheduler.GetMetrics (19).resolutionsRequested, 3);
+}
+
+TEST_F (DisputeSchedulerTests, SkipsExpired)
+{
+  auto& a = AddChannel ("a");
+  Dispute (cm, 10);
+  Dispute (a, 20);
+
+  ExpectResolutions ({&a});
+  EXPECT_EQ (scheduler.ProcessBlock (20), 1);
+}
+
+TEST_F (DisputeSchedulerTests, MaxResolutions)
+{
+  auto& a = AddChannel ("a");
+  auto& b = AddChannel ("b");
+  Dispute (cm, 30);
+  Dispute (a, 10);
+  Dispute (b, 20);
+
+  ExpectResolutions ({&a, &b});
+  EXPECT_EQ (scheduler.ProcessBlock (15, 2), 2);
+
+  ExpectResolutions ({&cm});
+  EXPECT_EQ (scheduler.ProcessBlock (15, 2), 1);
+}
+
+TEST_F (DisputeSchedulerTests, Metrics)
+{
+  auto& a = AddChannel ("a");
+  auto& b = AddChannel ("b");
+
+  auto metrics = scheduler.GetMetrics (10);
+  EXPECT_EQ (metrics.disputes, 0);
+  EXPECT_EQ (metrics.minBlocksToExpiry, 0);
+
+  Dispute (cm, 30);
+  Dispute (a, 10);
+  Dispute (b, 20);
+
+  metrics = scheduler.GetMetrics (25);
+  EXPECT_EQ (metrics.disputes, 3);
+  EXPECT_EQ (metrics.expired, 1);
+  EXPECT_EQ (metrics.minBlocksToExpiry, 5);
+
+  const auto json = scheduler.ToJson (25);
+  EXPECT_EQ (json["count"].asInt (), 3);
+  EXPECT_EQ (json["expired"].asInt (), 1);
+  EXPECT_EQ (json["minblockstoexpiry"].asInt (), 5);
+  ASSERT_EQ (json["disputes"].size (), 3);
+  EXPECT_EQ (json["disputes"][0]["id"].asString (),
+             a.GetChannelId ().ToHex ());
+  EXPECT_EQ (json["disputes"][0]["blockstoexpiry"].asInt (), 0);
+  EXPECT_EQ (json["disputes"][2]["expiry"].asInt (), 40);
+  EXPECT_EQ (json["disputes"][2]["blockstoexpiry"].asInt (), 15);
+}
+
+} // anonymous namespace
+} // namespace xaya
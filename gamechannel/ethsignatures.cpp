@@ -1,4 +1,4 @@
-// Copyright (C) 2022 The Xaya developers
+// Copyright (C) 2022-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -11,13 +11,81 @@
 namespace xaya
 {
 
+namespace
+{
+
+/** Prefix byte for address keys that hold the raw address.  */
+constexpr char KEY_BINARY = '\x01';
+/** Prefix byte for address keys that hold some other (invalid) string.  */
+constexpr char KEY_OTHER = '\x00';
+
+/** The "address" returned by RecoverSigner for invalid signatures.  */
+const std::string INVALID_SIGNER = "invalid";
+
+/**
+ * Returns the binary key for a valid address.
+ */
+std::string
+BinaryKey (const ethutils::Address& addr)
+{
+  const std::string hex = addr.GetLowerCase ();
+  CHECK_EQ (hex.substr (0, 2), "0x") << "Unexpected address format: " << hex;
+
+  std::string res(1, KEY_BINARY);
+  std::string bin;
+  CHECK (ethutils::Unhexlify (hex.substr (2), bin))
+      << "Unexpected address format: " << hex;
+  res.append (bin);
+
+  return res;
+}
+
+/**
+ * Returns the key for an arbitrary string that does not correspond
+ * to a valid checksummed address.
+ */
+std::string
+OtherKey (const std::string& str)
+{
+  return std::string (1, KEY_OTHER) + str;
+}
+
+} // anonymous namespace
+
+ethutils::Address
+EthSignatureVerifier::RecoverAddress (const std::string& msg,
+                                      const std::string& sgn) const
+{
+  const std::string sgnHex = "0x" + ethutils::Hexlify (sgn);
+  return ctx.VerifyMessage (msg, sgnHex);
+}
+
 std::string
 EthSignatureVerifier::RecoverSigner (const std::string& msg,
                                      const std::string& sgn) const
 {
-  const std::string sgnHex = "0x" + ethutils::Hexlify (sgn);
-  const ethutils::Address addr = ctx.VerifyMessage (msg, sgnHex);
-  return addr ? addr.GetChecksummed () : "invalid";
+  const ethutils::Address addr = RecoverAddress (msg, sgn);
+  return addr ? addr.GetChecksummed () : INVALID_SIGNER;
+}
+
+std::string
+EthSignatureVerifier::GetAddressKey (const std::string& addr) const
+{
+  /* RecoverSigner returns checksummed addresses, so only an address string
+     in exactly that form can ever match a valid signature.  */
+  const ethutils::Address parsed(addr);
+  if (parsed && parsed.GetChecksummed () == addr)
+    return BinaryKey (parsed);
+
+  return OtherKey (addr);
+}
+
+std::string
+EthSignatureVerifier::RecoverSignerKey (const std::string& msg,
+                                        const std::string& sgn) const
+{
+  const ethutils::Address addr = RecoverAddress (msg, sgn);
+  return addr ? BinaryKey (addr) : OtherKey (INVALID_SIGNER);
 }
 
 EthSignatureSigner::EthSignatureSigner (const ethutils::ECDSA& c,
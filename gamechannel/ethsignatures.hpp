@@ -1,4 +1,4 @@
-// Copyright (C) 2022 The Xaya developers
+// Copyright (C) 2022-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -33,6 +33,13 @@ private:
   /** The underlying eth-utils ECDSA context.  */
   const ethutils::ECDSA& ctx;
 
+  /**
+   * Recovers the signer address for a raw signature.  Returns an invalid
+   * address if the signature is malformed.
+   */
+  ethutils::Address RecoverAddress (const std::string& msg,
+                                    const std::string& sgn) const;
+
 public:
 
   explicit EthSignatureVerifier (const ethutils::ECDSA& c)
@@ -42,6 +49,17 @@ public:
   std::string RecoverSigner (const std::string& msg,
                              const std::string& sgn) const override;
 
+  /**
+   * Keys for valid checksummed addresses are their raw 20 bytes, so that
+   * recovered signers can be matched without computing their checksummed
+   * form (which requires an extra Keccak hash).  Any other address string
+   * (which can never match a valid recovered address) maps to a key that
+   * is distinct from all binary ones.
+   */
+  std::string GetAddressKey (const std::string& addr) const override;
+  std::string RecoverSignerKey (const std::string& msg,
+                                const std::string& sgn) const override;
+
 };
 
 /**
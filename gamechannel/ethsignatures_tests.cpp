@@ -1,4 +1,4 @@
-// Copyright (C) 2022 The Xaya developers
+// Copyright (C) 2022-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -70,5 +70,35 @@ TEST_F (EthSignaturesTests, Roundtrip)
   EXPECT_NE (verifier.RecoverSigner ("bar", sgn), ADDR);
 }
 
+TEST_F (EthSignaturesTests, SignerKeys)
+{
+  const std::string sgn = signer.SignMessage ("foo");
+  const std::string key = verifier.GetAddressKey (ADDR);
+  EXPECT_EQ (key.size (), 21);
+
+  EXPECT_EQ (verifier.RecoverSignerKey ("foo", sgn), key);
+  EXPECT_NE (verifier.RecoverSignerKey ("bar", sgn), key);
+  EXPECT_EQ (verifier.RecoverSignerKey ("foo", "invalid"),
+             verifier.GetAddressKey ("invalid"));
+}
+
+TEST_F (EthSignaturesTests, NonChecksummedAddressKey)
+{
+  /* Addresses in the metadata that are not in checksummed form never
+     match with RecoverSigner, and thus must not match with keys either.  */
+  std::string lower = ADDR;
+  for (auto& c : lower)
+    if (c >= 'A' && c <= 'F')
+      c = c - 'A' + 'a';
+  ASSERT_NE (lower, ADDR);
+
+  const std::string sgn = signer.SignMessage ("foo");
+  EXPECT_NE (verifier.RecoverSigner ("foo", sgn), lower);
+  EXPECT_NE (verifier.RecoverSignerKey ("foo", sgn),
+             verifier.GetAddressKey (lower));
+  EXPECT_NE (verifier.GetAddressKey ("invalid"),
+             verifier.GetAddressKey (ADDR));
+}
+
 } // anonymous namespace
 } // namespace xaya
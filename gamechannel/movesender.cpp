@@ -4,11 +4,62 @@
 
 #include "movesender.hpp"
 
+#include "transactionqueue.hpp"
+
 #include <glog/logging.h>
 
 namespace xaya
 {
 
+/* ************************************************************************** */
+
+PendingMove::PendingMove (const uint256& id)
+{
+  std::promise<uint256> p;
+  p.set_value (id);
+  txid = p.get_future ().share ();
+}
+
+PendingMove::PendingMove (const std::shared_future<uint256>& id)
+  : txid(id)
+{}
+
+bool
+PendingMove::IsNull () const
+{
+  if (!txid.valid ())
+    return true;
+  if (IsQueued ())
+    return false;
+  return txid.get ().IsNull ();
+}
+
+bool
+PendingMove::IsQueued () const
+{
+  if (!txid.valid ())
+    return false;
+  return txid.wait_for (std::chrono::seconds (0))
+            != std::future_status::ready;
+}
+
+uint256
+PendingMove::GetTxid () const
+{
+  CHECK (!IsQueued ()) << "Move is still queued";
+
+  if (!txid.valid ())
+    {
+      uint256 res;
+      res.SetNull ();
+      return res;
+    }
+
+  return txid.get ();
+}
+
+/* ************************************************************************** */
+
 MoveSender::MoveSender (const std::string& gId,
                         const uint256& chId, const std::string& nm,
                         TransactionSender& s, OpenChannel& oc)
@@ -19,14 +70,40 @@ MoveSender::MoveSender (const std::string& gId,
   jsonWriterBuilder["enableYAMLCompatibility"] = false;
 }
 
-uint256
-MoveSender::SendMove (const Json::Value& mv)
+std::string
+MoveSender::SerialiseMove (const Json::Value& mv) const
 {
   Json::Value fullValue(Json::objectValue);
   fullValue["g"][gameId] = mv;
 
-  const std::string strValue = Json::writeString (jsonWriterBuilder, fullValue);
-  LOG (INFO) << "Sending move: " << playerName << "\n" << strValue;
+  return Json::writeString (jsonWriterBuilder, fullValue);
+}
+
+size_t
+MoveSender::GetProjectedSize (const Json::Value& mv) const
+{
+  return SerialiseMove (mv).size ();
+}
+
+size_t
+MoveSender::GetProjectedDisputeSize (const proto::StateProof& proof) const
+{
+  return GetProjectedSize (game.DisputeMove (channelId, proof));
+}
+
+size_t
+MoveSender::GetProjectedResolutionSize (const proto::StateProof& proof) const
+{
+  return GetProjectedSize (game.ResolutionMove (channelId, proof));
+}
+
+uint256
+MoveSender::SendMove (const Json::Value& mv)
+{
+  const std::string strValue = SerialiseMove (mv);
+  LOG (INFO)
+      << "Sending move (" << strValue.size () << " bytes): "
+      << playerName << "\n" << strValue;
 
   uint256 res;
   try
@@ -54,4 +131,55 @@ MoveSender::SendResolution (const proto::StateProof& proof)
   return SendMove (game.ResolutionMove (channelId, proof));
 }
 
+void
+MoveSender::SetQueue (TransactionQueue& q)
+{
+  CHECK (queue == nullptr);
+  queue = &q;
+}
+
+PendingMove
+MoveSender::QueueMove (const Json::Value& mv, const std::string& dedupKey,
+                       const bool urgent)
+{
+  CHECK (queue != nullptr) << "No TransactionQueue set";
+
+  const std::string strValue = SerialiseMove (mv);
+  LOG (INFO)
+      << "Queueing move (" << strValue.size () << " bytes): "
+      << playerName << "\n" << strValue;
+
+  return PendingMove (queue->Submit (playerName, strValue, dedupKey, urgent));
+}
+
+PendingMove
+MoveSender::QueueDispute (const proto::StateProof& proof)
+{
+  return QueueMove (game.DisputeMove (channelId, proof),
+                    "dispute " + channelId.ToHex ());
+}
+
+PendingMove
+MoveSender::QueueResolution (const proto::StateProof& proof)
+{
+  return QueueMove (game.ResolutionMove (channelId, proof),
+                    "resolution " + channelId.ToHex (), true);
+}
+
+PendingMove
+MoveSender::RequestDispute (const proto::StateProof& proof)
+{
+  if (HasQueue ())
+    return QueueDispute (proof);
+  return PendingMove (SendDispute (proof));
+}
+
+PendingMove
+MoveSender::RequestResolution (const proto::StateProof& proof)
+{
+  if (HasQueue ())
+    return QueueResolution (proof);
+  return PendingMove (SendResolution (proof));
+}
+
 } // namespace xaya
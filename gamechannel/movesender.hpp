@@ -12,6 +12,8 @@
 
 #include <json/writer.h>
 
+#include <cstddef>
+#include <future>
 #include <string>
 
 namespace xaya
@@ -49,6 +51,71 @@ public:
 
 /* ************************************************************************** */
 
+class TransactionQueue;
+
+/**
+ * Handle for a move that has been requested to be sent.  If the move was
+ * sent synchronously, then the txid is known right away.  If it was submitted
+ * through a TransactionQueue, the txid only becomes known once the queue
+ * has actually sent the transaction.
+ */
+class PendingMove
+{
+
+private:
+
+  /** The future txid.  If not valid, then there is no move at all.  */
+  std::shared_future<uint256> txid;
+
+public:
+
+  /**
+   * Constructs a null instance (not representing any move).
+   */
+  PendingMove () = default;
+
+  /**
+   * Constructs an instance for a move whose txid is known already.
+   */
+  explicit PendingMove (const uint256& id);
+
+  /**
+   * Constructs an instance for a move whose txid will be known later.
+   */
+  explicit PendingMove (const std::shared_future<uint256>& id);
+
+  PendingMove (const PendingMove&) = default;
+  PendingMove& operator= (const PendingMove&) = default;
+
+  /**
+   * Returns true if this does not represent any move.  If the txid is known
+   * and null (i.e. sending failed), this also counts as null.
+   */
+  bool IsNull () const;
+
+  /**
+   * Returns true if this represents a move whose txid is not yet known,
+   * i.e. the move is still waiting in a TransactionQueue.
+   */
+  bool IsQueued () const;
+
+  /**
+   * Returns the txid of the move.  Must only be called if the move is
+   * not queued.  Returns null if there is no move.
+   */
+  uint256 GetTxid () const;
+
+  /**
+   * Resets the instance to null.
+   */
+  void
+  SetNull ()
+  {
+    txid = std::shared_future<uint256> ();
+  }
+
+};
+
 /**
  * A connection to the network that allows sending moves (mainly
  * disputes and resolutions from ChannelManager, but also game-specific code
@@ -87,6 +154,18 @@ private:
    */
   Json::StreamWriterBuilder jsonWriterBuilder;
 
+  /**
+   * If set, the queue used for asynchronous sending of moves.  This is not
+   * owned by the MoveSender.
+   */
+  TransactionQueue* queue = nullptr;
+
+  /**
+   * Serialises the given move JSON (with the game ID envelope) to the
+   * string value that is sent in the transaction.
+   */
+  std::string SerialiseMove (const Json::Value& mv) const;
+
 public:
 
   explicit MoveSender (const std::string& gId,
@@ -97,6 +176,24 @@ public:
   MoveSender (const MoveSender&) = delete;
   void operator= (const MoveSender&) = delete;
 
+  /**
+   * Returns the size in bytes of the move value that would be sent in a
+   * transaction for the given move JSON (including the game-ID envelope).
+   * This can be used to estimate fees or check against the value size
+   * limit before actually sending a move.
+   */
+  size_t GetProjectedSize (const Json::Value& mv) const;
+
+  /**
+   * Returns the projected size of a dispute move for the given proof.
+   */
+  size_t GetProjectedDisputeSize (const proto::StateProof& proof) const;
+
+  /**
+   * Returns the projected size of a resolution move for the given proof.
+   */
+  size_t GetProjectedResolutionSize (const proto::StateProof& proof) const;
+
   /**
    * Sends the given JSON value as move.  This is used for the implementations
    * of SendDispute and SendResolution, and it can also be used by game-specific
@@ -119,6 +216,57 @@ public:
    */
   uint256 SendResolution (const proto::StateProof& proof);
 
+  /**
+   * Sets a TransactionQueue to use for the Queue* methods.  The queue must
+   * be for the same TransactionSender as this instance.
+   */
+  void SetQueue (TransactionQueue& q);
+
+  /**
+   * Returns true if a TransactionQueue has been set.
+   */
+  bool
+  HasQueue () const
+  {
+    return queue != nullptr;
+  }
+
+  /**
+   * Submits the given JSON value as move through the TransactionQueue
+   * (which must be set), and returns immediately.  If dedupKey is not
+   * empty, then the move replaces a not-yet-sent one with the same key.
+   * Urgent moves are sent before other queued moves.
+   */
+  PendingMove QueueMove (const Json::Value& mv,
+                         const std::string& dedupKey = "",
+                         bool urgent = false);
+
+  /**
+   * Queues a dispute based on the given state proof.  If the queue holds
+   * another dispute for the channel that has not been sent yet, it gets
+   * replaced by the new one.
+   */
+  PendingMove QueueDispute (const proto::StateProof& proof);
+
+  /**
+   * Queues a resolution based on the given state proof.  If the queue holds
+   * another resolution for the channel that has not been sent yet, it gets
+   * replaced by the new one.  Resolutions are queued as urgent moves.
+   */
+  PendingMove QueueResolution (const proto::StateProof& proof);
+
+  /**
+   * Sends a dispute through the queue if one is set, and synchronously
+   * through SendDispute otherwise.
+   */
+  PendingMove RequestDispute (const proto::StateProof& proof);
+
+  /**
+   * Sends a resolution through the queue if one is set, and synchronously
+   * through SendResolution otherwise.
+   */
+  PendingMove RequestResolution (const proto::StateProof& proof);
+
   /**
    * Checks if a move transaction from this MoveSender with the
    * given txid is in the node's mempool.  This can be used to check if
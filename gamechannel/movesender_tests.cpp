@@ -5,6 +5,7 @@
 #include "movesender.hpp"
 
 #include "testgame.hpp"
+#include "transactionqueue.hpp"
 
 #include <xayautil/hash.hpp>
 
@@ -13,6 +14,8 @@
 
 #include <glog/logging.h>
 
+#include <thread>
+
 namespace xaya
 {
 namespace
@@ -56,5 +59,49 @@ TEST_F (MoveSenderTests, SendMoveError)
   EXPECT_TRUE (sender.SendMove (ParseJson ("{}")).IsNull ());
 }
 
+TEST_F (MoveSenderTests, ProjectedSize)
+{
+  const std::string expectedValue = R"({"g":{"game id":[42,null,{"a":"b"}]}})";
+  EXPECT_EQ (sender.GetProjectedSize (ParseJson (R"([
+    42, null, {"a": "b"}
+  ])")), expectedValue.size ());
+}
+
+TEST_F (MoveSenderTests, RequestWithoutQueue)
+{
+  const uint256 txid = txSender.ExpectSuccess ("player", testing::_);
+
+  const auto mv = sender.RequestResolution (proto::StateProof ());
+  EXPECT_FALSE (mv.IsQueued ());
+  EXPECT_EQ (mv.GetTxid (), txid);
+}
+
+TEST_F (MoveSenderTests, QueueMove)
+{
+  const std::string expectedValue = R"({"g":{"game id":{}}})";
+  const uint256 txid = txSender.ExpectSuccess ("player", expectedValue);
+
+  TransactionQueue queue(txSender);
+  sender.SetQueue (queue);
+  ASSERT_TRUE (sender.HasQueue ());
+
+  const auto mv = sender.QueueMove (ParseJson ("{}"));
+  while (mv.IsQueued ())
+    std::this_thread::yield ();
+  EXPECT_EQ (mv.GetTxid (), txid);
+}
+
+TEST_F (MoveSenderTests, PendingMoveNull)
+{
+  PendingMove mv;
+  EXPECT_TRUE (mv.IsNull ());
+  EXPECT_FALSE (mv.IsQueued ());
+  EXPECT_TRUE (mv.GetTxid ().IsNull ());
+
+  uint256 txid;
+  txid.SetNull ();
+  EXPECT_TRUE (PendingMove (txid).IsNull ());
+}
+
 } // anonymous namespace
 } // namespace xaya
@@ -0,0 +1,171 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "onchainbatch.hpp"
+
+#include "rollingstate.hpp"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace xaya
+{
+
+OnChainBatchProcessor::OnChainBatchProcessor (const unsigned threads)
+  : numThreads(threads)
+{}
+
+void
+OnChainBatchProcessor::AddChannel (ChannelManager& cm)
+{
+  Channel ch;
+  ch.manager = &cm;
+  CHECK (channels.emplace (cm.GetChannelId (), ch).second)
+      << "Channel " << cm.GetChannelId ().ToHex () << " is already registered";
+}
+
+void
+OnChainBatchProcessor::RemoveChannel (const uint256& channelId)
+{
+  CHECK_EQ (channels.erase (channelId), 1)
+      << "Channel " << channelId.ToHex () << " is not registered";
+}
+
+unsigned
+OnChainBatchProcessor::ProcessBlock (
+    const uint256& blk, const unsigned h,
+    const std::map<uint256, ChannelOnChainData>& data)
+{
+  /* Data about each channel for this block.  */
+  struct Update
+  {
+    Channel* channel;
+    /** The on-chain data, or null if the channel does not exist.  */
+    const ChannelOnChainData* data;
+    /** Whether the on-chain data changed from the previous block.  */
+    bool changed;
+    /** Whether the state proof has to be verified.  */
+    bool verify;
+  };
+  std::vector<Update> updates;
+  updates.reserve (channels.size ());
+
+  for (auto& entry : channels)
+    {
+      Channel& ch = entry.second;
+      const auto mit = data.find (entry.first);
+
+      Update u;
+      u.channel = &ch;
+      u.data = (mit == data.end () ? nullptr : &mit->second);
+      u.verify = false;
+
+      if (u.data == nullptr)
+        {
+          u.changed = (!ch.processed || ch.existed);
+          ch.existed = false;
+        }
+      else
+        {
+          const uint256 digest = OnChainUpdateDigest (
+              u.data->meta, u.data->reinitState, u.data->proof);
+          u.verify = (!ch.processed || !ch.existed || digest != ch.lastDigest);
+          u.changed = (u.verify
+                        || u.data->disputeHeight != ch.lastDisputeHeight);
+          ch.existed = true;
+          ch.lastDigest = digest;
+          ch.lastDisputeHeight = u.data->disputeHeight;
+        }
+      ch.processed = true;
+
+      updates.push_back (u);
+    }
+
+  /* Channels with a dispute are handled first, ordered by the height of
+     their dispute.  This way, resolutions for the disputes closest to
+     expiry are requested (and queued) first.  */
+  const auto disputeKey = [] (const Update& u)
+    {
+      if (u.data == nullptr || u.data->disputeHeight == 0)
+        return std::make_pair (1, 0u);
+      return std::make_pair (0, u.data->disputeHeight);
+    };
+  std::stable_sort (updates.begin (), updates.end (),
+                    [&disputeKey] (const Update& a, const Update& b)
+                      {
+                        return disputeKey (a) < disputeKey (b);
+                      });
+
+  /* Verify all new state proofs in parallel first.  The managers and their
+     states are only read here.  Proofs that were already verified for
+     an earlier block are not checked again.  */
+  std::vector<const Update*> toVerify;
+  for (const auto& u : updates)
+    if (u.verify)
+      toVerify.push_back (&u);
+
+  unsigned threads = numThreads;
+  if (threads == 0)
+    threads = std::max (1u, std::thread::hardware_concurrency ());
+  threads = std::max<size_t> (1, std::min<size_t> (threads, toVerify.size ()));
+
+  std::atomic<size_t> next(0);
+  const auto worker = [&] ()
+    {
+      while (true)
+        {
+          const size_t index = next++;
+          if (index >= toVerify.size ())
+            break;
+          const Update& u = *toVerify[index];
+          u.channel->manager->VerifyOnChain (u.data->meta, u.data->reinitState,
+                                             u.data->proof);
+        }
+    };
+
+  std::vector<std::thread> workers;
+  for (unsigned i = 1; i < threads; ++i)
+    workers.emplace_back (worker);
+  worker ();
+  for (auto& t : workers)
+    t.join ();
+
+  /* Apply the updates.  This may trigger callbacks, moves and broadcasts,
+     so it is done sequentially.  */
+  unsigned numChanged = 0;
+  for (const auto& u : updates)
+    {
+      ChannelManager& cm = *u.channel->manager;
+      if (!u.changed && cm.ProcessOnChainUnchanged (blk, h))
+        continue;
+
+      if (u.changed)
+        ++numChanged;
+
+      /* If the proof has not been verified above, it is the same as for
+         the previous block.  RollingState::UpdateOnChain then skips it
+         based on its digest anyway.  */
+      if (u.data == nullptr)
+        cm.ProcessOnChainNonExistant (blk, h);
+      else
+        cm.ProcessOnChainInternal (blk, h, u.data->meta, u.data->reinitState,
+                                   u.data->proof, u.data->disputeHeight,
+                                   u.verify);
+    }
+
+  VLOG (1)
+      << "Processed block " << blk.ToHex () << " at height " << h
+      << ": " << numChanged << " of " << channels.size ()
+      << " channels changed, " << toVerify.size () << " proofs verified"
+      << " with " << threads << " threads";
+
+  return numChanged;
+}
+
+} // namespace xaya
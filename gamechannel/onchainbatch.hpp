@@ -0,0 +1,141 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GAMECHANNEL_ONCHAINBATCH_HPP
+#define GAMECHANNEL_ONCHAINBATCH_HPP
+
+#include "boardrules.hpp"
+#include "channelmanager.hpp"
+
+#include "proto/metadata.pb.h"
+#include "proto/stateproof.pb.h"
+
+#include <xayautil/uint256.hpp>
+
+#include <map>
+
+namespace xaya
+{
+
+/**
+ * The on-chain data of one channel at a particular block, as passed
+ * to ChannelManager::ProcessOnChain.
+ */
+struct ChannelOnChainData
+{
+
+  /** The channel's metadata.  */
+  proto::ChannelMetadata meta;
+
+  /** The reinit state of the channel.  */
+  BoardState reinitState;
+
+  /** The state proof of the latest on-chain state.  */
+  proto::StateProof proof;
+
+  /** The height of an open dispute, or zero if there is none.  */
+  unsigned disputeHeight = 0;
+
+};
+
+/**
+ * Processor for on-chain updates of many channels (each with its own
+ * ChannelManager) at once.  For each block, it receives the on-chain data of
+ * all channels, and compares it to the data from the previous block.  Only
+ * the state proofs that changed are verified, and this is done in parallel
+ * threads.  Afterwards, the updates are applied (and listeners notified)
+ * one by one.  This makes the verification cost per block scale with the
+ * number of changed channels rather than the total.
+ * Channels with an open dispute are handled first, in order of the dispute
+ * height, so that the most urgent resolutions are requested first.
+ *
+ * Channels whose data is unchanged are handled through
+ * ChannelManager::ProcessOnChainUnchanged, which still does all per-block
+ * work (like checking pending transactions, calling
+ * OpenChannel::MaybeOnChainMove and notifying listeners), but does not
+ * process the state again.
+ *
+ * All on-chain updates for registered channels must go through this
+ * processor (so that the data of the previous block is known correctly).
+ * Like ChannelManager itself, this class does no locking; the caller has to
+ * make sure that no other operations on the managers run concurrently.
+ * The BoardRules and SignatureVerifier used by the managers have to be
+ * safe to use from multiple threads.
+ */
+class OnChainBatchProcessor
+{
+
+private:
+
+  /**
+   * Data kept about a registered channel.
+   */
+  struct Channel
+  {
+
+    /** The channel's manager.  */
+    ChannelManager* manager;
+
+    /** Whether we have processed any block for the channel yet.  */
+    bool processed = false;
+
+    /** Whether the channel existed on-chain at the last block.  */
+    bool existed = false;
+
+    /**
+     * Digest (see OnChainUpdateDigest) of the on-chain update at the last
+     * block processed, if the channel existed.
+     */
+    uint256 lastDigest;
+
+    /** Dispute height at the last block processed.  */
+    unsigned lastDisputeHeight = 0;
+
+  };
+
+  /** The registered channels by ID.  */
+  std::map<uint256, Channel> channels;
+
+  /** Number of threads to use for verification (zero for automatic).  */
+  const unsigned numThreads;
+
+public:
+
+  /**
+   * Constructs the processor, using the given number of threads for
+   * verifying state proofs.  Zero means to use as many as there are
+   * hardware threads.
+   */
+  explicit OnChainBatchProcessor (unsigned threads = 0);
+
+  OnChainBatchProcessor (const OnChainBatchProcessor&) = delete;
+  void operator= (const OnChainBatchProcessor&) = delete;
+
+  /**
+   * Registers a channel manager, whose channel will then be updated
+   * with each block.
+   */
+  void AddChannel (ChannelManager& cm);
+
+  /**
+   * Removes the channel with the given ID.
+   */
+  void RemoveChannel (const uint256& channelId);
+
+  /**
+   * Processes the on-chain data for a new block.  The map contains the data
+   * for all channels that exist on-chain at the block.  Registered channels
+   * that are not in the map are updated as non-existant, and data for
+   * channels that are not registered is ignored.
+   *
+   * Returns the number of channels whose on-chain data changed.
+   */
+  unsigned ProcessBlock (const uint256& blk, unsigned h,
+                         const std::map<uint256, ChannelOnChainData>& data);
+
+};
+
+} // namespace xaya
+
+#endif // GAMECHANNEL_ONCHAINBATCH_HPP
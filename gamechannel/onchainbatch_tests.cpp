@@ -0,0 +1,194 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "onchainbatch.hpp"
+
+#include "channelmanager_tests.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace xaya
+{
+namespace
+{
+
+using testing::_;
+
+class OnChainBatchProcessorTests : public ChannelManagerTestFixture
+{
+
+protected:
+
+  const uint256 otherId = SHA256::Hash ("other channel");
+
+  /** A second channel manager.  */
+  ChannelManager other;
+
+  OnChainBatchProcessor batch;
+
+  /** The data passed to ProcessBlock.  */
+  std::map<uint256, ChannelOnChainData> data;
+
+  /** Height of the next block to process.  */
+  unsigned nextHeight = 10;
+
+  OnChainBatchProcessorTests ()
+    : other(game.rules, game.channel, verifier, signer,
+            "game id", otherId, "player"),
+      batch(2)
+  {
+    batch.AddChannel (cm);
+    batch.AddChannel (other);
+  }
+
+  /**
+   * Sets the on-chain data of a channel to a fixed reinit state and
+   * the given proven state.
+   */
+  void
+  SetData (const uint256& id, const BoardState& state,
+           const unsigned dispHeight = 0)
+  {
+    auto& entry = data[id];
+    entry.meta = meta;
+    entry.reinitState = "0 0";
+    entry.proof = ValidProof (state);
+    entry.disputeHeight = dispHeight;
+  }
+
+  /**
+   * Processes the current data for a new block, and returns the number
+   * of channels whose on-chain data changed.
+   */
+  unsigned
+  Process ()
+  {
+    const unsigned h = nextHeight++;
+    return batch.ProcessBlock (SHA256::Hash (std::to_string (h)), h, data);
+  }
+
+  /**
+   * Returns the height that the test manager has recorded.
+   */
+  unsigned
+  GetHeight () const
+  {
+    unsigned h;
+    GetOnChainBlock (h);
+    return h;
+  }
+
+};
+
+TEST_F (OnChainBatchProcessorTests, InitialUpdate)
+{
+  SetData (channelId, "10 5");
+  EXPECT_EQ (Process (), 2);
+
+  EXPECT_TRUE (GetExists ());
+  EXPECT_EQ (GetLatestState (), "10 5");
+  EXPECT_EQ (GetHeight (), 10);
+  EXPECT_TRUE (cm.ToJson ()["existsonchain"].asBool ());
+  EXPECT_FALSE (other.ToJson ()["existsonchain"].asBool ());
+}
+
+TEST_F (OnChainBatchProcessorTests, UnchangedChannelsNotVerified)
+{
+  SetData (channelId, "10 5");
+  SetData (otherId, "20 5");
+  EXPECT_EQ (Process (), 2);
+
+  const int version = cm.GetStateVersion ();
+  EXPECT_CALL (verifier, RecoverSigner (_, _)).Times (0);
+
+  EXPECT_EQ (Process (), 0);
+  EXPECT_EQ (Process (), 0);
+  EXPECT_EQ (GetHeight (), 12);
+  EXPECT_EQ (GetLatestState (), "10 5");
+
+  /* Listeners are still notified about each new block.  */
+  EXPECT_EQ (cm.GetStateVersion (), version + 2);
+  EXPECT_EQ (cm.ToJson ()["height"].asInt (), 12);
+}
+
+TEST_F (OnChainBatchProcessorTests, ChangedChannelProcessed)
+{
+  SetData (channelId, "10 5");
+  SetData (otherId, "20 5");
+  EXPECT_EQ (Process (), 2);
+
+  SetData (channelId, "12 6");
+  EXPECT_EQ (Process (), 1);
+  EXPECT_EQ (GetLatestState (), "12 6");
+
+  data.erase (channelId);
+  EXPECT_EQ (Process (), 1);
+  EXPECT_FALSE (GetExists ());
+  EXPECT_EQ (Process (), 0);
+  EXPECT_EQ (GetHeight (), 13);
+}
+
+TEST_F (OnChainBatchProcessorTests, DisputeNotVerifiedAgain)
+{
+  SetData (channelId, "11 5", 10);
+  EXPECT_EQ (Process (), 2);
+  ASSERT_NE (GetDispute (), nullptr);
+
+  EXPECT_CALL (verifier, RecoverSigner (_, _)).Times (0);
+
+  EXPECT_EQ (Process (), 0);
+  EXPECT_EQ (Process (), 0);
+  ASSERT_NE (GetDispute (), nullptr);
+  EXPECT_EQ (GetDispute ()->height, 10);
+
+  /* A new dispute for the same state is processed, but the proof
+     need not be verified again.  */
+  SetData (channelId, "11 5", 13);
+  EXPECT_EQ (Process (), 1);
+  ASSERT_NE (GetDispute (), nullptr);
+  EXPECT_EQ (GetDispute ()->height, 13);
+
+  SetData (channelId, "11 5");
+  EXPECT_EQ (Process (), 1);
+  EXPECT_EQ (GetDispute (), nullptr);
+}
+
+TEST_F (OnChainBatchProcessorTests, UnregisteredChannelIgnored)
+{
+  SetData (SHA256::Hash ("unknown"), "10 5");
+  EXPECT_EQ (Process (), 2);
+  EXPECT_EQ (Process (), 0);
+
+  batch.RemoveChannel (otherId);
+  SetData (otherId, "20 5");
+  EXPECT_EQ (Process (), 0);
+}
+
+TEST_F (OnChainBatchProcessorTests, ManyChannelsInParallel)
+{
+  std::vector<std::unique_ptr<ChannelManager>> managers;
+  for (unsigned i = 0; i < 20; ++i)
+    {
+      const uint256 id = SHA256::Hash ("channel " + std::to_string (i));
+      managers.push_back (std::make_unique<ChannelManager> (
+          game.rules, game.channel, verifier, signer, "game id", id, "player"));
+      batch.AddChannel (*managers.back ());
+      SetData (id, "10 5");
+    }
+
+  EXPECT_EQ (Process (), 22);
+  for (const auto& m : managers)
+    EXPECT_EQ (m->ToJson ()["current"]["state"]["base64"].asString (),
+               "MTAgNQ==");
+  EXPECT_EQ (Process (), 0);
+}
+
+} // anonymous namespace
+} // namespace xaya
@@ -0,0 +1,149 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "parsedstatecache.hpp"
+
+#include "digestcache.hpp"
+
+#include <glog/logging.h>
+
+namespace xaya
+{
+
+ParsedStateCache::ParsedStateCache (const BoardRules& r, const size_t maxSize)
+  : rules(r), maxTotalSize(maxSize)
+{
+  CHECK_GT (maxTotalSize, 0);
+}
+
+std::shared_ptr<const ParsedBoardState>
+ParsedStateCache::Get (const uint256& channelId,
+                       const proto::ChannelMetadata& meta,
+                       const BoardState& s)
+{
+  return GetInternal (channelId, meta, s, nullptr);
+}
+
+std::shared_ptr<const ParsedBoardState>
+ParsedStateCache::Get (const uint256& channelId,
+                       const proto::ChannelMetadata& meta,
+                       const SharedBoardState& s)
+{
+  return GetInternal (channelId, meta, s.Get (), &s);
+}
+
+std::shared_ptr<const ParsedBoardState>
+ParsedStateCache::GetInternal (const uint256& channelId,
+                               const proto::ChannelMetadata& meta,
+                               const BoardState& s,
+                               const SharedBoardState* buffer)
+{
+  std::string key = channelId.GetBinaryString ();
+  key += DataDigestCache::Global ().Get (s).GetBinaryString ();
+  key += meta.reinit ();
+
+  /* Look up the state first.  If it is not cached, we parse it without
+     holding the lock, so that other threads can use the cache (and parse
+     other states) in parallel.  */
+  {
+    std::lock_guard<std::mutex> lock(mut);
+    const auto mit = index.find (key);
+    if (mit != index.end ())
+      {
+        ++hits;
+        entries.splice (entries.begin (), entries, mit->second);
+        return ToResult (entries.front ());
+      }
+    ++misses;
+  }
+
+  /* The entry is filled in fully before it gets shared, so that the
+     references in the parsed state are to the final location of
+     channel ID and metadata.  */
+  auto newEntry = std::make_shared<Entry> ();
+  newEntry->key = key;
+  newEntry->channelId = channelId;
+  newEntry->meta = meta;
+  if (buffer == nullptr)
+    newEntry->parsed = rules.ParseState (newEntry->channelId,
+                                         newEntry->meta, s);
+  else
+    newEntry->parsed = rules.ParseStateBuffer (newEntry->channelId,
+                                               newEntry->meta, *buffer);
+  newEntry->size = key.size () + s.size () + meta.ByteSizeLong ();
+  std::shared_ptr<const Entry> entry = std::move (newEntry);
+
+  if (entry->size > maxTotalSize)
+    {
+      VLOG (2) << "Parsed state is too large to be cached";
+      return ToResult (entry);
+    }
+
+  std::lock_guard<std::mutex> lock(mut);
+
+  /* Another thread may have parsed and inserted the same state while we
+     were parsing.  In that case, we use its entry, so that all callers
+     share the same instance.  */
+  const auto mit = index.find (key);
+  if (mit != index.end ())
+    {
+      entries.splice (entries.begin (), entries, mit->second);
+      return ToResult (entries.front ());
+    }
+
+  entries.push_front (entry);
+  index.emplace (std::move (key), entries.begin ());
+  totalSize += entry->size;
+
+  while (totalSize > maxTotalSize)
+    {
+      VLOG (2) << "Evicting least recently used parsed state";
+      CHECK_EQ (index.erase (entries.back ()->key), 1);
+      totalSize -= entries.back ()->size;
+      entries.pop_back ();
+    }
+
+  return ToResult (entry);
+}
+
+std::shared_ptr<const ParsedBoardState>
+ParsedStateCache::ToResult (const std::shared_ptr<const Entry>& entry)
+{
+  if (entry->parsed == nullptr)
+    return nullptr;
+
+  /* Use the aliasing constructor, so that the returned pointer keeps the
+     full entry (with channel ID and metadata) alive.  */
+  return std::shared_ptr<const ParsedBoardState> (entry, entry->parsed.get ());
+}
+
+size_t
+ParsedStateCache::GetSize () const
+{
+  std::lock_guard<std::mutex> lock(mut);
+  return entries.size ();
+}
+
+size_t
+ParsedStateCache::GetTotalSize () const
+{
+  std::lock_guard<std::mutex> lock(mut);
+  return totalSize;
+}
+
+unsigned
+ParsedStateCache::GetHits () const
+{
+  std::lock_guard<std::mutex> lock(mut);
+  return hits;
+}
+
+unsigned
+ParsedStateCache::GetMisses () const
+{
+  std::lock_guard<std::mutex> lock(mut);
+  return misses;
+}
+
+} // namespace xaya
@@ -0,0 +1,183 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GAMECHANNEL_PARSEDSTATECACHE_HPP
+#define GAMECHANNEL_PARSEDSTATECACHE_HPP
+
+#include "boardrules.hpp"
+
+#include "proto/metadata.pb.h"
+
+#include <xayautil/uint256.hpp>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace xaya
+{
+
+/**
+ * LRU cache of ParsedBoardState instances, which can be attached to
+ * a BoardRules instance with BoardRules::SetParsedStateCache.  When set,
+ * BoardRules::ParseStateShared looks up states in the cache first, so that
+ * the same encoded state (e.g. from a state proof that gets verified
+ * several times as it moves through the framework) is parsed and validated
+ * only once.  This is useful for games where parsing states is expensive.
+ *
+ * Entries are keyed by channel ID, reinit ID and the hash of the encoded
+ * state.  Since a reinit ID uniquely identifies the metadata of a channel,
+ * this determines the parsed state fully.  The memory used by the cache
+ * is bounded:  Each entry is accounted with the size of its key, encoded
+ * state and metadata (as an approximation of what it holds), and when the
+ * total exceeds the maximum, the least recently used entries are evicted.
+ * States that are too large on their own are parsed but not cached.
+ *
+ * Each entry holds its own copies of the channel ID and metadata, to which
+ * the cached ParsedBoardState refers.  The handed-out shared pointers keep
+ * the entry alive, so that those references stay valid even if the entry
+ * is evicted from the cache while still in use.
+ *
+ * Parsed states are shared between all users of the cache, so they must
+ * be immutable (i.e. the const methods of ParsedBoardState must not change
+ * any internal state).  The cache itself is thread-safe.  States are parsed
+ * without holding the cache's lock, so that multiple threads can parse
+ * states in parallel.
+ */
+class ParsedStateCache
+{
+
+private:
+
+  /**
+   * Data held for a cached state.
+   */
+  struct Entry
+  {
+
+    /** The lookup key of this entry.  */
+    std::string key;
+
+    /** The channel ID referenced by the parsed state.  */
+    uint256 channelId;
+
+    /** The metadata referenced by the parsed state.  */
+    proto::ChannelMetadata meta;
+
+    /** The parsed state, or null if the state was invalid.  */
+    std::unique_ptr<ParsedBoardState> parsed;
+
+    /** The size accounted for this entry.  */
+    size_t size;
+
+  };
+
+  /** The underlying board rules used to parse states.  */
+  const BoardRules& rules;
+
+  /** Maximum total size of the entries to keep.  */
+  const size_t maxTotalSize;
+
+  /** Lock for this instance.  */
+  mutable std::mutex mut;
+
+  /** The cached entries, with the most recently used one at the front.  */
+  std::list<std::shared_ptr<const Entry>> entries;
+
+  /** Index of the entries by key.  */
+  std::unordered_map<std::string,
+                     std::list<std::shared_ptr<const Entry>>::iterator> index;
+
+  /** Total size of all cached entries.  */
+  size_t totalSize = 0;
+
+  /** Number of lookups that were answered from the cache.  */
+  unsigned hits = 0;
+
+  /** Number of lookups that required parsing the state.  */
+  unsigned misses = 0;
+
+  /**
+   * Returns the parsed state of an entry for handing it out.  The returned
+   * pointer keeps the entry alive.
+   */
+  static std::shared_ptr<const ParsedBoardState> ToResult (
+      const std::shared_ptr<const Entry>& entry);
+
+  /**
+   * Looks up or parses the given state.  If buffer is not null, it holds
+   * the same data as s and is passed to BoardRules::ParseStateBuffer
+   * for parsing.
+   */
+  std::shared_ptr<const ParsedBoardState> GetInternal (
+      const uint256& channelId, const proto::ChannelMetadata& meta,
+      const BoardState& s, const SharedBoardState* buffer);
+
+public:
+
+  /** Default bound for the total size of cached entries.  */
+  static constexpr size_t DEFAULT_MAX_TOTAL_SIZE = 16 << 20;
+
+  explicit ParsedStateCache (const BoardRules& r,
+                             size_t maxSize = DEFAULT_MAX_TOTAL_SIZE);
+
+  ParsedStateCache () = delete;
+  ParsedStateCache (const ParsedStateCache&) = delete;
+  void operator= (const ParsedStateCache&) = delete;
+
+  /**
+   * Returns the associated BoardRules instance.
+   */
+  const BoardRules&
+  GetBoardRules () const
+  {
+    return rules;
+  }
+
+  /**
+   * Returns the parsed state for the given data, either from the cache
+   * or by parsing it with the BoardRules and adding it.  Returns null if the
+   * state is invalid.  The returned instance references the cache's own
+   * copies of channel ID and metadata, so there are no lifetime requirements
+   * for the arguments passed in.
+   */
+  std::shared_ptr<const ParsedBoardState> Get (
+      const uint256& channelId, const proto::ChannelMetadata& meta,
+      const BoardState& s);
+
+  /**
+   * Returns the parsed state for data held in a shared buffer.  If the state
+   * needs to be parsed, BoardRules::ParseStateBuffer is used for it.
+   */
+  std::shared_ptr<const ParsedBoardState> Get (
+      const uint256& channelId, const proto::ChannelMetadata& meta,
+      const SharedBoardState& s);
+
+  /**
+   * Returns the number of entries currently in the cache.
+   */
+  size_t GetSize () const;
+
+  /**
+   * Returns the total size accounted for all entries in the cache.
+   */
+  size_t GetTotalSize () const;
+
+  /**
+   * Returns the number of cache hits so far.
+   */
+  unsigned GetHits () const;
+
+  /**
+   * Returns the number of cache misses so far.
+   */
+  unsigned GetMisses () const;
+
+};
+
+} // namespace xaya
+
+#endif // GAMECHANNEL_PARSEDSTATECACHE_HPP
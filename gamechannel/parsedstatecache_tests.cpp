@@ -0,0 +1,230 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "parsedstatecache.hpp"
+
+#include "testgame.hpp"
+
+#include <xayautil/hash.hpp>
+
+#include <gtest/gtest.h>
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace xaya
+{
+namespace
+{
+
+class ParsedStateCacheTests : public TestGameFixture
+{
+
+protected:
+
+  const uint256 channelId = SHA256::Hash ("channel id");
+  proto::ChannelMetadata meta;
+
+  ParsedStateCache cache;
+
+  /* Each entry for our test states is accounted with about 80 bytes
+     (mostly for the key), so this has room for two of them.  */
+  ParsedStateCacheTests ()
+    : cache(game.rules, 170)
+  {
+    meta.set_reinit ("reinit");
+  }
+
+};
+
+TEST_F (ParsedStateCacheTests, ReturnsSameInstance)
+{
+  const auto first = cache.Get (channelId, meta, "10 5");
+  ASSERT_NE (first, nullptr);
+  EXPECT_EQ (first->TurnCount (), 5);
+
+  EXPECT_EQ (cache.Get (channelId, meta, "10 5"), first);
+  EXPECT_NE (cache.Get (channelId, meta, "11 5"), first);
+
+  EXPECT_EQ (cache.GetHits (), 1);
+  EXPECT_EQ (cache.GetMisses (), 2);
+}
+
+TEST_F (ParsedStateCacheTests, InvalidState)
+{
+  EXPECT_EQ (cache.Get (channelId, meta, "invalid"), nullptr);
+  EXPECT_EQ (cache.Get (channelId, meta, "invalid"), nullptr);
+  EXPECT_EQ (cache.GetHits (), 1);
+}
+
+TEST_F (ParsedStateCacheTests, KeyIncludesChannelAndReinit)
+{
+  const auto first = cache.Get (channelId, meta, "10 5");
+  EXPECT_NE (cache.Get (SHA256::Hash ("other"), meta, "10 5"), first);
+
+  proto::ChannelMetadata otherMeta;
+  otherMeta.set_reinit ("other reinit");
+  const auto other = cache.Get (channelId, otherMeta, "10 5");
+  ASSERT_NE (other, nullptr);
+  EXPECT_NE (other, first);
+  EXPECT_EQ (other->GetMetadata ().reinit (), "other reinit");
+}
+
+TEST_F (ParsedStateCacheTests, SharedBuffer)
+{
+  const auto first = cache.Get (channelId, meta, "10 5");
+  const SharedBoardState buffer(std::string ("10 5"));
+  EXPECT_EQ (cache.Get (channelId, meta, buffer), first);
+
+  const auto other
+      = cache.Get (channelId, meta, SharedBoardState (std::string ("11 5")));
+  ASSERT_NE (other, nullptr);
+  EXPECT_EQ (cache.Get (channelId, meta, "11 5"), other);
+
+  EXPECT_EQ (cache.GetHits (), 2);
+  EXPECT_EQ (cache.GetMisses (), 2);
+}
+
+TEST_F (ParsedStateCacheTests, EvictsLeastRecentlyUsed)
+{
+  const auto a = cache.Get (channelId, meta, "1 1");
+  const auto b = cache.Get (channelId, meta, "2 2");
+  EXPECT_EQ (cache.Get (channelId, meta, "1 1"), a);
+
+  cache.Get (channelId, meta, "3 3");
+  EXPECT_EQ (cache.GetSize (), 2);
+  EXPECT_LE (cache.GetTotalSize (), 170);
+
+  EXPECT_EQ (cache.Get (channelId, meta, "1 1"), a);
+  EXPECT_NE (cache.Get (channelId, meta, "2 2"), b);
+}
+
+TEST_F (ParsedStateCacheTests, OversizedEntryNotCached)
+{
+  proto::ChannelMetadata bigMeta;
+  bigMeta.set_reinit (std::string (200, 'x'));
+
+  const auto first = cache.Get (channelId, bigMeta, "10 5");
+  ASSERT_NE (first, nullptr);
+  EXPECT_EQ (first->TurnCount (), 5);
+  EXPECT_EQ (cache.GetSize (), 0);
+  EXPECT_EQ (cache.GetTotalSize (), 0);
+
+  EXPECT_NE (cache.Get (channelId, bigMeta, "10 5"), first);
+  EXPECT_EQ (cache.GetMisses (), 2);
+}
+
+TEST_F (ParsedStateCacheTests, EvictedStateStaysValid)
+{
+  std::shared_ptr<const ParsedBoardState> parsed;
+  {
+    proto::ChannelMetadata tempMeta;
+    tempMeta.set_reinit ("temp");
+    parsed = cache.Get (SHA256::Hash ("temp channel"), tempMeta, "10 5");
+  }
+
+  cache.Get (channelId, meta, "1 1");
+  cache.Get (channelId, meta, "2 2");
+
+  ASSERT_NE (parsed, nullptr);
+  EXPECT_EQ (parsed->GetMetadata ().reinit (), "temp");
+  EXPECT_EQ (parsed->GetChannelId (), SHA256::Hash ("temp channel"));
+  EXPECT_TRUE (parsed->Equals ("10 5"));
+}
+
+TEST_F (ParsedStateCacheTests, BoardRulesParseStateShared)
+{
+  const auto uncached = game.rules.ParseStateShared (channelId, meta, "10 5");
+  ASSERT_NE (uncached, nullptr);
+  EXPECT_EQ (cache.GetMisses (), 0);
+
+  game.rules.SetParsedStateCache (cache);
+  const auto cached = game.rules.ParseStateShared (channelId, meta, "10 5");
+  EXPECT_EQ (game.rules.ParseStateShared (channelId, meta, "10 5"), cached);
+  EXPECT_EQ (cache.GetMisses (), 1);
+  EXPECT_EQ (cache.GetHits (), 1);
+}
+
+/**
+ * Board rules that wrap another instance, but take a while for parsing
+ * states and record how many parse calls run concurrently.
+ */
+class SlowRules : public BoardRules
+{
+
+private:
+
+  const BoardRules& base;
+
+public:
+
+  mutable std::atomic<unsigned> calls{0};
+  mutable std::atomic<unsigned> running{0};
+  mutable std::atomic<unsigned> maxRunning{0};
+
+  explicit SlowRules (const BoardRules& b)
+    : base(b)
+  {}
+
+  std::unique_ptr<ParsedBoardState>
+  ParseState (const uint256& channelId, const proto::ChannelMetadata& meta,
+              const BoardState& s) const override
+  {
+    ++calls;
+    const unsigned cur = ++running;
+    unsigned prev = maxRunning;
+    while (prev < cur && !maxRunning.compare_exchange_weak (prev, cur))
+      continue;
+
+    std::this_thread::sleep_for (std::chrono::milliseconds (50));
+    auto res = base.ParseState (channelId, meta, s);
+
+    --running;
+    return res;
+  }
+
+  ChannelProtoVersion
+  GetProtoVersion (const proto::ChannelMetadata& meta) const override
+  {
+    return base.GetProtoVersion (meta);
+  }
+
+};
+
+TEST_F (ParsedStateCacheTests, ParsesInParallel)
+{
+  SlowRules rules(game.rules);
+  ParsedStateCache slowCache(rules);
+
+  constexpr unsigned numThreads = 4;
+  std::vector<std::shared_ptr<const ParsedBoardState>> same(numThreads);
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < numThreads; ++i)
+    threads.emplace_back ([&, i] ()
+      {
+        slowCache.Get (channelId, meta, std::to_string (i + 1) + " 1");
+        same[i] = slowCache.Get (channelId, meta, "10 5");
+      });
+  for (auto& t : threads)
+    t.join ();
+
+  /* Different states are parsed at the same time.  */
+  EXPECT_GT (rules.maxRunning, 1);
+
+  /* Even if the same state was parsed concurrently by multiple threads,
+     they all end up with the same cached instance.  */
+  const auto cached = slowCache.Get (channelId, meta, "10 5");
+  ASSERT_NE (cached, nullptr);
+  for (const auto& p : same)
+    EXPECT_EQ (p, cached);
+  EXPECT_EQ (slowCache.GetSize (), numThreads + 1);
+}
+
+} // anonymous namespace
+} // namespace xaya
@@ -105,6 +105,12 @@ public:
 /**
  * Utility class that implements the BoardRules interface and creates
  * ProtoBoardState-subclasses by deserialising the state as protocol buffer.
+ *
+ * New states are serialised deterministically by ProtoBoardState::ApplyMove.
+ * Games whose EqualsProto is the default comparison (or otherwise agrees
+ * with it on identical messages) can thus override HasCanonicalEncoding
+ * to return true, which avoids a full parse and comparison per transition
+ * when verifying state proofs.
  */
 template <typename StateClass>
   class ProtoBoardRules : public BoardRules
@@ -112,6 +118,11 @@ template <typename StateClass>
 
 public:
 
+  /**
+   * The type of parsed states, e.g. for use with TypedChannelManager.
+   */
+  using StateType = StateClass;
+
   ProtoBoardRules () = default;
 
   ProtoBoardRules (const ProtoBoardRules<StateClass>&) = delete;
@@ -6,6 +6,8 @@
 
 #include "protoversion.hpp"
 
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 #include <google/protobuf/util/message_differencer.h>
 
 #include <glog/logging.h>
@@ -43,15 +45,9 @@ template <typename State, typename Move>
   ProtoBoardState<State, Move>::Equals (const BoardState& other) const
 {
   State po;
-  if (!po.ParseFromString (other))
+  if (!ParseProtoWithoutUnknownFields (other, po))
     {
-      LOG (WARNING) << "Other BoardState failed to parse, returning not equal";
-      return false;
-    }
-  if (HasAnyUnknownFields (po))
-    {
-      LOG (WARNING)
-          << "Other BoardState has unknown fields:\n" << po.DebugString ();
+      LOG (WARNING) << "Other BoardState is invalid, returning not equal";
       return false;
     }
 
@@ -64,22 +60,26 @@ template <typename State, typename Move>
                                            BoardState& newState) const
 {
   Move pm;
-  if (!pm.ParseFromString (mv))
+  if (!ParseProtoWithoutUnknownFields (mv, pm))
     {
       LOG (WARNING) << "Failed to parse BoardMove into protocol buffer";
       return false;
     }
-  if (HasAnyUnknownFields (pm))
-    {
-      LOG (WARNING) << "Parsed move has unknown fields:\n" << pm.DebugString ();
-      return false;
-    }
 
   State pn;
   if (!ApplyMoveProto (pm, pn))
     return false;
 
-  CHECK (pn.SerializeToString (&newState));
+  /* Use deterministic serialisation (relevant e.g. for map fields), so that
+     games can declare a canonical encoding with HasCanonicalEncoding.  */
+  newState.clear ();
+  {
+    google::protobuf::io::StringOutputStream out(&newState);
+    google::protobuf::io::CodedOutputStream coded(&out);
+    coded.SetSerializationDeterministic (true);
+    CHECK (pn.SerializeToCodedStream (&coded));
+  }
+
   return true;
 }
 
@@ -90,18 +90,11 @@ template <typename StateClass>
       const BoardState& s) const
 {
   typename StateClass::StateProto p;
-  if (!p.ParseFromString (s))
+  if (!ParseProtoWithoutUnknownFields (s, p))
     {
       LOG (WARNING) << "Failed to parse BoardState into protocol buffer";
       return nullptr;
     }
-  if (HasAnyUnknownFields (p))
-    {
-      LOG (WARNING)
-          << "Parsed BoardState proto has unknown fields:\n"
-          << p.DebugString ();
-      return nullptr;
-    }
 
   auto res = std::make_unique<StateClass> (*this, channelId, meta,
                                            std::move (p));
@@ -5,6 +5,7 @@
 #ifndef GAMECHANNEL_PROTOUTILS_HPP
 #define GAMECHANNEL_PROTOUTILS_HPP
 
+#include <cstddef>
 #include <string>
 
 namespace xaya
@@ -23,6 +24,25 @@ template <typename Proto>
 template <typename Proto>
   bool ProtoFromBase64 (const std::string& str, Proto& msg);
 
+/**
+ * Encodes a protocol buffer as base64 string of its compressed (with
+ * CompressData) serialised form.  This is useful for large messages like
+ * state proofs in dispute and resolution moves, where the smaller size
+ * directly translates to cheaper transactions.
+ */
+template <typename Proto>
+  std::string ProtoToCompressedBase64 (const Proto& msg);
+
+/**
+ * Decodes a protocol buffer from the format produced by
+ * ProtoToCompressedBase64.  The uncompressed data is bounded by maxSize,
+ * so that malicious moves cannot be used to exhaust memory.  Note that
+ * this value is consensus-relevant when used on the GSP side.
+ */
+template <typename Proto>
+  bool ProtoFromCompressedBase64 (const std::string& str, size_t maxSize,
+                                  Proto& msg);
+
 } // namespace xaya
 
 #include "protoutils.tpp"
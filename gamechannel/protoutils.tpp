@@ -5,6 +5,7 @@
 /* Template implementation code for protoutils.hpp.  */
 
 #include <xayautil/base64.hpp>
+#include <xayautil/compression.hpp>
 
 #include <glog/logging.h>
 
@@ -40,4 +41,41 @@ template <typename Proto>
   return true;
 }
 
+template <typename Proto>
+  std::string
+  ProtoToCompressedBase64 (const Proto& msg)
+{
+  std::string serialised;
+  CHECK (msg.SerializeToString (&serialised));
+  return EncodeBase64 (CompressData (serialised));
+}
+
+template <typename Proto>
+  bool
+  ProtoFromCompressedBase64 (const std::string& str, const size_t maxSize,
+                             Proto& msg)
+{
+  std::string compressed;
+  if (!DecodeBase64 (str, compressed))
+    {
+      LOG (ERROR) << "Invalid base64: " << str;
+      return false;
+    }
+
+  std::string bytes;
+  if (!UncompressData (compressed, maxSize, bytes))
+    {
+      LOG (ERROR) << "Failed to uncompress protocol buffer data";
+      return false;
+    }
+
+  if (!msg.ParseFromString (bytes))
+    {
+      LOG (ERROR) << "Failed to parse protocol buffer from decoded string";
+      return false;
+    }
+
+  return true;
+}
+
 } // namespace xaya
@@ -40,6 +40,13 @@ protected:
     ASSERT_TRUE (ProtoFromBase64 (encoded, output));
 
     ASSERT_TRUE (MessageDifferencer::Equals (input, output));
+
+    const std::string compressed = ProtoToCompressedBase64 (input);
+
+    Proto uncompressed;
+    ASSERT_TRUE (ProtoFromCompressedBase64 (compressed, 1'024, uncompressed));
+
+    ASSERT_TRUE (MessageDifferencer::Equals (input, uncompressed));
   }
 
 };
@@ -86,5 +93,41 @@ TEST_F (ProtoUtilsTests, StateProofRoundtrip)
   CheckRoundtrip (proof);
 }
 
+TEST_F (ProtoUtilsTests, CompressedIsSmaller)
+{
+  proto::StateProof proof;
+  for (unsigned i = 0; i < 10; ++i)
+    {
+      auto* t = proof.add_transitions ();
+      t->set_move ("some move data that is similar in all transitions");
+      t->mutable_new_state ()->set_data ("the new state of the game channel");
+    }
+
+  EXPECT_LT (ProtoToCompressedBase64 (proof).size (),
+             ProtoToBase64 (proof).size ());
+}
+
+TEST_F (ProtoUtilsTests, CompressedSizeLimit)
+{
+  proto::StateProof proof;
+  proof.mutable_initial_state ()->set_data (std::string (1'000, 'x'));
+
+  const std::string encoded = ProtoToCompressedBase64 (proof);
+
+  proto::StateProof decoded;
+  EXPECT_TRUE (ProtoFromCompressedBase64 (encoded, 1'100, decoded));
+  EXPECT_FALSE (ProtoFromCompressedBase64 (encoded, 900, decoded));
+}
+
+TEST_F (ProtoUtilsTests, CompressedInvalidData)
+{
+  proto::StateProof proof;
+  proof.mutable_initial_state ()->set_data ("state");
+
+  EXPECT_FALSE (ProtoFromCompressedBase64 ("invalid base64", 1'000, proof));
+  EXPECT_FALSE (ProtoFromCompressedBase64 (ProtoToBase64 (proof),
+                                           1'000, proof));
+}
+
 } // anonymous namespace
 } // namespace xaya
@@ -9,11 +9,14 @@
 
 #include <glog/logging.h>
 
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace xaya
 {
 
+using google::protobuf::Descriptor;
 using google::protobuf::FieldDescriptor;
 using google::protobuf::Message;
 
@@ -47,46 +50,220 @@ template <>
   return true;
 }
 
+namespace
+{
+
+/**
+ * Precomputed information about a message type, which lists the fields
+ * that may contain submessages (and thus nested unknown fields).  Only those
+ * need to be walked by HasAnyUnknownFields; all other fields can be skipped
+ * without even looking at them.  Extensions are not part of the descriptor's
+ * fields, so for extendable types, the set extensions are listed explicitly
+ * in addition.
+ */
+struct UnknownFieldsPlan
+{
+
+  /**
+   * A field holding submessages and the plan for their type.  Group fields
+   * are recorded as well (with a null plan), since they are not allowed
+   * if actually present in a message.
+   */
+  struct SubField
+  {
+    const FieldDescriptor* field;
+    const UnknownFieldsPlan* plan;
+  };
+
+  std::vector<SubField> subFields;
+
+  /** Whether the message type has extension ranges.  */
+  bool hasExtensions = false;
+
+};
+
+/**
+ * Cache of computed plans, keyed by their message descriptor.  Plans are
+ * never removed, and pointers to them stay valid when the map grows.
+ */
+std::unordered_map<const Descriptor*, UnknownFieldsPlan> plans;
+
+/** Lock for the plans map.  */
+std::mutex mutPlans;
+
+/**
+ * Builds (or looks up) the plan for the given descriptor, including all
+ * plans for nested message types.  Must be called with mutPlans locked.
+ */
+const UnknownFieldsPlan&
+BuildPlan (const Descriptor* d)
+{
+  auto mit = plans.find (d);
+  if (mit != plans.end ())
+    return mit->second;
+
+  /* Insert the plan before filling it in, so that recursive message types
+     refer back to it instead of recursing forever.  */
+  auto& res = plans[d];
+  res.hasExtensions = (d->extension_range_count () > 0);
+  for (int i = 0; i < d->field_count (); ++i)
+    {
+      const auto* f = d->field (i);
+      switch (f->type ())
+        {
+        case FieldDescriptor::TYPE_GROUP:
+          res.subFields.push_back ({f, nullptr});
+          break;
+
+        case FieldDescriptor::TYPE_MESSAGE:
+          res.subFields.push_back ({f, &BuildPlan (f->message_type ())});
+          break;
+
+        default:
+          /* Non-message fields cannot contain any nested unknown fields.  */
+          break;
+        }
+    }
+
+  return res;
+}
+
+/**
+ * Returns the plan for the given descriptor, building it if necessary.
+ * Plans that were already looked up by the current thread are found in
+ * a thread-local cache, so that the lock is only needed the first time.
+ */
+const UnknownFieldsPlan&
+GetPlan (const Descriptor* d)
+{
+  thread_local std::unordered_map<const Descriptor*,
+                                  const UnknownFieldsPlan*> cache;
+
+  const auto mit = cache.find (d);
+  if (mit != cache.end ())
+    return *mit->second;
+
+  std::lock_guard<std::mutex> lock(mutPlans);
+  const auto& res = BuildPlan (d);
+  cache.emplace (d, &res);
+
+  return res;
+}
+
+bool HasUnknownFieldsWithPlan (const Message& msg,
+                               const UnknownFieldsPlan& plan);
+
+/**
+ * Checks the submessages in the given field of a message for unknown fields.
+ * The plan is the one for the field's message type, or null for a group.
+ */
 bool
-HasAnyUnknownFields (const Message& msg)
+FieldHasUnknownFields (const Message& msg, const FieldDescriptor& field,
+                       const UnknownFieldsPlan* plan)
+{
+  const auto& reflection = *msg.GetReflection ();
+
+  if (field.is_repeated ())
+    {
+      const int n = reflection.FieldSize (msg, &field);
+      if (n > 0 && plan == nullptr)
+        LOG (FATAL)
+            << "group is not allowed in game-channel protocol buffers";
+      for (int i = 0; i < n; ++i)
+        {
+          const auto& nested = reflection.GetRepeatedMessage (msg, &field, i);
+          if (HasUnknownFieldsWithPlan (nested, *plan))
+            return true;
+        }
+    }
+  else if (reflection.HasField (msg, &field))
+    {
+      if (plan == nullptr)
+        LOG (FATAL)
+            << "group is not allowed in game-channel protocol buffers";
+      const auto& nested = reflection.GetMessage (msg, &field);
+      if (HasUnknownFieldsWithPlan (nested, *plan))
+        return true;
+    }
+
+  return false;
+}
+
+/**
+ * Checks for unknown fields in a message, based on a precomputed plan
+ * for its type.
+ */
+bool
+HasUnknownFieldsWithPlan (const Message& msg, const UnknownFieldsPlan& plan)
 {
   const auto& reflection = *msg.GetReflection ();
   if (!reflection.GetUnknownFields (msg).empty ())
     return true;
 
+  for (const auto& sub : plan.subFields)
+    if (FieldHasUnknownFields (msg, *sub.field, sub.plan))
+      return true;
+
+  if (!plan.hasExtensions)
+    return false;
+
   std::vector<const FieldDescriptor*> fields;
   reflection.ListFields (msg, &fields);
 
   for (const auto* f : fields)
-    switch (f->type ())
-      {
-      case FieldDescriptor::TYPE_GROUP:
-        LOG (FATAL) << "group is not allowed in game-channel protocol buffers";
-
-      case FieldDescriptor::TYPE_MESSAGE:
-        if (f->is_repeated ())
-          for (int i = 0; i < reflection.FieldSize (msg, f); ++i)
-            {
-              const auto& nested = reflection.GetRepeatedMessage (msg, f, i);
-              if (HasAnyUnknownFields (nested))
-                return true;
-            }
-        else
-          {
-            const auto& nested = reflection.GetMessage (msg, f);
-            if (HasAnyUnknownFields (nested))
-              return true;
-          }
-
-      default:
-        /* Just ignore any other types, as non-message fields cannot contain
-           any nested unknown fields.  */
-        break;
-      }
+    {
+      if (!f->is_extension ())
+        continue;
+
+      switch (f->type ())
+        {
+        case FieldDescriptor::TYPE_GROUP:
+          LOG (FATAL)
+              << "group is not allowed in game-channel protocol buffers";
+
+        case FieldDescriptor::TYPE_MESSAGE:
+          if (FieldHasUnknownFields (msg, *f, &GetPlan (f->message_type ())))
+            return true;
+          break;
+
+        default:
+          /* Non-message extensions cannot contain nested unknown fields.  */
+          break;
+        }
+    }
 
   return false;
 }
 
+} // anonymous namespace
+
+bool
+HasAnyUnknownFields (const Message& msg)
+{
+  return HasUnknownFieldsWithPlan (msg, GetPlan (msg.GetDescriptor ()));
+}
+
+bool
+ParseProtoWithoutUnknownFields (const std::string& data, Message& msg)
+{
+  if (!msg.ParseFromString (data))
+    {
+      LOG (WARNING)
+          << "Failed to parse data into " << msg.GetTypeName () << " proto";
+      return false;
+    }
+
+  if (HasAnyUnknownFields (msg))
+    {
+      LOG (WARNING)
+          << "Parsed " << msg.GetTypeName () << " proto has unknown fields:\n"
+          << msg.DebugString ();
+      return false;
+    }
+
+  return true;
+}
+
 namespace
 {
 
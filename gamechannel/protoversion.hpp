@@ -10,6 +10,8 @@
 
 #include <google/protobuf/message.h>
 
+#include <string>
+
 namespace xaya
 {
 
@@ -59,10 +61,21 @@ template <typename Proto>
 
 /**
  * Checks whether this message or any contained submessages have any unknown
- * fields set.
+ * fields set.  For each message type, the fields that may hold submessages
+ * are determined once from the descriptor and cached, so that repeated
+ * checks only look at those fields.
  */
 bool HasAnyUnknownFields (const google::protobuf::Message& msg);
 
+/**
+ * Parses a protocol buffer from the given binary data, and fails if either
+ * the data is invalid or the resulting message (including all submessages)
+ * has any unknown fields.  This is what should be used to parse game-specific
+ * board states and moves.
+ */
+bool ParseProtoWithoutUnknownFields (const std::string& data,
+                                     google::protobuf::Message& msg);
+
 /**
  * Checks if a given proto (StateProof or SignedData) is valid with respect
  * to the version expected.  It also must not have any unknown fields.
@@ -0,0 +1,124 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "protoversion.hpp"
+
+#include "proto/testprotos.pb.h"
+
+#include <benchmark/benchmark.h>
+
+#include <glog/logging.h>
+
+#include <string>
+#include <vector>
+
+namespace xaya
+{
+namespace
+{
+
+using google::protobuf::FieldDescriptor;
+using google::protobuf::Message;
+
+/**
+ * The original implementation of HasAnyUnknownFields, which walks all
+ * set fields through reflection.  It is kept here as baseline.
+ */
+bool
+ReflectionHasAnyUnknownFields (const Message& msg)
+{
+  const auto& reflection = *msg.GetReflection ();
+  if (!reflection.GetUnknownFields (msg).empty ())
+    return true;
+
+  std::vector<const FieldDescriptor*> fields;
+  reflection.ListFields (msg, &fields);
+
+  for (const auto* f : fields)
+    {
+      if (f->type () != FieldDescriptor::TYPE_MESSAGE)
+        continue;
+
+      if (f->is_repeated ())
+        {
+          for (int i = 0; i < reflection.FieldSize (msg, f); ++i)
+            if (ReflectionHasAnyUnknownFields (
+                    reflection.GetRepeatedMessage (msg, f, i)))
+              return true;
+        }
+      else if (ReflectionHasAnyUnknownFields (reflection.GetMessage (msg, f)))
+        return true;
+    }
+
+  return false;
+}
+
+/**
+ * Constructs a test message with the given number of repeated submessages
+ * on each of two levels, and with some scalar fields set throughout.
+ */
+proto::UnknownFieldTest
+BuildMessage (const unsigned n)
+{
+  proto::UnknownFieldTest res;
+  res.set_single_int (42);
+  res.set_single_str ("foo");
+  for (unsigned i = 0; i < n; ++i)
+    {
+      auto* sub = res.add_repeated_msg ();
+      sub->add_repeated_int (i);
+      sub->add_repeated_str ("bar");
+      for (unsigned j = 0; j < n; ++j)
+        sub->add_repeated_msg ()->mutable_single_msg ()->set_single_int (j);
+    }
+
+  return res;
+}
+
+void
+ReflectionWalk (benchmark::State& state)
+{
+  const auto msg = BuildMessage (state.range (0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize (ReflectionHasAnyUnknownFields (msg));
+}
+BENCHMARK (ReflectionWalk)->Arg (1)->Arg (8)->Arg (32);
+
+void
+PlanWalk (benchmark::State& state)
+{
+  const auto msg = BuildMessage (state.range (0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize (HasAnyUnknownFields (msg));
+}
+BENCHMARK (PlanWalk)->Arg (1)->Arg (8)->Arg (32);
+
+void
+ParseOnly (benchmark::State& state)
+{
+  std::string data;
+  CHECK (BuildMessage (state.range (0)).SerializeToString (&data));
+  for (auto _ : state)
+    {
+      proto::UnknownFieldTest msg;
+      benchmark::DoNotOptimize (msg.ParseFromString (data));
+    }
+}
+BENCHMARK (ParseOnly)->Arg (1)->Arg (8)->Arg (32);
+
+void
+ParseWithoutUnknownFields (benchmark::State& state)
+{
+  std::string data;
+  CHECK (BuildMessage (state.range (0)).SerializeToString (&data));
+  for (auto _ : state)
+    {
+      proto::UnknownFieldTest msg;
+      benchmark::DoNotOptimize (ParseProtoWithoutUnknownFields (data, msg));
+    }
+}
+BENCHMARK (ParseWithoutUnknownFields)->Arg (1)->Arg (8)->Arg (32);
+
+} // anonymous namespace
+} // namespace xaya
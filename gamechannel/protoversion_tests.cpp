@@ -197,6 +197,70 @@ TEST_F (HasAnyUnknownFieldsTests, InNestedMessage)
   )"));
 }
 
+TEST_F (HasAnyUnknownFieldsTests, InExtension)
+{
+  EXPECT_FALSE (HasUnknownFields (R"(
+    ext_msg:
+      {
+        single_int: 42
+        ext_repeated_msg: {}
+      }
+    ext_repeated_msg: {}
+    ext_repeated_msg:
+      {
+        repeated_msg: {}
+      }
+  )"));
+
+  EXPECT_TRUE (HasUnknownFields (R"(
+    ext_msg:
+      {
+        unknown_int: 5
+      }
+  )"));
+  EXPECT_TRUE (HasUnknownFields (R"(
+    ext_repeated_msg: {}
+    ext_repeated_msg:
+      {
+        single_msg:
+          {
+            unknown_msg: {}
+          }
+      }
+  )"));
+  EXPECT_TRUE (HasUnknownFields (R"(
+    repeated_msg:
+      {
+        ext_msg:
+          {
+            ext_msg:
+              {
+                unknown_repeated_int: 0
+              }
+          }
+      }
+  )"));
+}
+
+TEST_F (HasAnyUnknownFieldsTests, ParseWithoutUnknownFields)
+{
+  proto::ExtendedUnknownFieldTest extended;
+  extended.mutable_single_msg ()->add_repeated_int (42);
+
+  std::string serialised;
+  CHECK (extended.SerializeToString (&serialised));
+
+  proto::UnknownFieldTest basic;
+  EXPECT_TRUE (ParseProtoWithoutUnknownFields (serialised, basic));
+  EXPECT_EQ (basic.single_msg ().repeated_int (0), 42);
+
+  EXPECT_FALSE (ParseProtoWithoutUnknownFields ("invalid", basic));
+
+  extended.mutable_single_msg ()->set_unknown_int (5);
+  CHECK (extended.SerializeToString (&serialised));
+  EXPECT_FALSE (ParseProtoWithoutUnknownFields (serialised, basic));
+}
+
 /* ************************************************************************** */
 
 class CheckVersionedProtoTests : public TestGameFixture
@@ -0,0 +1,803 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "relayserver.hpp"
+
+#include <glog/logging.h>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace xaya
+{
+
+namespace
+{
+
+/** Epoll data value for the listening socket.  */
+constexpr uint64_t LISTEN_ID = 0;
+/** Epoll data value for the wakeup eventfd.  */
+constexpr uint64_t WAKE_ID = 1;
+
+/** Maximum number of events processed per epoll_wait call.  */
+constexpr int MAX_EVENTS = 256;
+
+/** Maximum size of the HTTP request headers.  */
+constexpr size_t MAX_HEADER_SIZE = 16 * 1024;
+
+/* JSON-RPC error codes.  */
+constexpr int ERROR_PARSE = -32700;
+constexpr int ERROR_INVALID_REQUEST = -32600;
+constexpr int ERROR_METHOD_NOT_FOUND = -32601;
+constexpr int ERROR_INVALID_PARAMS = -32602;
+
+/**
+ * Returns the reason phrase for an HTTP status code we use.
+ */
+const char*
+StatusText (const int status)
+{
+  switch (status)
+    {
+    case 200:
+      return "OK";
+    case 400:
+      return "Bad Request";
+    case 405:
+      return "Method Not Allowed";
+    case 413:
+      return "Payload Too Large";
+    case 431:
+      return "Request Header Fields Too Large";
+    case 501:
+      return "Not Implemented";
+    default:
+      return "Error";
+    }
+}
+
+/**
+ * Converts a string to lower case.
+ */
+std::string
+ToLower (std::string str)
+{
+  std::transform (str.begin (), str.end (), str.begin (),
+                  [] (const unsigned char c) { return std::tolower (c); });
+  return str;
+}
+
+/**
+ * Removes leading and trailing whitespace.
+ */
+std::string
+Trim (const std::string& str)
+{
+  const auto start = str.find_first_not_of (" \t");
+  if (start == std::string::npos)
+    return "";
+  const auto end = str.find_last_not_of (" \t\r");
+  return str.substr (start, end - start + 1);
+}
+
+/**
+ * Builds a JSON-RPC error response.
+ */
+Json::Value
+ErrorResponse (const Json::Value& id, const int code, const std::string& msg)
+{
+  Json::Value err(Json::objectValue);
+  err["code"] = code;
+  err["message"] = msg;
+
+  Json::Value res(Json::objectValue);
+  res["jsonrpc"] = "2.0";
+  res["id"] = id;
+  res["error"] = err;
+
+  return res;
+}
+
+/**
+ * Builds a JSON-RPC success response.
+ */
+Json::Value
+SuccessResponse (const Json::Value& id, const Json::Value& result)
+{
+  Json::Value res(Json::objectValue);
+  res["jsonrpc"] = "2.0";
+  res["id"] = id;
+  res["result"] = result;
+
+  return res;
+}
+
+/**
+ * Extracts a string parameter from the params object.
+ */
+bool
+GetStringParam (const Json::Value& params, const std::string& name,
+                std::string& out)
+{
+  const auto& val = params[name];
+  if (!val.isString ())
+    return false;
+
+  out = val.asString ();
+  return true;
+}
+
+} // anonymous namespace
+
+/**
+ * Data for a client connection.
+ */
+struct RelayServer::Connection
+{
+
+  /** The connection's ID (used as epoll data).  */
+  uint64_t id;
+
+  /** The socket.  */
+  int fd;
+
+  /** Received data that has not been processed yet.  */
+  std::string in;
+
+  /** Data still to be written.  */
+  std::string out;
+
+  /** The events currently requested from epoll for the socket.  */
+  uint32_t pollEvents = EPOLLIN;
+
+  /** Whether the connection should be kept open after the response.  */
+  bool keepAlive = true;
+
+  /** Set when the connection should be closed once out is written.  */
+  bool closeAfterWrite = false;
+
+  /** Whether we sent "100 Continue" for the current request.  */
+  bool sentContinue = false;
+
+  /** Whether the connection is parked waiting for messages.  */
+  bool waiting = false;
+
+  /** The channel of the receive call we wait for.  */
+  std::string waitChannel;
+
+  /** The sequence number of the receive call we wait for.  */
+  uint64_t waitSeq;
+
+  /** The JSON-RPC id of the receive call we wait for.  */
+  Json::Value waitId;
+
+  /** Deadline at which the waiting receive times out.  */
+  Clock::time_point deadline;
+
+};
+
+RelayServer::RelayServer (const Options& o)
+  : options(o), relay(options.relay), nextId(WAKE_ID + 1), shouldStop(false)
+{
+  jsonWriterBuilder["commentStyle"] = "None";
+  jsonWriterBuilder["indentation"] = "";
+  jsonWriterBuilder["enableYAMLCompatibility"] = false;
+
+  Json::CharReaderBuilder rbuilder;
+  jsonReader.reset (rbuilder.newCharReader ());
+}
+
+RelayServer::~RelayServer ()
+{
+  Stop ();
+}
+
+void
+RelayServer::Start ()
+{
+  CHECK (!loop.joinable ()) << "RelayServer is already running";
+
+  addrinfo hints;
+  std::memset (&hints, 0, sizeof (hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+
+  addrinfo* addrs;
+  const int rc = getaddrinfo (options.host.c_str (),
+                              std::to_string (options.port).c_str (),
+                              &hints, &addrs);
+  CHECK_EQ (rc, 0)
+      << "Failed to resolve " << options.host << ": " << gai_strerror (rc);
+
+  for (const addrinfo* a = addrs; a != nullptr; a = a->ai_next)
+    {
+      const int fd = socket (a->ai_family,
+                             a->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                             a->ai_protocol);
+      if (fd < 0)
+        continue;
+
+      const int one = 1;
+      setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof (one));
+      if (bind (fd, a->ai_addr, a->ai_addrlen) == 0
+            && listen (fd, SOMAXCONN) == 0)
+        {
+          listenFd = fd;
+          break;
+        }
+
+      PLOG (WARNING) << "Failed to bind relay server socket";
+      close (fd);
+    }
+  freeaddrinfo (addrs);
+  CHECK_GE (listenFd, 0)
+      << "Could not listen on " << options.host << ":" << options.port;
+
+  sockaddr_storage addr;
+  socklen_t addrLen = sizeof (addr);
+  PCHECK (getsockname (listenFd, reinterpret_cast<sockaddr*> (&addr),
+                       &addrLen) == 0);
+  if (addr.ss_family == AF_INET6)
+    port = ntohs (reinterpret_cast<const sockaddr_in6*> (&addr)->sin6_port);
+  else
+    port = ntohs (reinterpret_cast<const sockaddr_in*> (&addr)->sin_port);
+
+  epollFd = epoll_create1 (EPOLL_CLOEXEC);
+  PCHECK (epollFd >= 0) << "epoll_create1 failed";
+  wakeFd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+  PCHECK (wakeFd >= 0) << "eventfd failed";
+
+  epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.u64 = LISTEN_ID;
+  PCHECK (epoll_ctl (epollFd, EPOLL_CTL_ADD, listenFd, &ev) == 0);
+  ev.data.u64 = WAKE_ID;
+  PCHECK (epoll_ctl (epollFd, EPOLL_CTL_ADD, wakeFd, &ev) == 0);
+
+  LOG (INFO)
+      << "Relay server listening on " << options.host << ":" << port;
+
+  shouldStop = false;
+  loop = std::thread ([this] () { RunLoop (); });
+}
+
+void
+RelayServer::Stop ()
+{
+  if (!loop.joinable ())
+    return;
+
+  shouldStop = true;
+  const uint64_t one = 1;
+  PCHECK (write (wakeFd, &one, sizeof (one)) == sizeof (one));
+  loop.join ();
+
+  std::vector<uint64_t> ids;
+  for (const auto& entry : connections)
+    ids.push_back (entry.first);
+  for (const auto id : ids)
+    CloseConnection (id);
+
+  close (wakeFd);
+  close (epollFd);
+  close (listenFd);
+  wakeFd = epollFd = listenFd = -1;
+
+  LOG (INFO) << "Relay server stopped";
+}
+
+void
+RelayServer::RunLoop ()
+{
+  epoll_event events[MAX_EVENTS];
+  while (!shouldStop)
+    {
+      int timeout = -1;
+      if (!deadlines.empty ())
+        {
+          const auto wait = deadlines.begin ()->first - Clock::now ();
+          using std::chrono::milliseconds;
+          const auto ms = std::chrono::duration_cast<milliseconds> (wait);
+          timeout = std::max<int> (0, ms.count () + 1);
+        }
+
+      const int n = epoll_wait (epollFd, events, MAX_EVENTS, timeout);
+      if (n < 0)
+        {
+          PCHECK (errno == EINTR) << "epoll_wait failed";
+          continue;
+        }
+
+      for (int i = 0; i < n; ++i)
+        {
+          const uint64_t id = events[i].data.u64;
+          if (id == WAKE_ID)
+            {
+              uint64_t val;
+              while (read (wakeFd, &val, sizeof (val)) > 0)
+                continue;
+              continue;
+            }
+          if (id == LISTEN_ID)
+            {
+              AcceptConnections ();
+              continue;
+            }
+
+          const auto mit = connections.find (id);
+          if (mit == connections.end ())
+            continue;
+          Connection& c = *mit->second;
+
+          /* If we do not read from the connection currently, errors and
+             hangups would be reported again and again.  There is no way
+             to answer the client anymore in that case anyway.  */
+          if ((events[i].events & (EPOLLERR | EPOLLHUP))
+                && !(c.pollEvents & EPOLLIN))
+            {
+              CloseConnection (id);
+              continue;
+            }
+
+          if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+            {
+              if (!ReadInput (c))
+                {
+                  CloseConnection (id);
+                  continue;
+                }
+              ProcessInput (c);
+            }
+
+          FinishConnection (id);
+        }
+
+      /* Answering waiters may process further pipelined requests, which
+         can send more messages.  Thus we deliver until nothing is left.  */
+      ExpireWaiters ();
+      while (DeliverMessages ())
+        continue;
+    }
+}
+
+void
+RelayServer::AcceptConnections ()
+{
+  while (true)
+    {
+      const int fd = accept4 (listenFd, nullptr, nullptr,
+                              SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (fd < 0)
+        {
+          if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            PLOG (WARNING) << "accept failed";
+          return;
+        }
+
+      const int one = 1;
+      setsockopt (fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof (one));
+
+      auto c = std::make_unique<Connection> ();
+      c->id = nextId++;
+      c->fd = fd;
+
+      epoll_event ev;
+      ev.events = EPOLLIN;
+      ev.data.u64 = c->id;
+      PCHECK (epoll_ctl (epollFd, EPOLL_CTL_ADD, fd, &ev) == 0);
+
+      VLOG (2) << "Accepted connection " << c->id;
+      connections.emplace (c->id, std::move (c));
+    }
+}
+
+size_t
+RelayServer::GetMaxBuffered () const
+{
+  return MAX_HEADER_SIZE + 4 + options.maxRequestSize;
+}
+
+bool
+RelayServer::ReadInput (Connection& c)
+{
+  /* We stop reading once a full request may be buffered.  Anything more
+     is only pipelined data that cannot be processed yet; it is left in the
+     socket until the connection is no longer waiting (see
+     FinishConnection).  */
+  char buf[16 * 1024];
+  while (c.in.size () <= GetMaxBuffered ())
+    {
+      const ssize_t n = read (c.fd, buf, sizeof (buf));
+      if (n > 0)
+        {
+          c.in.append (buf, n);
+          continue;
+        }
+      if (n == 0)
+        return false;
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return true;
+      if (errno != EINTR)
+        {
+          VLOG (1) << "Reading from connection " << c.id << " failed";
+          return false;
+        }
+    }
+
+  return true;
+}
+
+void
+RelayServer::ProcessInput (Connection& c)
+{
+  while (!c.waiting && !c.closeAfterWrite)
+    {
+      const size_t headerEnd = c.in.find ("\r\n\r\n");
+      if (headerEnd == std::string::npos || headerEnd > MAX_HEADER_SIZE)
+        {
+          if (c.in.size () > MAX_HEADER_SIZE)
+            {
+              c.keepAlive = false;
+              QueueResponse (c, 431, "");
+            }
+          return;
+        }
+
+      std::istringstream headers(c.in.substr (0, headerEnd));
+      std::string line;
+      std::getline (headers, line);
+
+      std::istringstream requestLine(line);
+      std::string method, target, version;
+      requestLine >> method >> target >> version;
+      version = Trim (version);
+
+      c.keepAlive = (version == "HTTP/1.1");
+      bool expectContinue = false;
+      bool chunked = false;
+      size_t contentLength = 0;
+      bool badLength = false;
+      while (std::getline (headers, line))
+        {
+          const auto colon = line.find (':');
+          if (colon == std::string::npos)
+            continue;
+
+          const std::string name = ToLower (Trim (line.substr (0, colon)));
+          const std::string value = Trim (line.substr (colon + 1));
+          if (name == "content-length")
+            {
+              try
+                {
+                  contentLength = std::stoull (value);
+                }
+              catch (const std::exception&)
+                {
+                  badLength = true;
+                }
+            }
+          else if (name == "connection")
+            {
+              const std::string v = ToLower (value);
+              if (v == "close")
+                c.keepAlive = false;
+              else if (v == "keep-alive")
+                c.keepAlive = true;
+            }
+          else if (name == "expect")
+            expectContinue = (ToLower (value) == "100-continue");
+          else if (name == "transfer-encoding")
+            chunked = true;
+        }
+
+      if (badLength || chunked || contentLength > options.maxRequestSize)
+        {
+          c.keepAlive = false;
+          QueueResponse (c, chunked ? 501 : (badLength ? 400 : 413), "");
+          return;
+        }
+
+      const size_t bodyStart = headerEnd + 4;
+      if (c.in.size () < bodyStart + contentLength)
+        {
+          if (expectContinue && !c.sentContinue)
+            {
+              c.out += "HTTP/1.1 100 Continue\r\n\r\n";
+              c.sentContinue = true;
+            }
+          return;
+        }
+
+      const std::string body = c.in.substr (bodyStart, contentLength);
+      c.in.erase (0, bodyStart + contentLength);
+      c.sentContinue = false;
+
+      if (method != "POST")
+        {
+          QueueResponse (c, 405, "");
+          continue;
+        }
+
+      HandleRequest (c, body);
+    }
+}
+
+void
+RelayServer::HandleRequest (Connection& c, const std::string& body)
+{
+  Json::Value req;
+  std::string parseErrs;
+  if (!jsonReader->parse (body.data (), body.data () + body.size (),
+                          &req, &parseErrs))
+    {
+      const auto resp = ErrorResponse (Json::Value (), ERROR_PARSE,
+                                       "invalid JSON: " + parseErrs);
+      QueueResponse (c, 200, Json::writeString (jsonWriterBuilder, resp));
+      return;
+    }
+
+  Json::Value response;
+  if (req.isArray ())
+    {
+      if (req.empty ())
+        response = ErrorResponse (Json::Value (), ERROR_INVALID_REQUEST,
+                                  "empty batch");
+      else
+        {
+          response = Json::Value (Json::arrayValue);
+          for (const auto& call : req)
+            {
+              Json::Value cur;
+              CHECK (HandleCall (c, call, false, cur));
+              if (!cur.isNull ())
+                response.append (cur);
+            }
+          if (response.empty ())
+            response = Json::Value ();
+        }
+    }
+  else if (!HandleCall (c, req, true, response))
+    return;
+
+  if (response.isNull ())
+    QueueResponse (c, 200, "");
+  else
+    QueueResponse (c, 200, Json::writeString (jsonWriterBuilder, response));
+}
+
+bool
+RelayServer::HandleCall (Connection& c, const Json::Value& req,
+                         const bool mayWait, Json::Value& response)
+{
+  response = Json::Value ();
+
+  if (!req.isObject () || !req["method"].isString ())
+    {
+      response = ErrorResponse (Json::Value (), ERROR_INVALID_REQUEST,
+                                "invalid request");
+      return true;
+    }
+
+  const bool notification = !req.isMember ("id");
+  const Json::Value id = req["id"];
+  const std::string method = req["method"].asString ();
+  const Json::Value& params = req["params"];
+
+  Json::Value result;
+  std::string channel;
+  if (!params.isObject () || !GetStringParam (params, "channel", channel))
+    response = ErrorResponse (id, ERROR_INVALID_PARAMS, "invalid params");
+  else if (method == "send")
+    {
+      std::string msg;
+      if (!GetStringParam (params, "message", msg))
+        response = ErrorResponse (id, ERROR_INVALID_PARAMS, "invalid params");
+      else
+        relay.Send (channel, msg);
+    }
+  else if (method == "getseq")
+    {
+      result = Json::Value (Json::objectValue);
+      result["seq"] = static_cast<Json::UInt64> (relay.GetSeq (channel));
+    }
+  else if (method == "receive")
+    {
+      const auto& fromSeq = params["fromseq"];
+      if (!fromSeq.isIntegral () || !fromSeq.isUInt64 ())
+        response = ErrorResponse (id, ERROR_INVALID_PARAMS, "invalid params");
+      else if (mayWait && !notification
+                && !relay.CanReceive (channel, fromSeq.asUInt64 ()))
+        {
+          c.waiting = true;
+          c.waitChannel = channel;
+          c.waitSeq = fromSeq.asUInt64 ();
+          c.waitId = id;
+          c.deadline = Clock::now () + options.receiveTimeout;
+          relay.AddWaiter (channel, c.id, c.waitSeq);
+          deadlines.emplace (c.deadline, c.id);
+          return false;
+        }
+      else
+        result = relay.Receive (channel, fromSeq.asUInt64 ());
+    }
+  else
+    response = ErrorResponse (id, ERROR_METHOD_NOT_FOUND,
+                              "unknown method: " + method);
+
+  if (notification)
+    response = Json::Value ();
+  else if (response.isNull ())
+    response = SuccessResponse (id, result);
+
+  return true;
+}
+
+void
+RelayServer::QueueResponse (Connection& c, const int status,
+                            const std::string& body)
+{
+  if (!c.keepAlive)
+    c.closeAfterWrite = true;
+
+  std::ostringstream out;
+  out << "HTTP/1.1 " << status << " " << StatusText (status) << "\r\n"
+      << "Content-Type: application/json\r\n"
+      << "Content-Length: " << body.size () << "\r\n";
+  if (!c.keepAlive)
+    out << "Connection: close\r\n";
+  out << "\r\n";
+
+  c.out += out.str ();
+  c.out += body;
+}
+
+void
+RelayServer::FinishConnection (const uint64_t id)
+{
+  const auto mit = connections.find (id);
+  if (mit == connections.end ())
+    return;
+  Connection& c = *mit->second;
+
+  while (!c.out.empty ())
+    {
+      const ssize_t n = send (c.fd, c.out.data (), c.out.size (),
+                              MSG_NOSIGNAL);
+      if (n > 0)
+        {
+          c.out.erase (0, n);
+          continue;
+        }
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        break;
+
+      VLOG (1) << "Writing to connection " << id << " failed";
+      CloseConnection (id);
+      return;
+    }
+
+  if (c.out.empty () && c.closeAfterWrite)
+    {
+      CloseConnection (id);
+      return;
+    }
+
+  /* Reading is paused while the buffers are full, i.e. while a request
+     waits for messages with more requests pipelined, or while the client
+     does not read its responses.  This bounds the memory used for each
+     connection.  */
+  uint32_t events = 0;
+  if (c.in.size () <= GetMaxBuffered () && c.out.size () <= GetMaxBuffered ())
+    events |= EPOLLIN;
+  if (!c.out.empty ())
+    events |= EPOLLOUT;
+
+  if (events != c.pollEvents)
+    {
+      epoll_event ev;
+      ev.events = events;
+      ev.data.u64 = id;
+      PCHECK (epoll_ctl (epollFd, EPOLL_CTL_MOD, c.fd, &ev) == 0);
+      c.pollEvents = events;
+    }
+}
+
+void
+RelayServer::CloseConnection (const uint64_t id)
+{
+  const auto mit = connections.find (id);
+  CHECK (mit != connections.end ());
+  Connection& c = *mit->second;
+
+  if (c.waiting)
+    {
+      relay.RemoveWaiter (c.waitChannel, id);
+      deadlines.erase (std::make_pair (c.deadline, id));
+    }
+
+  epoll_ctl (epollFd, EPOLL_CTL_DEL, c.fd, nullptr);
+  close (c.fd);
+  connections.erase (mit);
+
+  VLOG (2) << "Closed connection " << id;
+}
+
+void
+RelayServer::AnswerWaiter (Connection& c, const std::string& result)
+{
+  CHECK (c.waiting);
+  c.waiting = false;
+  deadlines.erase (std::make_pair (c.deadline, c.id));
+
+  /* The result is serialised only once for all waiters, and just wrapped
+     into the response with each client's id here.  */
+  std::string body = "{\"id\":";
+  body += Json::writeString (jsonWriterBuilder, c.waitId);
+  body += ",\"jsonrpc\":\"2.0\",\"result\":";
+  body += result;
+  body += "}";
+  QueueResponse (c, 200, body);
+
+  /* There may be more requests pipelined on the connection.  */
+  ProcessInput (c);
+  FinishConnection (c.id);
+}
+
+bool
+RelayServer::DeliverMessages ()
+{
+  const auto ready = relay.TakeReadyWaiters ();
+  if (ready.empty ())
+    return false;
+
+  std::map<const Json::Value*, std::string> serialised;
+  for (const auto& w : ready)
+    {
+      auto& str = serialised[w.result];
+      if (str.empty ())
+        str = Json::writeString (jsonWriterBuilder, *w.result);
+
+      const auto mit = connections.find (w.id);
+      CHECK (mit != connections.end ());
+      AnswerWaiter (*mit->second, str);
+    }
+
+  return true;
+}
+
+void
+RelayServer::ExpireWaiters ()
+{
+  const auto now = Clock::now ();
+  while (!deadlines.empty () && deadlines.begin ()->first <= now)
+    {
+      const uint64_t id = deadlines.begin ()->second;
+      const auto mit = connections.find (id);
+      CHECK (mit != connections.end ());
+      Connection& c = *mit->second;
+
+      relay.RemoveWaiter (c.waitChannel, id);
+      const auto result = relay.Receive (c.waitChannel, c.waitSeq);
+      AnswerWaiter (c, Json::writeString (jsonWriterBuilder, result));
+    }
+}
+
+} // namespace xaya
@@ -0,0 +1,220 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GAMECHANNEL_RELAYSERVER_HPP
+#define GAMECHANNEL_RELAYSERVER_HPP
+
+#include "broadcastrelay.hpp"
+
+#include <json/json.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace xaya
+{
+
+/**
+ * JSON-RPC server (over HTTP) for relaying off-chain broadcast messages
+ * between RpcBroadcast clients.  It implements the same interface as the
+ * Python rpcbroadcast.Server (see rpc-stubs/rpcbroadcast.json), i.e. the
+ * "send", "getseq" and "receive" methods.
+ *
+ * All connections are handled by a single event-loop thread based on epoll
+ * (so this only works on Linux).  A "receive" call for which no messages
+ * are available does not block anything; the connection is just parked
+ * on the channel in a BroadcastRelay until messages arrive or the receive
+ * timeout is reached.  Messages sent while handling one batch of socket
+ * events are delivered together to the waiting clients afterwards.
+ *
+ * JSON-RPC batch requests are supported, but "receive" calls inside a batch
+ * never wait for messages.
+ */
+class RelayServer
+{
+
+public:
+
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * Configuration options for the server.
+   */
+  struct Options
+  {
+
+    /** The host address to bind to.  */
+    std::string host = "localhost";
+
+    /** The port to listen on.  Zero means to use any free port.  */
+    int port = 0;
+
+    /** Time after which a waiting "receive" returns without messages.  */
+    std::chrono::milliseconds receiveTimeout{3'000};
+
+    /** Maximum size of a request body in bytes.  */
+    size_t maxRequestSize = 1 << 20;
+
+    /** Options for the relay state.  */
+    BroadcastRelay::Options relay;
+
+  };
+
+private:
+
+  struct Connection;
+
+  /** The configured options.  */
+  const Options options;
+
+  /** The relay state.  This is only accessed from the event loop.  */
+  BroadcastRelay relay;
+
+  /** The listening socket.  */
+  int listenFd = -1;
+
+  /** The epoll instance.  */
+  int epollFd = -1;
+
+  /** Eventfd used to wake up the event loop for stopping.  */
+  int wakeFd = -1;
+
+  /** The port we are actually listening on.  */
+  int port = 0;
+
+  /** Open connections by their ID.  */
+  std::map<uint64_t, std::unique_ptr<Connection>> connections;
+
+  /** ID for the next accepted connection.  */
+  uint64_t nextId;
+
+  /** Deadlines of waiting connections, ordered by time.  */
+  std::set<std::pair<Clock::time_point, uint64_t>> deadlines;
+
+  /** Builder for serialising JSON responses.  */
+  Json::StreamWriterBuilder jsonWriterBuilder;
+
+  /** Reader for parsing requests.  This is only used from the event loop.  */
+  std::unique_ptr<Json::CharReader> jsonReader;
+
+  /** Set to true when the event loop should stop.  */
+  std::atomic<bool> shouldStop;
+
+  /** The thread running the event loop.  */
+  std::thread loop;
+
+  /**
+   * Main function of the event loop.
+   */
+  void RunLoop ();
+
+  /**
+   * Accepts all pending incoming connections.
+   */
+  void AcceptConnections ();
+
+  /**
+   * Returns the maximum amount of data buffered for a connection in
+   * each direction, before we stop reading from it.
+   */
+  size_t GetMaxBuffered () const;
+
+  /**
+   * Reads available data from a connection, up to the buffer limit.
+   * Returns false if the connection has been closed by the peer or failed.
+   */
+  bool ReadInput (Connection& c);
+
+  /**
+   * Processes the complete requests buffered for a connection, as long
+   * as it is not waiting for messages.
+   */
+  void ProcessInput (Connection& c);
+
+  /**
+   * Handles a single HTTP request with the given body.
+   */
+  void HandleRequest (Connection& c, const std::string& body);
+
+  /**
+   * Handles a single JSON-RPC call.  If mayWait is true and the call is
+   * a "receive" that has to wait, the connection is parked and false is
+   * returned.  Otherwise the response (or null for notifications) is
+   * stored and true returned.
+   */
+  bool HandleCall (Connection& c, const Json::Value& req, bool mayWait,
+                   Json::Value& response);
+
+  /**
+   * Queues an HTTP response on the connection.
+   */
+  void QueueResponse (Connection& c, int status, const std::string& body);
+
+  /**
+   * Writes buffered output of a connection and updates its epoll
+   * registration.  Closes the connection if it is finished or failed.
+   */
+  void FinishConnection (uint64_t id);
+
+  /**
+   * Closes a connection and removes all data about it.
+   */
+  void CloseConnection (uint64_t id);
+
+  /**
+   * Answers a parked connection with the given serialised result.
+   */
+  void AnswerWaiter (Connection& c, const std::string& result);
+
+  /**
+   * Answers all waiters that can be answered due to newly sent messages.
+   * Returns true if there were any.
+   */
+  bool DeliverMessages ();
+
+  /**
+   * Answers all waiters whose receive timeout has passed.
+   */
+  void ExpireWaiters ();
+
+public:
+
+  explicit RelayServer (const Options& o);
+  ~RelayServer ();
+
+  RelayServer () = delete;
+  RelayServer (const RelayServer&) = delete;
+  void operator= (const RelayServer&) = delete;
+
+  /**
+   * Binds the listening socket and starts the event-loop thread.
+   */
+  void Start ();
+
+  /**
+   * Stops the event loop and closes all connections.
+   */
+  void Stop ();
+
+  /**
+   * Returns the port the server listens on (after Start).
+   */
+  int
+  GetPort () const
+  {
+    return port;
+  }
+
+};
+
+} // namespace xaya
+
+#endif // GAMECHANNEL_RELAYSERVER_HPP
@@ -0,0 +1,249 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "relayserver.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <glog/logging.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace xaya
+{
+namespace
+{
+
+/**
+ * Very basic blocking HTTP client for JSON-RPC requests to a RelayServer,
+ * using a single keep-alive connection.  Requests can be pipelined by
+ * writing several of them before reading the responses.
+ */
+class BenchClient
+{
+
+private:
+
+  int fd;
+
+  /** Received data not yet returned as response.  */
+  std::string buffer;
+
+public:
+
+  explicit BenchClient (const int port)
+  {
+    fd = socket (AF_INET, SOCK_STREAM, 0);
+    PCHECK (fd >= 0);
+
+    sockaddr_in addr;
+    std::memset (&addr, 0, sizeof (addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons (port);
+    addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+    PCHECK (connect (fd, reinterpret_cast<const sockaddr*> (&addr),
+                     sizeof (addr)) == 0);
+
+    const int one = 1;
+    setsockopt (fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof (one));
+  }
+
+  ~BenchClient ()
+  {
+    close (fd);
+  }
+
+  BenchClient (const BenchClient&) = delete;
+  void operator= (const BenchClient&) = delete;
+
+  /**
+   * Writes a request with the given JSON body.
+   */
+  void
+  Write (const std::string& body)
+  {
+    std::ostringstream req;
+    req << "POST / HTTP/1.1\r\n"
+        << "Content-Type: application/json\r\n"
+        << "Content-Length: " << body.size () << "\r\n\r\n"
+        << body;
+
+    const std::string data = req.str ();
+    size_t done = 0;
+    while (done < data.size ())
+      {
+        const ssize_t n = write (fd, data.data () + done, data.size () - done);
+        PCHECK (n > 0);
+        done += n;
+      }
+  }
+
+  /**
+   * Reads the next response and returns its body.
+   */
+  std::string
+  Read ()
+  {
+    while (true)
+      {
+        const size_t headerEnd = buffer.find ("\r\n\r\n");
+        if (headerEnd != std::string::npos)
+          {
+            const size_t pos = buffer.find ("Content-Length: ");
+            CHECK_LT (pos, headerEnd);
+            const size_t len = std::stoul (buffer.substr (pos + 16));
+            const size_t total = headerEnd + 4 + len;
+            if (buffer.size () >= total)
+              {
+                std::string body = buffer.substr (headerEnd + 4, len);
+                buffer.erase (0, total);
+                return body;
+              }
+          }
+
+        char buf[16 * 1024];
+        const ssize_t n = read (fd, buf, sizeof (buf));
+        PCHECK (n > 0);
+        buffer.append (buf, n);
+      }
+  }
+
+};
+
+/**
+ * Returns the JSON body for a call with the given method and params.
+ */
+std::string
+CallBody (const std::string& method, const std::string& params)
+{
+  return "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"" + method
+            + "\",\"params\":" + params + "}";
+}
+
+/**
+ * Starts a relay server on a free port with settings for benchmarking.
+ */
+std::unique_ptr<RelayServer>
+StartServer ()
+{
+  RelayServer::Options options;
+  options.host = "127.0.0.1";
+  options.receiveTimeout = std::chrono::milliseconds (60'000);
+
+  auto res = std::make_unique<RelayServer> (options);
+  res->Start ();
+  return res;
+}
+
+/**
+ * Sends messages and queries the sequence number over a single connection,
+ * with the given number of requests pipelined each round.  This measures
+ * the raw request throughput of the event loop.
+ */
+void
+RelayServerRequests (benchmark::State& state)
+{
+  const unsigned depth = state.range (0);
+
+  auto server = StartServer ();
+  BenchClient client(server->GetPort ());
+
+  const std::string send = CallBody (
+      "send", "{\"channel\":\"ch\",\"message\":\"some message data\"}");
+  const std::string getseq = CallBody ("getseq", "{\"channel\":\"ch\"}");
+
+  for (auto _ : state)
+    {
+      for (unsigned i = 0; i < depth; ++i)
+        client.Write (i % 2 == 0 ? send : getseq);
+      for (unsigned i = 0; i < depth; ++i)
+        benchmark::DoNotOptimize (client.Read ());
+    }
+
+  state.SetItemsProcessed (depth * state.iterations ());
+}
+BENCHMARK (RelayServerRequests)
+  ->Unit (benchmark::kMicrosecond)
+  ->Arg (1)
+  ->Arg (16)
+  ->Arg (128);
+
+/**
+ * Long-polls on many channels with one waiting client each, and then
+ * sends a message to every channel and collects all deliveries.  This is
+ * the load pattern with many open game channels, and measures how quickly
+ * messages are relayed to the waiting clients.
+ */
+void
+RelayServerFanOut (benchmark::State& state)
+{
+  const unsigned numChannels = state.range (0);
+
+  /* Both ends of all connections are in this process, so we may need
+     more file descriptors than allowed by default.  */
+  rlimit lim;
+  PCHECK (getrlimit (RLIMIT_NOFILE, &lim) == 0);
+  lim.rlim_cur = lim.rlim_max;
+  PCHECK (setrlimit (RLIMIT_NOFILE, &lim) == 0);
+
+  auto server = StartServer ();
+  BenchClient sender(server->GetPort ());
+
+  std::vector<std::string> channels;
+  std::vector<std::unique_ptr<BenchClient>> receivers;
+  for (unsigned i = 0; i < numChannels; ++i)
+    {
+      channels.push_back ("channel " + std::to_string (i));
+      receivers.push_back (std::make_unique<BenchClient> (server->GetPort ()));
+    }
+
+  unsigned seq = 0;
+  const auto receiveAll = [&] ()
+    {
+      for (unsigned i = 0; i < numChannels; ++i)
+        receivers[i]->Write (CallBody (
+            "receive",
+            "{\"channel\":\"" + channels[i] + "\",\"fromseq\":"
+                + std::to_string (seq) + "}"));
+    };
+
+  receiveAll ();
+  for (auto _ : state)
+    {
+      for (const auto& ch : channels)
+        sender.Write (CallBody (
+            "send", "{\"channel\":\"" + ch + "\",\"message\":\"data\"}"));
+      for (unsigned i = 0; i < numChannels; ++i)
+        benchmark::DoNotOptimize (sender.Read ());
+
+      for (auto& r : receivers)
+        benchmark::DoNotOptimize (r->Read ());
+
+      state.PauseTiming ();
+      ++seq;
+      receiveAll ();
+      state.ResumeTiming ();
+    }
+
+  state.SetItemsProcessed (numChannels * state.iterations ());
+}
+BENCHMARK (RelayServerFanOut)
+  ->Unit (benchmark::kMillisecond)
+  ->Arg (10)
+  ->Arg (100)
+  ->Arg (1'000);
+
+} // anonymous namespace
+} // namespace xaya
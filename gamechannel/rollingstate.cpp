@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2022 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -8,6 +8,7 @@
 #include "stateproof.hpp"
 
 #include <xayautil/base64.hpp>
+#include <xayautil/hash.hpp>
 
 #include <google/protobuf/util/message_differencer.h>
 
@@ -31,6 +32,34 @@ constexpr size_t STATE_UPDATE_QUEUE_SIZE = 100;
 
 } // anonymous namespace
 
+/**
+ * Computes the digest of an on-chain update, i.e. its metadata, reinit
+ * state and state proof.  Each part is prefixed by its length, so that
+ * the concatenation is unambiguous.
+ */
+uint256
+OnChainUpdateDigest (const proto::ChannelMetadata& meta,
+                     const BoardState& reinitState,
+                     const proto::StateProof& proof)
+{
+  std::string metaBytes, proofBytes;
+  CHECK (meta.SerializeToString (&metaBytes));
+  CHECK (proof.SerializeToString (&proofBytes));
+
+  const std::string* parts[] = {&metaBytes, &reinitState, &proofBytes};
+
+  SHA256 hasher;
+  for (const std::string* part : parts)
+    {
+      std::string len;
+      for (uint64_t n = part->size (), i = 0; i < 8; ++i, n >>= 8)
+        len.push_back (static_cast<char> (n & 0xFF));
+      hasher << len << *part;
+    }
+
+  return hasher.Finalise ();
+}
+
 /* ************************************************************************** */
 
 void
@@ -152,18 +181,61 @@ RollingState::GetMetadata () const
   return *mit->second.meta;
 }
 
-bool
-RollingState::UpdateOnChain (const proto::ChannelMetadata& meta,
+const ParticipantKeys&
+RollingState::GetParticipantKeys () const
+{
+  CHECK (!reinits.empty ()) << "RollingState has not been initialised yet";
+  const auto mit = reinits.find (reinitId);
+  CHECK (mit != reinits.end ());
+  return *mit->second.keys;
+}
+
+void
+RollingState::VerifyOnChain (const proto::ChannelMetadata& meta,
                              const BoardState& reinitState,
-                             const proto::StateProof& proof)
+                             const proto::StateProof& proof) const
 {
   /* Since this comes from on-chain, it "should" be valid!  */
   CHECK (CheckVersionedProto (rules, meta, proof));
 
-  BoardState provenState;
   CHECK (VerifyStateProof (verifier, rules, gameId, channelId, meta,
-                           reinitState, proof, provenState))
+                           reinitState, proof))
       << "State proof provided on-chain is not valid";
+}
+
+bool
+RollingState::UpdateOnChain (const proto::ChannelMetadata& meta,
+                             const BoardState& reinitState,
+                             const proto::StateProof& proof)
+{
+  return UpdateOnChain (meta, reinitState, proof, false);
+}
+
+bool
+RollingState::UpdateOnChain (const proto::ChannelMetadata& meta,
+                             const BoardState& reinitState,
+                             const proto::StateProof& proof,
+                             const bool verified)
+{
+  /* If this is exactly the update we verified last for its reinit, then
+     nothing can have changed about the state (the latest known state is
+     at least as fresh as the one from the last update).  In that case,
+     only the current reinit ID may need to be switched.  */
+  const uint256 digest = OnChainUpdateDigest (meta, reinitState, proof);
+  const auto known = reinits.find (meta.reinit ());
+  if (known != reinits.end () && known->second.lastOnChainDigest == digest)
+    {
+      VLOG (1)
+          << "On-chain update for channel " << channelId.ToHex ()
+          << " is unchanged, skipping verification";
+      const bool reinitChange = (reinitId != meta.reinit ());
+      reinitId = meta.reinit ();
+      return reinitChange;
+    }
+
+  if (!verified)
+    VerifyOnChain (meta, reinitState, proof);
+  const BoardState& provenState = UnverifiedProofEndState (proof);
 
   /* First of all, store the current on-chain update's reinit ID as the
      "latest known".  We also keep track of whether or not the ID changed,
@@ -181,12 +253,14 @@ RollingState::UpdateOnChain (const proto::ChannelMetadata& meta,
     {
       ReinitData entry;
       entry.meta = std::make_unique<proto::ChannelMetadata> (meta);
-      entry.reinitState = reinitState;
+      entry.keys = std::make_unique<ParticipantKeys> (verifier, *entry.meta);
+      entry.reinitState = SharedBoardState (reinitState);
       entry.proof = proof;
-      entry.latestState = rules.ParseState (channelId, *entry.meta,
-                                            provenState);
+      entry.latestState = rules.ParseStateShared (channelId, *entry.meta,
+                                                  provenState);
       CHECK (entry.latestState != nullptr);
       entry.onChainTurn = entry.latestState->TurnCount ();
+      entry.lastOnChainDigest = digest;
 
       LOG (INFO)
           << "Added previously unknown reinitialisation.  Turn count: "
@@ -213,9 +287,11 @@ RollingState::UpdateOnChain (const proto::ChannelMetadata& meta,
      than the state that we already have.  */
   ReinitData& entry = mit->second;
   CHECK (MessageDifferencer::Equals (meta, *entry.meta));
-  CHECK_EQ (reinitState, entry.reinitState);
+  CHECK_EQ (reinitState, entry.reinitState.Get ());
+  entry.lastOnChainDigest = digest;
 
-  auto parsed = rules.ParseState (channelId, *entry.meta, provenState);
+  auto parsed
+      = rules.ParseStateShared (channelId, *entry.meta, provenState);
   CHECK (parsed != nullptr);
   const unsigned parsedCnt = parsed->TurnCount ();
   LOG (INFO) << "Turn count provided in the update: " << parsedCnt;
@@ -281,16 +357,17 @@ RollingState::UpdateWithMove (const std::string& updReinit,
   /* Make sure that the state proof is actually valid.  In contrast to
      on-chain updates (which are filtered through the GSP), the data we get
      here comes straight from the other players and may be complete garbage.  */
-  BoardState provenState;
-  if (!VerifyStateProof (verifier, rules, gameId, channelId, *entry.meta,
-                         entry.reinitState, proof, provenState))
+  if (!VerifyStateProof (verifier, *entry.keys, rules, gameId, channelId,
+                         *entry.meta, entry.reinitState, proof))
     {
       LOG (WARNING)
           << "Off-chain update for channel " << channelId.ToHex ()
           << " has an invalid state proof";
       return false;
     }
-  auto parsed = rules.ParseState (channelId, *entry.meta, provenState);
+  const BoardState& provenState = UnverifiedProofEndState (proof);
+  auto parsed
+      = rules.ParseStateShared (channelId, *entry.meta, provenState);
   CHECK (parsed != nullptr);
 
   /* The state proof is valid.  Update our state if the provided one is actually
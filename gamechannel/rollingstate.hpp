@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2022 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -87,6 +87,14 @@ public:
 
 };
 
+/**
+ * Computes the digest of an on-chain update, i.e. its metadata, reinit
+ * state and state proof.  Equal digests mean that the updates are the same.
+ */
+uint256 OnChainUpdateDigest (const proto::ChannelMetadata& meta,
+                             const BoardState& reinitState,
+                             const proto::StateProof& proof);
+
 /**
  * All data about the current board state of a channel game.  This keeps track
  * of the latest known state including full proof for each reinitialisation
@@ -119,17 +127,31 @@ private:
      */
     std::unique_ptr<proto::ChannelMetadata> meta;
 
+    /**
+     * The participant keys for meta.  They are computed once for the
+     * reinitialisation and then reused for verifying all state proofs.
+     */
+    std::unique_ptr<ParticipantKeys> keys;
+
     /** The initial state for that reinitialisation.  */
-    BoardState reinitState;
+    SharedBoardState reinitState;
 
     /** The turn count for the latest state known on chain.  */
     unsigned onChainTurn;
 
+    /**
+     * Digest of the last on-chain update (metadata, reinit state and proof)
+     * that was verified for this reinitialisation.  If the same update
+     * is received again (which is the common case, as the GSP returns the
+     * unchanged data for each new block), we skip verifying it.
+     */
+    uint256 lastOnChainDigest;
+
     /** The state proof for the latest state.  */
     proto::StateProof proof;
 
     /** The latest state as parsed object.  */
-    std::unique_ptr<ParsedBoardState> latestState;
+    std::shared_ptr<const ParsedBoardState> latestState;
 
     ReinitData () = default;
     ReinitData (ReinitData&&) = default;
@@ -205,6 +227,12 @@ public:
    */
   const proto::ChannelMetadata& GetMetadata () const;
 
+  /**
+   * Returns the participant keys for the metadata of the currently
+   * best reinitId.
+   */
+  const ParticipantKeys& GetParticipantKeys () const;
+
   /**
    * Updates the state for a newly received on-chain update.  This assumes
    * that the state proof is valid, and it also updates the "current"
@@ -217,6 +245,29 @@ public:
                       const BoardState& reinitState,
                       const proto::StateProof& proof);
 
+  /**
+   * Updates the state for an on-chain update like the other overload.
+   * If verified is true, the state proof must have been checked with
+   * VerifyOnChain already, and is not verified again.
+   */
+  bool UpdateOnChain (const proto::ChannelMetadata& meta,
+                      const BoardState& reinitState,
+                      const proto::StateProof& proof,
+                      bool verified);
+
+  /**
+   * Verifies the state proof of an on-chain update in the same way as
+   * UpdateOnChain does, without changing any state.  Since on-chain data
+   * is expected to be valid, this CHECK-fails if it is not.
+   *
+   * This only reads the instance, so it can be run in parallel for many
+   * channels (as long as the BoardRules and SignatureVerifier can be used
+   * from multiple threads).
+   */
+  void VerifyOnChain (const proto::ChannelMetadata& meta,
+                      const BoardState& reinitState,
+                      const proto::StateProof& proof) const;
+
   /**
    * Updates the state for a newly received off-chain state with the
    * given reinitialisation ID (if we know it).  This verifies the state proof,
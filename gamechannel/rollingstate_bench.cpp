@@ -0,0 +1,110 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "rollingstate.hpp"
+
+#include "benchutils.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <glog/logging.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace xaya
+{
+namespace
+{
+
+/**
+ * Runs the sequence of off-chain updates of a full channel game through
+ * RollingState::UpdateWithMove.
+ */
+void
+RollingStateUpdateWithMove (benchmark::State& state)
+{
+  BenchChannel ch(state.range (0));
+  const auto proofs = ch.BuildProofSequence (BenchChannel::MAX_LENGTH + 1);
+
+  for (auto _ : state)
+    {
+      state.PauseTiming ();
+      auto rs = std::make_unique<RollingState> (ch.rules, ch.verifier,
+                                                ch.gameId, ch.channelId);
+      CHECK (rs->UpdateOnChain (ch.meta, ch.reinitState, proofs.front ()));
+      state.ResumeTiming ();
+
+      for (size_t i = 1; i < proofs.size (); ++i)
+        CHECK (rs->UpdateWithMove (ch.meta.reinit (), proofs[i]));
+
+      state.PauseTiming ();
+      rs.reset ();
+      state.ResumeTiming ();
+    }
+  state.SetItemsProcessed (state.iterations () * (proofs.size () - 1));
+}
+BENCHMARK (RollingStateUpdateWithMove)->Arg (2)->Arg (10);
+
+/**
+ * Runs the sequence of states of a full channel game through
+ * RollingState::UpdateOnChain, as if each was put on chain.
+ */
+void
+RollingStateUpdateOnChain (benchmark::State& state)
+{
+  BenchChannel ch(state.range (0));
+  const auto proofs = ch.BuildProofSequence (BenchChannel::MAX_LENGTH + 1);
+
+  for (auto _ : state)
+    {
+      state.PauseTiming ();
+      auto rs = std::make_unique<RollingState> (ch.rules, ch.verifier,
+                                                ch.gameId, ch.channelId);
+      state.ResumeTiming ();
+
+      for (const auto& p : proofs)
+        CHECK (rs->UpdateOnChain (ch.meta, ch.reinitState, p));
+
+      state.PauseTiming ();
+      rs.reset ();
+      state.ResumeTiming ();
+    }
+  state.SetItemsProcessed (state.iterations () * proofs.size ());
+}
+BENCHMARK (RollingStateUpdateOnChain)->Arg (2)->Arg (10);
+
+/**
+ * Inserts updates for a varying number of reinits into a StateUpdateQueue
+ * that is kept at its maximum size, and extracts them again.
+ */
+void
+StateUpdateQueueChurn (benchmark::State& state)
+{
+  constexpr size_t maxSize = 100;
+  constexpr size_t numInserts = 1'000;
+
+  const unsigned numReinits = state.range (0);
+  std::vector<std::string> reinits;
+  for (unsigned i = 0; i < numReinits; ++i)
+    reinits.push_back ("reinit " + std::to_string (i));
+
+  BenchChannel ch(2);
+  const auto proofs = ch.BuildProofSequence (10);
+
+  for (auto _ : state)
+    {
+      StateUpdateQueue queue(maxSize);
+      for (size_t i = 0; i < numInserts; ++i)
+        queue.Insert (reinits[i % numReinits], proofs[i % proofs.size ()]);
+      for (const auto& r : reinits)
+        benchmark::DoNotOptimize (queue.ExtractQueue (r));
+    }
+  state.SetItemsProcessed (state.iterations () * numInserts);
+}
+BENCHMARK (StateUpdateQueueChurn)->Arg (1)->Arg (10)->Arg (200);
+
+} // anonymous namespace
+} // namespace xaya
@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2022 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -23,6 +23,7 @@ namespace
 
 using google::protobuf::TextFormat;
 using google::protobuf::util::MessageDifferencer;
+using testing::_;
 
 /**
  * Parses a StateProof from text proto.
@@ -162,12 +163,15 @@ protected:
   /**
    * Expects that the latest state and associated reinit ID for the rolling
    * state matches the given data.  This checks both GetLatestState and
-   * GetStateProof against the expected state.
+   * GetStateProof against the expected state, and that the participant
+   * keys correspond to the current metadata.
    */
   void
   ExpectState (const BoardState& expectedState, const std::string& reinitId)
   {
     EXPECT_EQ (state.GetReinitId (), reinitId);
+    EXPECT_EQ (state.GetParticipantKeys ().size (),
+               state.GetMetadata ().participants_size ());
     EXPECT_TRUE (state.GetLatestState ().Equals (expectedState));
     EXPECT_EQ (UnverifiedProofEndState (state.GetStateProof ()), expectedState);
   }
@@ -238,6 +242,39 @@ TEST_F (RollingStateTests, OnChainUpdate)
   EXPECT_EQ (state.GetOnChainTurnCount (), 5);
 }
 
+TEST_F (RollingStateTests, UnchangedOnChainUpdateSkipsVerification)
+{
+  const auto proof = ParseStateProof (R"(
+    initial_state: { data: "13 5" }
+    transitions:
+      {
+        move: "50"
+        new_state:
+          {
+            data: "63 6"
+            signatures: "sgn 1"
+          }
+      }
+  )");
+  const auto proof2 = ParseStateProof (R"(
+    initial_state: { data: "25 4" }
+  )");
+
+  EXPECT_TRUE (state.UpdateOnChain (meta1, "13 5", proof));
+  EXPECT_TRUE (state.UpdateOnChain (meta2, "25 4", proof2));
+  ExpectState ("25 4", "reinit 2");
+
+  /* From now on, the same updates should not be verified again.  */
+  EXPECT_CALL (verifier, RecoverSigner (_, _)).Times (0);
+
+  EXPECT_FALSE (state.UpdateOnChain (meta2, "25 4", proof2));
+  EXPECT_TRUE (state.UpdateOnChain (meta1, "13 5", proof));
+  ExpectState ("63 6", "reinit 1");
+  EXPECT_EQ (state.GetOnChainTurnCount (), 6);
+  EXPECT_FALSE (state.UpdateOnChain (meta1, "13 5", proof));
+  ExpectState ("63 6", "reinit 1");
+}
+
 TEST_F (RollingStateTests, UpdateWithMoveUnknownReinit)
 {
   state.UpdateOnChain (meta1, "13 5", ParseStateProof (R"(
@@ -0,0 +1,83 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+/* Native JSON-RPC broadcast relay server, with the same interface as
+   rpc-channel-server.py but able to handle many more channels and
+   clients at the same time.  */
+
+#include "config.h"
+
+#include "relayserver.hpp"
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <signal.h>
+
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+DEFINE_string (host, "localhost", "host address where to bind the server");
+DEFINE_int32 (port, 0, "listening port for the server");
+
+DEFINE_int32 (receive_timeout_ms, 3'000,
+              "timeout in milliseconds after which a waiting receive call"
+              " returns without messages");
+DEFINE_int32 (buffer_size, 1'024,
+              "number of messages kept per channel");
+DEFINE_int32 (max_batch, 256,
+              "maximum number of messages returned by a single receive call");
+
+} // anonymous namespace
+
+int
+main (int argc, char** argv)
+{
+  google::InitGoogleLogging (argv[0]);
+
+  gflags::SetUsageMessage ("JSON-RPC game-channel broadcast relay server");
+  gflags::SetVersionString (PACKAGE_VERSION);
+  gflags::ParseCommandLineFlags (&argc, &argv, true);
+
+  if (FLAGS_port <= 0)
+    {
+      std::cerr << "Error: --port must be set" << std::endl;
+      return EXIT_FAILURE;
+    }
+  if (FLAGS_receive_timeout_ms <= 0 || FLAGS_buffer_size <= 0
+        || FLAGS_max_batch <= 0)
+    {
+      std::cerr << "Error: invalid relay options" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+  /* Block the termination signals in all threads, so that we can wait
+     for them below.  */
+  sigset_t signals;
+  sigemptyset (&signals);
+  sigaddset (&signals, SIGINT);
+  sigaddset (&signals, SIGTERM);
+  pthread_sigmask (SIG_BLOCK, &signals, nullptr);
+
+  xaya::RelayServer::Options options;
+  options.host = FLAGS_host;
+  options.port = FLAGS_port;
+  options.receiveTimeout
+      = std::chrono::milliseconds (FLAGS_receive_timeout_ms);
+  options.relay.bufferSize = FLAGS_buffer_size;
+  options.relay.maxBatch = FLAGS_max_batch;
+
+  xaya::RelayServer server(options);
+  server.Start ();
+
+  int sig;
+  sigwait (&signals, &sig);
+  LOG (INFO) << "Received signal " << sig << ", shutting down";
+  server.Stop ();
+
+  return EXIT_SUCCESS;
+}
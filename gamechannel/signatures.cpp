@@ -1,11 +1,12 @@
-// Copyright (C) 2019-2022 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "signatures.hpp"
 
+#include "digestcache.hpp"
+
 #include <xayautil/base64.hpp>
-#include <xayautil/hash.hpp>
 
 #include <glog/logging.h>
 
@@ -14,6 +15,81 @@
 namespace xaya
 {
 
+void
+ParticipantSet::Insert (const int i)
+{
+  CHECK_GE (i, 0);
+  if (i < INLINE_BITS)
+    {
+      low |= uint64_t (1) << i;
+      return;
+    }
+
+  const size_t idx = i - INLINE_BITS;
+  if (high.size () <= idx)
+    high.resize (idx + 1, false);
+  high[idx] = true;
+}
+
+bool
+ParticipantSet::Contains (const int i) const
+{
+  CHECK_GE (i, 0);
+  if (i < INLINE_BITS)
+    return (low >> i) & 1;
+
+  const size_t idx = i - INLINE_BITS;
+  return idx < high.size () && high[idx];
+}
+
+unsigned
+ParticipantSet::Count () const
+{
+  unsigned res = 0;
+  for (uint64_t bits = low; bits != 0; bits &= bits - 1)
+    ++res;
+  for (const bool b : high)
+    if (b)
+      ++res;
+
+  return res;
+}
+
+ParticipantSet&
+ParticipantSet::operator|= (const ParticipantSet& other)
+{
+  low |= other.low;
+  if (high.size () < other.high.size ())
+    high.resize (other.high.size (), false);
+  for (size_t i = 0; i < other.high.size (); ++i)
+    if (other.high[i])
+      high[i] = true;
+
+  return *this;
+}
+
+std::set<int>
+ParticipantSet::ToSet () const
+{
+  std::set<int> res;
+  for (int i = 0; i < INLINE_BITS; ++i)
+    if (Contains (i))
+      res.emplace_hint (res.end (), i);
+  for (size_t i = 0; i < high.size (); ++i)
+    if (high[i])
+      res.emplace_hint (res.end (), INLINE_BITS + i);
+
+  return res;
+}
+
+ParticipantKeys::ParticipantKeys (const SignatureVerifier& verifier,
+                                  const proto::ChannelMetadata& meta)
+{
+  keys.reserve (meta.participants_size ());
+  for (const auto& p : meta.participants ())
+    keys.push_back (verifier.GetAddressKey (p.address ()));
+}
+
 std::string
 GetChannelSignatureMessage (const std::string& gameId,
                             const uint256& channelId,
@@ -33,7 +109,7 @@ GetChannelSignatureMessage (const std::string& gameId,
       << "Channel: " << channelId.ToHex () << "\n"
       << "Reinit: " << EncodeBase64 (meta.reinit ()) << "\n"
       << "Topic: " << topic << "\n"
-      << "Data Hash: " << SHA256::Hash (data).ToHex ();
+      << "Data Hash: " << DataDigestCache::Global ().Get (data).ToHex ();
 
   return res.str ();
 }
@@ -46,18 +122,36 @@ VerifyParticipantSignatures (const SignatureVerifier& verifier,
                              const std::string& topic,
                              const proto::SignedData& data)
 {
+  const ParticipantKeys keys(verifier, meta);
+  return VerifyParticipantSignatures (verifier, keys, gameId, channelId, meta,
+                                      topic, data).ToSet ();
+}
+
+ParticipantSet
+VerifyParticipantSignatures (const SignatureVerifier& verifier,
+                             const ParticipantKeys& keys,
+                             const std::string& gameId,
+                             const uint256& channelId,
+                             const proto::ChannelMetadata& meta,
+                             const std::string& topic,
+                             const proto::SignedData& data)
+{
+  CHECK_EQ (keys.size (), meta.participants_size ());
+
   const auto msg
       = GetChannelSignatureMessage (gameId, channelId, meta,
                                     topic, data.data ());
 
-  std::set<std::string> addresses;
+  /* There are typically only very few signatures and participants (e.g. two
+     each), so a linear scan is cheaper than building up any set.  */
+  ParticipantSet res;
   for (const auto& sgn : data.signatures ())
-    addresses.emplace (verifier.RecoverSigner (msg, sgn));
-
-  std::set<int> res;
-  for (int i = 0; i < meta.participants_size (); ++i)
-    if (addresses.count (meta.participants (i).address ()) > 0)
-      res.emplace (i);
+    {
+      const std::string signer = verifier.RecoverSignerKey (msg, sgn);
+      for (int i = 0; i < keys.size (); ++i)
+        if (keys[i] == signer)
+          res.Insert (i);
+    }
 
   return res;
 }
@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2022 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -10,8 +10,10 @@
 
 #include <xayautil/uint256.hpp>
 
+#include <cstdint>
 #include <set>
 #include <string>
+#include <vector>
 
 namespace xaya
 {
@@ -41,6 +43,34 @@ public:
   virtual std::string RecoverSigner (const std::string& msg,
                                      const std::string& sgn) const = 0;
 
+  /**
+   * Converts an address (as used in the channel metadata) into a "key"
+   * that can be compared directly against the result of RecoverSignerKey.
+   * Implementations can override this together with RecoverSignerKey to
+   * match signatures against participants without formatting the recovered
+   * addresses (e.g. comparing raw bytes instead of checksummed strings).
+   *
+   * The two methods must be consistent with RecoverSigner, i.e.
+   * RecoverSignerKey(msg, sgn) == GetAddressKey(addr) must hold if and
+   * only if RecoverSigner(msg, sgn) == addr.  The default implementations
+   * just use the address strings themselves.
+   */
+  virtual std::string
+  GetAddressKey (const std::string& addr) const
+  {
+    return addr;
+  }
+
+  /**
+   * Recovers the signer of a message like RecoverSigner, but returns
+   * the key corresponding to the address (see GetAddressKey).
+   */
+  virtual std::string
+  RecoverSignerKey (const std::string& msg, const std::string& sgn) const
+  {
+    return RecoverSigner (msg, sgn);
+  }
+
 };
 
 /**
@@ -69,6 +99,107 @@ public:
 
 /* ************************************************************************** */
 
+/**
+ * A set of participant indices (e.g. those who signed some data), stored
+ * as a bitset.  The first 64 participants (i.e. all of them in practice)
+ * are stored inline without any allocations.
+ */
+class ParticipantSet
+{
+
+private:
+
+  /** Number of participants stored in the inline bitmask.  */
+  static constexpr int INLINE_BITS = 64;
+
+  /** Bits for the first INLINE_BITS participants.  */
+  uint64_t low = 0;
+
+  /** Bits for all further participants (if any).  */
+  std::vector<bool> high;
+
+public:
+
+  ParticipantSet () = default;
+
+  ParticipantSet (const ParticipantSet&) = default;
+  ParticipantSet (ParticipantSet&&) = default;
+  ParticipantSet& operator= (const ParticipantSet&) = default;
+  ParticipantSet& operator= (ParticipantSet&&) = default;
+
+  /**
+   * Adds the given index to the set.
+   */
+  void Insert (int i);
+
+  /**
+   * Returns true if the given index is in the set.
+   */
+  bool Contains (int i) const;
+
+  /**
+   * Returns the number of indices in the set.
+   */
+  unsigned Count () const;
+
+  /**
+   * Adds all elements of the other set to this one.
+   */
+  ParticipantSet& operator|= (const ParticipantSet& other);
+
+  /**
+   * Returns the elements as ordered std::set.
+   */
+  std::set<int> ToSet () const;
+
+};
+
+/**
+ * The keys (as per SignatureVerifier::GetAddressKey) of all participants
+ * of a channel metadata.  They can be computed once per metadata and then
+ * reused for verifying many signatures.
+ */
+class ParticipantKeys
+{
+
+private:
+
+  /** The key for each participant, by index.  */
+  std::vector<std::string> keys;
+
+public:
+
+  explicit ParticipantKeys (const SignatureVerifier& verifier,
+                            const proto::ChannelMetadata& meta);
+
+  ParticipantKeys (ParticipantKeys&&) = default;
+  ParticipantKeys& operator= (ParticipantKeys&&) = default;
+
+  ParticipantKeys (const ParticipantKeys&) = delete;
+  void operator= (const ParticipantKeys&) = delete;
+
+  /**
+   * Returns the number of participants.
+   */
+  int
+  size () const
+  {
+    return keys.size ();
+  }
+
+  /**
+   * Returns the key for the participant with the given index.
+   */
+  const std::string&
+  operator[] (const int i) const
+  {
+    return keys[i];
+  }
+
+};
+
+/* ************************************************************************** */
+
 /**
  * Constructs the message (as string) that will be passed to "signmessage"
  * for the given channel, topic and raw data to sign.
@@ -104,6 +235,21 @@ std::set<int> VerifyParticipantSignatures (const SignatureVerifier& verifier,
                                            const std::string& topic,
                                            const proto::SignedData& data);
 
+/**
+ * Verifies the signatures on a SignedData instance like the other overload,
+ * but matches them against precomputed participant keys (which must be
+ * for the same verifier and metadata).  This avoids recomputing the keys
+ * when many signatures are checked for the same metadata, and returns
+ * the result as bitset.
+ */
+ParticipantSet VerifyParticipantSignatures (const SignatureVerifier& verifier,
+                                            const ParticipantKeys& keys,
+                                            const std::string& gameId,
+                                            const uint256& channelId,
+                                            const proto::ChannelMetadata& meta,
+                                            const std::string& topic,
+                                            const proto::SignedData& data);
+
 /**
  * Tries to sign the given data for the given participant index, using
  * the provided signer.  Returns true if a signature could be made.
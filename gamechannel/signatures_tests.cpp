@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2022 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -24,6 +24,100 @@ namespace
 using testing::_;
 using testing::Return;
 
+/* ************************************************************************** */
+
+TEST (ParticipantSetTests, Basic)
+{
+  ParticipantSet s;
+  EXPECT_EQ (s.Count (), 0);
+  EXPECT_FALSE (s.Contains (0));
+
+  s.Insert (1);
+  s.Insert (1);
+  s.Insert (63);
+  EXPECT_EQ (s.Count (), 2);
+  EXPECT_FALSE (s.Contains (0));
+  EXPECT_TRUE (s.Contains (1));
+  EXPECT_TRUE (s.Contains (63));
+  EXPECT_EQ (s.ToSet (), std::set<int> ({1, 63}));
+}
+
+TEST (ParticipantSetTests, ManyParticipants)
+{
+  ParticipantSet s;
+  s.Insert (0);
+  s.Insert (64);
+  s.Insert (200);
+  EXPECT_EQ (s.Count (), 3);
+  EXPECT_TRUE (s.Contains (64));
+  EXPECT_FALSE (s.Contains (65));
+  EXPECT_FALSE (s.Contains (1'000));
+  EXPECT_EQ (s.ToSet (), std::set<int> ({0, 64, 200}));
+}
+
+TEST (ParticipantSetTests, Merge)
+{
+  ParticipantSet a, b;
+  a.Insert (0);
+  a.Insert (70);
+  b.Insert (1);
+  b.Insert (100);
+  b.Insert (70);
+
+  a |= b;
+  EXPECT_EQ (a.ToSet (), std::set<int> ({0, 1, 70, 100}));
+  EXPECT_EQ (b.ToSet (), std::set<int> ({1, 70, 100}));
+}
+
+/* ************************************************************************** */
+
+/**
+ * Verifier that uses custom address keys:  Addresses are case-insensitive
+ * for it, and the recovered signers are given in upper case.
+ */
+class CaseInsensitiveVerifier : public SignatureVerifier
+{
+
+private:
+
+  static std::string
+  ToLower (std::string str)
+  {
+    for (auto& c : str)
+      if (c >= 'A' && c <= 'Z')
+        c = c - 'A' + 'a';
+    return str;
+  }
+
+public:
+
+  std::string
+  RecoverSigner (const std::string& msg, const std::string& sgn) const override
+  {
+    if (sgn == "sgn 0")
+      return "ADDRESS 0";
+    if (sgn == "sgn 1")
+      return "ADDRESS 1";
+    return "invalid";
+  }
+
+  std::string
+  GetAddressKey (const std::string& addr) const override
+  {
+    return ToLower (addr);
+  }
+
+  std::string
+  RecoverSignerKey (const std::string& msg,
+                    const std::string& sgn) const override
+  {
+    return ToLower (RecoverSigner (msg, sgn));
+  }
+
+};
+
+/* ************************************************************************** */
+
 class SignaturesTests : public TestGameFixture
 {
 
@@ -92,6 +186,28 @@ TEST_F (SignaturesTests, VerifyParticipantSignatures)
              std::set<int> ({1}));
 }
 
+TEST_F (SignaturesTests, VerifyWithParticipantKeys)
+{
+  proto::SignedData data;
+  data.set_data ("foobar");
+  data.add_signatures ("sgn 1");
+  data.add_signatures ("sgn 1");
+  data.add_signatures ("other");
+
+  const CaseInsensitiveVerifier ciVerifier;
+  const ParticipantKeys keys(ciVerifier, meta);
+  ASSERT_EQ (keys.size (), 2);
+  EXPECT_EQ (keys[0], "address 0");
+
+  const auto sigs
+      = VerifyParticipantSignatures (ciVerifier, keys, gameId, channelId, meta,
+                                     "topic", data);
+  EXPECT_EQ (sigs.ToSet (), std::set<int> ({1}));
+  EXPECT_EQ (VerifyParticipantSignatures (ciVerifier, gameId, channelId, meta,
+                                          "topic", data),
+             std::set<int> ({1}));
+}
+
 TEST_F (SignaturesTests, SignDataForParticipantError)
 {
   proto::SignedData data;
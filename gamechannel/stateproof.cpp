@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2022 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -7,7 +7,7 @@
 #include <glog/logging.h>
 
 #include <iterator>
-#include <set>
+#include <vector>
 
 namespace xaya
 {
@@ -15,6 +15,21 @@ namespace xaya
 namespace
 {
 
+/**
+ * Checks if a parsed state, whose encoded form is given as well, is equal
+ * to another encoded state.  If the game has a canonical encoding, then
+ * byte-identical data is treated as equal without parsing the other state.
+ */
+bool
+StateEquals (const BoardRules& rules, const ParsedBoardState& parsed,
+             const BoardState& encoded, const BoardState& other)
+{
+  if (rules.HasCanonicalEncoding () && encoded == other)
+    return true;
+
+  return parsed.Equals (other);
+}
+
 /**
  * Internal version of VerifyStateTransition, which also returns all valid
  * signatures made on the new state.  This is useful when validating a state
@@ -22,14 +37,15 @@ namespace
  */
 bool
 ExtraVerifyStateTransition (const SignatureVerifier& verifier,
+                            const ParticipantKeys& keys,
                             const BoardRules& rules,
                             const std::string& gameId,
                             const uint256& channelId,
                             const proto::ChannelMetadata& meta,
                             const ParsedBoardState& oldState,
                             const proto::StateTransition& transition,
-                            std::set<int>& signatures,
-                            std::unique_ptr<ParsedBoardState>& parsedNew)
+                            ParticipantSet& signatures,
+                            std::shared_ptr<const ParsedBoardState>& parsedNew)
 {
 
   const int turn = oldState.WhoseTurn ();
@@ -39,27 +55,32 @@ ExtraVerifyStateTransition (const SignatureVerifier& verifier,
       return false;
     }
 
-  BoardState newState;
-  if (!oldState.ApplyMove (transition.move (), newState))
+  BoardState applied;
+  if (!oldState.ApplyMove (transition.move (), applied))
     {
       LOG (WARNING) << "Failed to apply move of state transition";
       return false;
     }
 
-  parsedNew = rules.ParseState (channelId, meta, newState);
+  /* Move the new state into a shared buffer, so that the parsed state
+     can reference it if the game supports that.  */
+  const SharedBoardState newState(std::move (applied));
+  parsedNew = rules.ParseStateShared (channelId, meta, newState);
   /* newState is not user-provided but the output of a successful ApplyMove,
      so it should be guaranteed to be valid.  */
   CHECK (parsedNew != nullptr);
 
-  if (!parsedNew->Equals (transition.new_state ().data ()))
+  if (!StateEquals (rules, *parsedNew, newState,
+                    transition.new_state ().data ()))
     {
       LOG (WARNING) << "Wrong new state claimed in state transition";
       return false;
     }
 
-  signatures = VerifyParticipantSignatures (verifier, gameId, channelId, meta,
+  signatures = VerifyParticipantSignatures (verifier, keys,
+                                            gameId, channelId, meta,
                                             "state", transition.new_state ());
-  if (signatures.count (turn) == 0)
+  if (!signatures.Contains (turn))
     {
       LOG (WARNING)
           << "No valid signature of player " << turn << " on state transition";
@@ -69,6 +90,82 @@ ExtraVerifyStateTransition (const SignatureVerifier& verifier,
   return true;
 }
 
+/**
+ * One element of the "normalised" form of a state proof:  Either the initial
+ * state (with transition being null) or one of the state transitions.  The
+ * elements reference the proto data rather than holding copies of it.
+ */
+struct NormalisedTransition
+{
+
+  /** The signed state for this element.  */
+  const proto::SignedData* state;
+
+  /** The state transition, or null for the initial state.  */
+  const proto::StateTransition* transition;
+
+};
+
+/**
+ * "Normalises" all state transitions of a proof (including its initial
+ * state) into one array, where the first element is the proof's initial
+ * state.  The array references the data in the proof.
+ */
+std::vector<NormalisedTransition>
+NormaliseTransitions (const proto::StateProof& proof)
+{
+  std::vector<NormalisedTransition> transitions;
+  transitions.reserve (proof.transitions_size () + 1);
+  transitions.push_back ({&proof.initial_state (), nullptr});
+  for (const auto& t : proof.transitions ())
+    transitions.push_back ({&t.new_state (), &t});
+
+  return transitions;
+}
+
+/**
+ * Builds the "minimal" valid state proof from an array of normalised
+ * transitions, by finding the shortest trailing subset of it that
+ * has signatures by all participants.  If there is none, the full array
+ * is used (which is then valid only if it starts at the reinit state).
+ * Only the elements that end up in the result are copied.  The referenced
+ * data may be part of the result proto itself.
+ */
+void
+BuildMinimalProof (const SignatureVerifier& verifier,
+                   const ParticipantKeys& keys,
+                   const std::string& gameId,
+                   const uint256& channelId,
+                   const proto::ChannelMetadata& meta,
+                   const std::vector<NormalisedTransition>& transitions,
+                   proto::StateProof& proof)
+{
+  CHECK (!transitions.empty ());
+
+  ParticipantSet signatures;
+  auto begin = std::prev (transitions.end ());
+  const unsigned n = meta.participants_size ();
+  while (true)
+    {
+      signatures |= VerifyParticipantSignatures (verifier, keys,
+                                                 gameId, channelId, meta,
+                                                 "state", *begin->state);
+
+      CHECK_LE (signatures.Count (), n);
+      if (signatures.Count () == n || begin == transitions.begin ())
+        break;
+
+      --begin;
+    }
+
+  proto::StateProof res;
+  *res.mutable_initial_state () = *begin->state;
+  for (auto it = std::next (begin); it != transitions.end (); ++it)
+    *res.add_transitions () = *it->transition;
+
+  proof.Swap (&res);
+}
+
 } // anonymous namespace
 
 bool
@@ -80,16 +177,17 @@ VerifyStateTransition (const SignatureVerifier& verifier,
                        const BoardState& oldState,
                        const proto::StateTransition& transition)
 {
-  const auto parsedOld = rules.ParseState (channelId, meta, oldState);
+  const auto parsedOld = rules.ParseStateShared (channelId, meta, oldState);
   if (parsedOld == nullptr)
     {
       LOG (WARNING) << "Invalid old state in state transition";
       return false;
     }
 
-  std::unique_ptr<ParsedBoardState> parsedNew;
-  std::set<int> signatures;
-  return ExtraVerifyStateTransition (verifier, rules,
+  const ParticipantKeys keys(verifier, meta);
+  std::shared_ptr<const ParsedBoardState> parsedNew;
+  ParticipantSet signatures;
+  return ExtraVerifyStateTransition (verifier, keys, rules,
                                      gameId, channelId, meta, *parsedOld,
                                      transition, signatures, parsedNew);
 }
@@ -103,32 +201,68 @@ VerifyStateProof (const SignatureVerifier& verifier, const BoardRules& rules,
                   const proto::StateProof& proof,
                   BoardState& endState)
 {
-  std::set<int> signatures
-      = VerifyParticipantSignatures (verifier, gameId, channelId, meta,
+  if (!VerifyStateProof (verifier, rules, gameId, channelId, meta,
+                         reinitState, proof))
+    return false;
+
+  endState = UnverifiedProofEndState (proof);
+  return true;
+}
+
+bool
+VerifyStateProof (const SignatureVerifier& verifier, const BoardRules& rules,
+                  const std::string& gameId,
+                  const uint256& channelId,
+                  const proto::ChannelMetadata& meta,
+                  const BoardState& reinitState,
+                  const proto::StateProof& proof)
+{
+  /* The participant keys are computed once and then reused for checking
+     the signatures on all states of the proof.  */
+  const ParticipantKeys keys(verifier, meta);
+  return VerifyStateProof (verifier, keys, rules, gameId, channelId, meta,
+                           reinitState, proof);
+}
+
+bool
+VerifyStateProof (const SignatureVerifier& verifier,
+                  const ParticipantKeys& keys,
+                  const BoardRules& rules,
+                  const std::string& gameId,
+                  const uint256& channelId,
+                  const proto::ChannelMetadata& meta,
+                  const BoardState& reinitState,
+                  const proto::StateProof& proof)
+{
+  CHECK_EQ (keys.size (), meta.participants_size ());
+
+  ParticipantSet signatures
+      = VerifyParticipantSignatures (verifier, keys, gameId, channelId, meta,
                                      "state", proof.initial_state ());
 
-  auto parsed = rules.ParseState (channelId, meta,
-                                  proof.initial_state ().data ());
+  auto parsed = rules.ParseStateShared (channelId, meta,
+                                        proof.initial_state ().data ());
   if (parsed == nullptr)
     {
       LOG (WARNING) << "Invalid initial state for state proof";
       return false;
     }
 
-  endState = proof.initial_state ().data ();
-  const bool foundOnChain = parsed->Equals (reinitState);
+  const bool foundOnChain
+      = StateEquals (rules, *parsed, proof.initial_state ().data (),
+                     reinitState);
 
   for (const auto& t : proof.transitions ())
     {
-      std::unique_ptr<ParsedBoardState> parsedNew;
-      std::set<int> newSignatures;
-      if (!ExtraVerifyStateTransition (verifier, rules, gameId, channelId, meta,
+      std::shared_ptr<const ParsedBoardState> parsedNew;
+      ParticipantSet newSignatures;
+      if (!ExtraVerifyStateTransition (verifier, keys, rules,
+                                       gameId, channelId, meta,
                                        *parsed, t, newSignatures, parsedNew))
         return false;
 
-      signatures.insert (newSignatures.begin (), newSignatures.end ());
+      signatures |= newSignatures;
       parsed = std::move (parsedNew);
-      endState = t.new_state ().data ();
     }
 
   if (foundOnChain)
@@ -138,7 +272,7 @@ VerifyStateProof (const SignatureVerifier& verifier, const BoardRules& rules,
     }
 
   for (int i = 0; i < meta.participants_size (); ++i)
-    if (signatures.count (i) == 0)
+    if (!signatures.Contains (i))
       {
         LOG (WARNING) << "StateProof has no signature of player " << i;
         return false;
@@ -167,8 +301,27 @@ ExtendStateProof (const SignatureVerifier& verifier, SignatureSigner& signer,
                   const BoardMove& mv,
                   proto::StateProof& newProof)
 {
-  const BoardState oldState = UnverifiedProofEndState (oldProof);
-  const auto parsedOld = rules.ParseState (channelId, meta, oldState);
+  const ParticipantKeys keys(verifier, meta);
+  return ExtendStateProof (verifier, keys, signer, rules, gameId, channelId,
+                           meta, oldProof, mv, newProof);
+}
+
+bool
+ExtendStateProof (const SignatureVerifier& verifier,
+                  const ParticipantKeys& keys,
+                  SignatureSigner& signer,
+                  const BoardRules& rules,
+                  const std::string& gameId,
+                  const uint256& channelId,
+                  const proto::ChannelMetadata& meta,
+                  const proto::StateProof& oldProof,
+                  const BoardMove& mv,
+                  proto::StateProof& newProof)
+{
+  CHECK_EQ (keys.size (), meta.participants_size ());
+
+  const BoardState& oldState = UnverifiedProofEndState (oldProof);
+  const auto parsedOld = rules.ParseStateShared (channelId, meta, oldState);
   CHECK (parsedOld != nullptr) << "Invalid state-proof endstate: " << oldState;
 
   const int turn = parsedOld->WhoseTurn ();
@@ -188,7 +341,7 @@ ExtendStateProof (const SignatureVerifier& verifier, SignatureSigner& signer,
   proto::StateTransition trans;
   trans.set_move (mv);
   auto* ns = trans.mutable_new_state ();
-  ns->set_data (newState);
+  ns->set_data (std::move (newState));
 
   LOG (INFO) << "Trying to sign new state for participant " << turn;
   if (!SignDataForParticipant (signer, gameId, channelId, meta,
@@ -201,40 +354,44 @@ ExtendStateProof (const SignatureVerifier& verifier, SignatureSigner& signer,
      the new last transition) into one large array, and then find the
      trailing subset of it that is sufficient.  */
 
-  std::vector<proto::StateTransition> transitions;
-  transitions.emplace_back ();
-  *transitions.back ().mutable_new_state () = oldProof.initial_state ();
-  for (const auto& t : oldProof.transitions ())
-    transitions.push_back (t);
-  transitions.emplace_back (std::move (trans));
+  auto transitions = NormaliseTransitions (oldProof);
+  transitions.push_back ({&trans.new_state (), &trans});
+  BuildMinimalProof (verifier, keys, gameId, channelId, meta, transitions,
+                     newProof);
 
-  std::set<int> signatures;
-  auto begin = std::prev (transitions.end ());
-  const size_t n = meta.participants_size ();
-  while (true)
-    {
-      const auto newSigs
-          = VerifyParticipantSignatures (verifier, gameId, channelId, meta,
-                                         "state", begin->new_state ());
-      signatures.insert (newSigs.begin (), newSigs.end ());
+  return true;
+}
 
-      CHECK_LE (signatures.size (), n);
-      if (signatures.size () == n || begin == transitions.begin ())
-        break;
+void
+MinimiseStateProof (const SignatureVerifier& verifier,
+                    const std::string& gameId,
+                    const uint256& channelId,
+                    const proto::ChannelMetadata& meta,
+                    const proto::StateProof& proof,
+                    proto::StateProof& minimal)
+{
+  const ParticipantKeys keys(verifier, meta);
+  MinimiseStateProof (verifier, keys, gameId, channelId, meta, proof, minimal);
+}
 
-      --begin;
-    }
+void
+MinimiseStateProof (const SignatureVerifier& verifier,
+                    const ParticipantKeys& keys,
+                    const std::string& gameId,
+                    const uint256& channelId,
+                    const proto::ChannelMetadata& meta,
+                    const proto::StateProof& proof,
+                    proto::StateProof& minimal)
+{
+  CHECK_EQ (keys.size (), meta.participants_size ());
 
-  newProof.Clear ();
-  for (auto it = begin; it != transitions.end (); ++it)
-    {
-      if (it == begin)
-        newProof.mutable_initial_state ()->Swap (it->mutable_new_state ());
-      else
-        newProof.add_transitions ()->Swap (&*it);
-    }
+  const auto transitions = NormaliseTransitions (proof);
+  BuildMinimalProof (verifier, keys, gameId, channelId, meta, transitions,
+                     minimal);
 
-  return true;
+  VLOG (1)
+      << "Minimised state proof from " << proof.transitions_size ()
+      << " to " << minimal.transitions_size () << " transitions";
 }
 
 } // namespace xaya
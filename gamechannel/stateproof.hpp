@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2022 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -45,6 +45,33 @@ bool VerifyStateProof (const SignatureVerifier& verifier,
                        const proto::StateProof& proof,
                        BoardState& endState);
 
+/**
+ * Verifies a state proof like the other overload, but without copying
+ * out the resulting board state.  If the proof is valid, the end state
+ * can be accessed without a copy through UnverifiedProofEndState.
+ */
+bool VerifyStateProof (const SignatureVerifier& verifier,
+                       const BoardRules& rules,
+                       const std::string& gameId,
+                       const uint256& channelId,
+                       const proto::ChannelMetadata& meta,
+                       const BoardState& reinitState,
+                       const proto::StateProof& proof);
+
+/**
+ * Verifies a state proof like the overload above, but using already
+ * computed participant keys for the metadata.  This is useful for callers
+ * that verify many proofs for the same metadata.
+ */
+bool VerifyStateProof (const SignatureVerifier& verifier,
+                       const ParticipantKeys& keys,
+                       const BoardRules& rules,
+                       const std::string& gameId,
+                       const uint256& channelId,
+                       const proto::ChannelMetadata& meta,
+                       const BoardState& reinitState,
+                       const proto::StateProof& proof);
+
 /**
  * Extracts the endstate from a StateProof without checking it.  This is useful
  * if it has been checked already or is otherwise known to be good (e.g. because
@@ -74,6 +101,50 @@ bool ExtendStateProof (const SignatureVerifier& verifier,
                        const BoardMove& mv,
                        proto::StateProof& newProof);
 
+/**
+ * Extends a state proof like the other overload, but using already
+ * computed participant keys for the metadata.
+ */
+bool ExtendStateProof (const SignatureVerifier& verifier,
+                       const ParticipantKeys& keys,
+                       SignatureSigner& signer,
+                       const BoardRules& rules,
+                       const std::string& gameId,
+                       const uint256& channelId,
+                       const proto::ChannelMetadata& meta,
+                       const proto::StateProof& oldProof,
+                       const BoardMove& mv,
+                       proto::StateProof& newProof);
+
+/**
+ * Trims a state proof to the shortest trailing part of it that is still
+ * a valid proof on its own, i.e. in which every participant has signed
+ * at least one of the included states.  This is useful to keep dispute and
+ * resolution moves as small as possible.  If no such part exists (e.g. for
+ * a proof starting at the reinit state without signatures), then the full
+ * proof is returned.
+ *
+ * The input proof must be known to be valid already.
+ */
+void MinimiseStateProof (const SignatureVerifier& verifier,
+                         const std::string& gameId,
+                         const uint256& channelId,
+                         const proto::ChannelMetadata& meta,
+                         const proto::StateProof& proof,
+                         proto::StateProof& minimal);
+
+/**
+ * Minimises a state proof like the other overload, but using already
+ * computed participant keys for the metadata.
+ */
+void MinimiseStateProof (const SignatureVerifier& verifier,
+                         const ParticipantKeys& keys,
+                         const std::string& gameId,
+                         const uint256& channelId,
+                         const proto::ChannelMetadata& meta,
+                         const proto::StateProof& proof,
+                         proto::StateProof& minimal);
+
 } // namespace xaya
 
 #endif // GAMECHANNEL_STATEPROOF_HPP
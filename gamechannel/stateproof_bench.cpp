@@ -0,0 +1,66 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "stateproof.hpp"
+
+#include "benchutils.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <glog/logging.h>
+
+namespace xaya
+{
+namespace
+{
+
+/**
+ * Arguments for the state-proof benchmarks:  Proof length and number
+ * of participants.
+ */
+void
+ProofArgs (benchmark::internal::Benchmark* b)
+{
+  for (const int len : {1, 10, 50, 90})
+    for (const int participants : {2, 10})
+      b->Args ({len, participants});
+}
+
+void
+VerifyStateProof (benchmark::State& state)
+{
+  BenchChannel ch(state.range (1));
+  const auto proof = ch.BuildProof (state.range (0));
+
+  for (auto _ : state)
+    {
+      BoardState endState;
+      CHECK (VerifyStateProof (ch.verifier, ch.rules, ch.gameId, ch.channelId,
+                               ch.meta, ch.reinitState, proof, endState));
+      benchmark::DoNotOptimize (endState);
+    }
+  state.SetItemsProcessed (state.iterations () * proof.transitions_size ());
+}
+BENCHMARK (VerifyStateProof)->Apply (ProofArgs);
+
+void
+ExtendStateProof (benchmark::State& state)
+{
+  BenchChannel ch(state.range (1));
+  const auto proof = ch.BuildProof (state.range (0) - 1);
+  auto& signer = ch.GetSignerForTurn (proof);
+
+  for (auto _ : state)
+    {
+      proto::StateProof newProof;
+      CHECK (ExtendStateProof (ch.verifier, signer, ch.rules,
+                               ch.gameId, ch.channelId, ch.meta,
+                               proof, "1", newProof));
+      benchmark::DoNotOptimize (newProof);
+    }
+}
+BENCHMARK (ExtendStateProof)->Apply (ProofArgs);
+
+} // anonymous namespace
+} // namespace xaya
@@ -16,6 +16,8 @@
 
 #include <glog/logging.h>
 
+#include <memory>
+
 namespace xaya
 {
 namespace
@@ -167,6 +169,118 @@ TEST_F (StateTransitionTests, Valid)
   )"));
 }
 
+/**
+ * Parsed state that wraps a state of the test game, but never compares
+ * equal to anything.  This is used to check when the framework skips
+ * Equals for byte-identical states with a canonical encoding.
+ */
+class NeverEqualState : public ParsedBoardState
+{
+
+private:
+
+  std::unique_ptr<ParsedBoardState> inner;
+
+public:
+
+  explicit NeverEqualState (const BoardRules& r, const uint256& id,
+                            const proto::ChannelMetadata& m,
+                            std::unique_ptr<ParsedBoardState> i)
+    : ParsedBoardState(r, id, m), inner(std::move (i))
+  {}
+
+  bool
+  Equals (const BoardState& other) const override
+  {
+    return false;
+  }
+
+  int
+  WhoseTurn () const override
+  {
+    return inner->WhoseTurn ();
+  }
+
+  unsigned
+  TurnCount () const override
+  {
+    return inner->TurnCount ();
+  }
+
+  bool
+  ApplyMove (const BoardMove& mv, BoardState& newState) const override
+  {
+    return inner->ApplyMove (mv, newState);
+  }
+
+};
+
+/**
+ * Board rules for the test game using NeverEqualState and with a configurable
+ * flag for canonical encoding.
+ */
+class NeverEqualRules : public BoardRules
+{
+
+private:
+
+  AdditionRules base;
+
+public:
+
+  bool canonical = false;
+
+  std::unique_ptr<ParsedBoardState>
+  ParseState (const uint256& channelId, const proto::ChannelMetadata& meta,
+              const BoardState& s) const override
+  {
+    auto inner = base.ParseState (channelId, meta, s);
+    if (inner == nullptr)
+      return nullptr;
+
+    return std::make_unique<NeverEqualState> (*this, channelId, meta,
+                                              std::move (inner));
+  }
+
+  bool
+  HasCanonicalEncoding () const override
+  {
+    return canonical;
+  }
+
+  ChannelProtoVersion
+  GetProtoVersion (const proto::ChannelMetadata& meta) const override
+  {
+    return base.GetProtoVersion (meta);
+  }
+
+};
+
+TEST_F (StateTransitionTests, CanonicalEncoding)
+{
+  proto::StateTransition transition;
+  CHECK (TextFormat::ParseFromString (R"(
+    move: "1",
+    new_state:
+      {
+        data: "11 2"
+        signatures: "sgn0"
+      }
+  )", &transition));
+
+  NeverEqualRules rules;
+  EXPECT_FALSE (VerifyStateTransition (verifier, rules, gameId, channelId,
+                                       meta, "10 1", transition));
+
+  rules.canonical = true;
+  EXPECT_TRUE (VerifyStateTransition (verifier, rules, gameId, channelId,
+                                      meta, "10 1", transition));
+
+  transition.mutable_new_state ()->set_data (" 11 2 ");
+  EXPECT_FALSE (VerifyStateTransition (verifier, rules, gameId, channelId,
+                                       meta, "10 1", transition));
+}
+
 /* ************************************************************************** */
 
 class StateProofTests : public GeneralStateProofTests
@@ -247,6 +361,21 @@ TEST_F (StateProofTests, OnlyInitialOnChain)
   EXPECT_EQ (endState, "42 5");
 }
 
+TEST_F (StateProofTests, CanonicalReinitState)
+{
+  const auto proof = TextProof (R"(
+    initial_state: { data: "42 5" }
+  )");
+
+  NeverEqualRules rules;
+  EXPECT_FALSE (VerifyStateProof (verifier, rules, gameId, channelId, meta,
+                                  "42 5", proof, endState));
+
+  rules.canonical = true;
+  EXPECT_TRUE (VerifyStateProof (verifier, rules, gameId, channelId, meta,
+                                 "42 5", proof, endState));
+}
+
 TEST_F (StateProofTests, OnlyInitialSigned)
 {
   verifier.ExpectOne (gameId, channelId, meta, "state",
@@ -381,6 +510,40 @@ TEST_F (StateProofTests, MultiSignedLaterState)
   EXPECT_EQ (endState, "43 6");
 }
 
+TEST_F (StateProofTests, PrecomputedKeys)
+{
+  const ParticipantKeys keys(verifier, meta);
+
+  const auto valid = TextProof (R"(
+    initial_state:
+      {
+        data: "42 5"
+      }
+    transitions:
+      {
+        move: "1"
+        new_state:
+          {
+            data: "43 6"
+            signatures: "sgn0"
+            signatures: "sgn1"
+          }
+      }
+  )");
+  EXPECT_TRUE (VerifyStateProof (verifier, keys, game.rules, gameId, channelId,
+                                 meta, "0 1", valid));
+
+  const auto missing = TextProof (R"(
+    initial_state:
+      {
+        data: "42 5"
+        signatures: "sgn0"
+      }
+  )");
+  EXPECT_FALSE (VerifyStateProof (verifier, keys, game.rules, gameId,
+                                  channelId, meta, "0 1", missing));
+}
+
 /* ************************************************************************** */
 
 using UnverifiedProofEndStateTests = testing::Test;
@@ -554,5 +717,137 @@ TEST_F (ExtendStateProofTests, Valid)
 
 /* ************************************************************************** */
 
+class MinimiseStateProofTests : public GeneralStateProofTests
+{
+
+protected:
+
+  proto::StateProof minimal;
+
+  /**
+   * Minimises the given proof and returns the number of transitions
+   * in the result.  Also verifies that the result is still a valid proof
+   * for the same end state.
+   */
+  int
+  Minimise (const std::string& proof)
+  {
+    const auto input = TextProof (proof);
+    MinimiseStateProof (verifier, gameId, channelId, meta, input, minimal);
+
+    BoardState inputState, minimalState;
+    CHECK (VerifyStateProof (verifier, game.rules, gameId, channelId, meta,
+                             "0 0", input, inputState));
+    CHECK (VerifyStateProof (verifier, game.rules, gameId, channelId, meta,
+                             "0 0", minimal, minimalState));
+    EXPECT_EQ (inputState, minimalState);
+
+    return minimal.transitions_size ();
+  }
+
+};
+
+TEST_F (MinimiseStateProofTests, AlreadyMinimal)
+{
+  EXPECT_EQ (Minimise (R"(
+    initial_state:
+      {
+        data: "10 2"
+        signatures: "sgn1"
+      }
+    transitions:
+      {
+        move: "4"
+        new_state:
+          {
+            data: "14 3"
+            signatures: "sgn0"
+          }
+      }
+  )"), 1);
+  EXPECT_EQ (minimal.initial_state ().data (), "10 2");
+}
+
+TEST_F (MinimiseStateProofTests, FromReinit)
+{
+  EXPECT_EQ (Minimise (R"(
+    initial_state: { data: "0 0" }
+    transitions:
+      {
+        move: "42"
+        new_state:
+          {
+            data: "42 1"
+            signatures: "sgn0"
+          }
+      }
+  )"), 1);
+}
+
+TEST_F (MinimiseStateProofTests, DropsPrefix)
+{
+  EXPECT_EQ (Minimise (R"(
+    initial_state:
+      {
+        data: "10 2"
+        signatures: "sgn0"
+        signatures: "sgn1"
+      }
+    transitions:
+      {
+        move: "1"
+        new_state:
+          {
+            data: "11 3"
+            signatures: "sgn0"
+          }
+      }
+    transitions:
+      {
+        move: "2"
+        new_state:
+          {
+            data: "13 4"
+            signatures: "sgn1"
+          }
+      }
+    transitions:
+      {
+        move: "3"
+        new_state:
+          {
+            data: "16 5"
+            signatures: "sgn1"
+          }
+      }
+  )"), 2);
+  EXPECT_EQ (minimal.initial_state ().data (), "11 3");
+  EXPECT_EQ (minimal.transitions (1).new_state ().data (), "16 5");
+}
+
+TEST_F (MinimiseStateProofTests, FullySignedEndState)
+{
+  EXPECT_EQ (Minimise (R"(
+    initial_state:
+      {
+        data: "10 2"
+        signatures: "sgn0"
+      }
+    transitions:
+      {
+        move: "1"
+        new_state:
+          {
+            data: "11 3"
+            signatures: "sgn0"
+            signatures: "sgn1"
+          }
+      }
+  )"), 0);
+  EXPECT_EQ (minimal.initial_state ().data (), "11 3");
+}
+
+/* ************************************************************************** */
+
 } // anonymous namespace
 } // namespace xaya
@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+# Copyright (C) 2026 The Xaya developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+"""
+Integration test for the native relay server (rpc-channel-relay).  This
+starts the server and runs the same scenario as test_rpcbroadcast against
+it, using a minimal Python version of the RpcBroadcast client (so that it
+does not depend on the C++ client).
+"""
+
+import hashlib
+import http.client
+import json
+import os
+import os.path
+import socket
+import subprocess
+import sys
+import threading
+import time
+
+
+PORT = 32501
+RECEIVE_TIMEOUT_MS = 100
+
+
+def waitForServer (port, timeout=10):
+  """
+  Waits until the server accepts connections on the given port.
+  """
+
+  end = time.time () + timeout
+  while time.time () < end:
+    try:
+      with socket.create_connection (("localhost", port), timeout=1):
+        return
+    except OSError:
+      time.sleep (0.1)
+
+  raise RuntimeError ("relay server did not start")
+
+
+def call (method, **params):
+  """
+  Performs a JSON-RPC call to the server and returns the result.
+  """
+
+  conn = http.client.HTTPConnection ("localhost", PORT, timeout=10)
+  try:
+    body = json.dumps ({
+      "jsonrpc": "2.0",
+      "id": 1,
+      "method": method,
+      "params": params,
+    })
+    conn.request ("POST", "/", body, {"Content-Type": "application/json"})
+    resp = json.loads (conn.getresponse ().read ())
+  finally:
+    conn.close ()
+
+  if "error" in resp:
+    raise RuntimeError ("RPC error: %s" % resp["error"])
+  return resp["result"]
+
+
+class TestBroadcast (threading.Thread):
+  """
+  Broadcast client for one channel, like RpcBroadcast in C++.  It starts
+  at the current sequence number of the channel, and records all messages
+  received after that in a background thread.
+  """
+
+  def __init__ (self, channel):
+    super ().__init__ ()
+    self.channel = hashlib.sha256 (channel.encode ()).hexdigest ()
+    self.seq = call ("getseq", channel=self.channel)["seq"]
+    self.messages = []
+    self.cv = threading.Condition ()
+    self.stopped = False
+    self.start ()
+
+  def run (self):
+    while not self.stopped:
+      res = call ("receive", channel=self.channel, fromseq=self.seq)
+      with self.cv:
+        self.messages.extend (res["messages"])
+        self.seq = res["seq"]
+        self.cv.notify_all ()
+
+  def stop (self):
+    self.stopped = True
+    self.join ()
+    assert self.messages == [], "Unexpected messages: %s" % self.messages
+
+  def send (self, msg):
+    call ("send", channel=self.channel, message=msg)
+
+  def expectResult (self, expected):
+    with self.cv:
+      ok = self.cv.wait_for (lambda: len (self.messages) >= len (expected),
+                             timeout=10)
+      assert ok, "Timeout waiting for %s" % expected
+      assert self.messages == expected, \
+          "Expected %s, got %s" % (expected, self.messages)
+      self.messages = []
+
+
+def testBroadcast ():
+  """
+  Runs the scenario of test_rpcbroadcast.
+  """
+
+  bc1 = TestBroadcast ("channel 1")
+  bc1.send ("foo")
+  bc1.expectResult (["foo"])
+
+  bc2 = TestBroadcast ("channel 2")
+  bc2.send ("bar")
+  bc2.expectResult (["bar"])
+
+  bc1.send ("baz")
+  bc3 = TestBroadcast ("channel 1")
+  bc3.send ("abc")
+  bc1.expectResult (["baz", "abc"])
+  bc3.expectResult (["abc"])
+
+  weird = "abc\0defÿ"
+  bc2.send (weird)
+  bc2.expectResult ([weird])
+
+  for bc in [bc1, bc2, bc3]:
+    bc.stop ()
+
+
+def testPipelinedFlood ():
+  """
+  Parks a connection in a waiting receive and then pipelines a lot of data
+  after it.  The server must not buffer all of it, and should stay
+  responsive to other clients.
+  """
+
+  channel = hashlib.sha256 (b"flood").hexdigest ()
+  body = json.dumps ({
+    "jsonrpc": "2.0",
+    "id": 1,
+    "method": "receive",
+    "params": {"channel": channel, "fromseq": 0},
+  }).encode ()
+  req = b"POST / HTTP/1.1\r\nContent-Length: %d\r\n\r\n" % len (body) + body
+
+  with socket.create_connection (("localhost", PORT)) as sock:
+    sock.sendall (req)
+    sock.settimeout (2)
+    flood = b"x" * (1 << 20)
+    sent = 0
+    try:
+      for _ in range (64):
+        sock.sendall (flood)
+        sent += len (flood)
+    except OSError:
+      # The server may also close the connection after answering the
+      # receive, when it finds the pipelined data invalid.
+      pass
+    assert sent < 64 * len (flood), "server accepted all pipelined data"
+
+    assert call ("getseq", channel=channel)["seq"] == 0
+
+
+if __name__ == "__main__":
+  builddir = os.getenv ("builddir")
+  if builddir is None:
+    builddir = "."
+
+  serverbin = os.path.join (builddir, "rpc-channel-relay")
+  server = subprocess.Popen ([
+    serverbin,
+    "--port=%d" % PORT,
+    "--receive_timeout_ms=%d" % RECEIVE_TIMEOUT_MS,
+  ])
+
+  try:
+    waitForServer (PORT)
+    testBroadcast ()
+    testPipelinedFlood ()
+  finally:
+    server.terminate ()
+    server.wait ()
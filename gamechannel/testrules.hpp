@@ -0,0 +1,104 @@
+// Copyright (C) 2019-2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+/* The board rules of the trivial addition game used in tests.  They are
+   kept separate from testgame.hpp (which depends on xayagame and gtest),
+   so that they can also be used in benchmarks.  */
+
+#ifndef GAMECHANNEL_TESTRULES_HPP
+#define GAMECHANNEL_TESTRULES_HPP
+
+#include "boardrules.hpp"
+#include "movesender.hpp"
+#include "openchannel.hpp"
+
+#include "proto/metadata.pb.h"
+#include "proto/stateproof.pb.h"
+
+#include <xayautil/uint256.hpp>
+
+#include <json/json.h>
+
+#include <memory>
+
+namespace xaya
+{
+
+/**
+ * Board rules for a trivial example game used in unit tests and
+ * benchmarks.  The game goes like this:
+ *
+ * The current state is a pair of numbers, encoded simply in a string.  Those
+ * numbers are a "current number" and the turn count.  The current
+ * turn is for player (number % 2).  When the number is 100 or above, then
+ * the game is finished.  A move is simply another, strictly positive number
+ * encoded as a string, which gets added to the current "state number".
+ * The turn count is simply incremented on each turn made.
+ */
+class AdditionRules : public BoardRules
+{
+
+public:
+
+  std::unique_ptr<ParsedBoardState> ParseState (
+      const uint256& channelId, const proto::ChannelMetadata& meta,
+      const BoardState& s) const override;
+
+  ChannelProtoVersion GetProtoVersion (
+      const proto::ChannelMetadata& meta) const override;
+
+};
+
+/**
+ * OpenChannel implementation for our test game.
+ */
+class AdditionChannel : public OpenChannel
+{
+
+private:
+
+  /** If set, then automoves will be processed.  */
+  bool automovesEnabled = true;
+
+public:
+
+  Json::Value ResolutionMove (const uint256& channelId,
+                              const proto::StateProof& proof) const override;
+
+  Json::Value DisputeMove (const uint256& channelId,
+                           const proto::StateProof& proof) const override;
+
+  /**
+   * When the last digit of the current number in the addition game is 6-9,
+   * we apply an automove of +2.  This way, we can test both a situation
+   * where just one automove is applied (8 -> 10) and one where
+   * two moves in a row are automatic (6 -> 8 -> 10).
+   */
+  bool MaybeAutoMove (const ParsedBoardState& state, BoardMove& mv) override;
+
+  /**
+   * If the state reached exactly 100, then we send an on-chain move (that
+   * is just a string "100").  This can be triggered through auto-moves as well.
+   */
+  void MaybeOnChainMove (const ParsedBoardState& state,
+                         MoveSender& sender) override;
+
+  /**
+   * Enables or disables processing of automoves.  When they are disabled,
+   * then MaybeAutoMove will always return false, independent of the current
+   * state.  This can be used to simulate situations in real games where
+   * automoves may become possible for some situation only after user input
+   * of some data (but not the move itself).
+   */
+  void
+  SetAutomovesEnabled (const bool val)
+  {
+    automovesEnabled = val;
+  }
+
+};
+
+} // namespace xaya
+
+#endif // GAMECHANNEL_TESTRULES_HPP
@@ -0,0 +1,224 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "transactionqueue.hpp"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+namespace xaya
+{
+
+TransactionQueue::TransactionQueue (TransactionSender& s)
+  : TransactionQueue(s, Options ())
+{}
+
+TransactionQueue::TransactionQueue (TransactionSender& s, const Options& o)
+  : sender(s), options(o)
+{
+  CHECK_GT (options.maxAttempts, 0);
+  worker = std::thread ([this] () { RunWorker (); });
+}
+
+TransactionQueue::~TransactionQueue ()
+{
+  {
+    std::lock_guard<std::mutex> lock(mut);
+    shouldStop = true;
+    cv.notify_all ();
+  }
+  worker.join ();
+
+  LOG_IF (WARNING, !entries.empty ())
+      << "Dropping " << entries.size () << " unsent moves from the queue";
+
+  uint256 nullTxid;
+  nullTxid.SetNull ();
+  for (auto& e : entries)
+    Resolve (e, nullTxid);
+}
+
+std::deque<TransactionQueue::Entry>::iterator
+TransactionQueue::FindKey (const std::string& key)
+{
+  if (key.empty ())
+    return entries.end ();
+
+  return std::find_if (entries.begin (), entries.end (),
+                       [&key] (const Entry& e) { return e.key == key; });
+}
+
+void
+TransactionQueue::Resolve (Entry& e, const uint256& txid)
+{
+  for (auto& p : e.promises)
+    p.set_value (txid);
+  e.promises.clear ();
+}
+
+std::shared_future<uint256>
+TransactionQueue::Submit (const std::string& name, const std::string& value,
+                          const std::string& key, const bool urgent)
+{
+  std::lock_guard<std::mutex> lock(mut);
+
+  auto it = FindKey (key);
+  if (it != entries.end ())
+    {
+      VLOG (1) << "Replacing queued move with key " << key;
+      it->name = name;
+      it->value = value;
+      it->attempts = 0;
+      it->urgent = it->urgent || urgent;
+      it->notBefore = std::min (it->notBefore, Clock::now ());
+      ++stats.replaced;
+      cv.notify_all ();
+      return it->future;
+    }
+
+  Entry e;
+  e.key = key;
+  e.name = name;
+  e.value = value;
+  e.promises.emplace_back ();
+  e.future = e.promises.back ().get_future ().share ();
+  e.submitted = Clock::now ();
+  e.notBefore = e.submitted;
+  e.urgent = urgent;
+
+  auto res = e.future;
+  entries.push_back (std::move (e));
+  cv.notify_all ();
+
+  return res;
+}
+
+size_t
+TransactionQueue::GetQueueSize () const
+{
+  std::lock_guard<std::mutex> lock(mut);
+  return entries.size ();
+}
+
+TransactionQueue::Stats
+TransactionQueue::GetStats () const
+{
+  std::lock_guard<std::mutex> lock(mut);
+  return stats;
+}
+
+void
+TransactionQueue::FinishAttempt (Entry&& e, const uint256& txid)
+{
+  const auto now = Clock::now ();
+
+  if (!txid.IsNull ())
+    {
+      using std::chrono::microseconds;
+      const auto latency
+          = std::chrono::duration_cast<microseconds> (now - e.submitted);
+      ++stats.sent;
+      stats.totalLatency += latency;
+      stats.maxLatency = std::max (stats.maxLatency, latency);
+
+      LOG (INFO)
+          << "Sent move " << txid.ToHex ()
+          << " after " << e.attempts << " attempts, latency "
+          << latency.count () << " us";
+      Resolve (e, txid);
+      return;
+    }
+
+  /* If a newer move with the same key has been queued while this one
+     was in-flight, then we drop this one and let its waiters get the
+     result of the newer move instead.  */
+  auto newer = FindKey (e.key);
+  if (newer != entries.end ())
+    {
+      VLOG (1) << "Failed move superseded by newer one with key " << e.key;
+      for (auto& p : e.promises)
+        newer->promises.push_back (std::move (p));
+      return;
+    }
+
+  if (e.attempts >= options.maxAttempts)
+    {
+      LOG (ERROR)
+          << "Giving up on sending move after " << e.attempts << " attempts";
+      ++stats.failed;
+      Resolve (e, txid);
+      return;
+    }
+
+  auto backoff = options.initialBackoff;
+  for (unsigned i = 1; i < e.attempts && backoff < options.maxBackoff; ++i)
+    backoff *= 2;
+  backoff = std::min (backoff, options.maxBackoff);
+
+  LOG (WARNING)
+      << "Sending move failed, retrying in " << backoff.count () << " ms";
+  ++stats.retries;
+  e.notBefore = now + backoff;
+  entries.push_back (std::move (e));
+}
+
+void
+TransactionQueue::RunWorker ()
+{
+  std::unique_lock<std::mutex> lock(mut);
+  while (!shouldStop)
+    {
+      if (entries.empty ())
+        {
+          cv.wait (lock);
+          continue;
+        }
+
+      /* Among the moves that are ready to be sent, urgent ones go first.
+         Otherwise (and between urgent moves) the one that has been ready
+         for the longest time is chosen.  If no move is ready, we wait
+         for the earliest one.  */
+      const auto now = Clock::now ();
+      auto earliest = entries.begin ();
+      auto it = entries.end ();
+      for (auto cur = entries.begin (); cur != entries.end (); ++cur)
+        {
+          if (cur->notBefore < earliest->notBefore)
+            earliest = cur;
+          if (cur->notBefore > now)
+            continue;
+          if (it == entries.end () || (cur->urgent && !it->urgent)
+                || (cur->urgent == it->urgent
+                      && cur->notBefore < it->notBefore))
+            it = cur;
+        }
+      if (it == entries.end ())
+        {
+          cv.wait_until (lock, earliest->notBefore);
+          continue;
+        }
+
+      Entry e = std::move (*it);
+      entries.erase (it);
+      ++e.attempts;
+
+      lock.unlock ();
+      uint256 txid;
+      try
+        {
+          txid = sender.SendRawMove (e.name, e.value);
+        }
+      catch (const std::exception& exc)
+        {
+          LOG (ERROR) << "Sending queued move failed: " << exc.what ();
+          txid.SetNull ();
+        }
+      lock.lock ();
+
+      FinishAttempt (std::move (e), txid);
+    }
+}
+
+} // namespace xaya
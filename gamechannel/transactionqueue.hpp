@@ -0,0 +1,240 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GAMECHANNEL_TRANSACTIONQUEUE_HPP
+#define GAMECHANNEL_TRANSACTIONQUEUE_HPP
+
+#include "movesender.hpp"
+
+#include <xayautil/uint256.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xaya
+{
+
+/**
+ * Queue for sending moves through a TransactionSender asynchronously
+ * on a background thread.  Submitting a move returns immediately with
+ * a future for the eventual txid, so that callers (e.g. ChannelManager
+ * when resolving disputes) do not block on the latency of the wallet.
+ *
+ * If sending fails (the underlying sender throws or returns a null txid),
+ * the move is retried with exponential backoff up to a configured number
+ * of attempts.  When all attempts fail, the future resolves to null.
+ *
+ * Moves can be submitted with a deduplication key.  If another move with the
+ * same key is still waiting in the queue (i.e. it has not been handed to the
+ * TransactionSender yet), then the new move replaces it and both callers
+ * share the same future.  This is used so that a resolution with a newer
+ * state proof supersedes an older one that was not sent yet.
+ *
+ * Moves can also be marked as urgent (which is done for dispute resolutions).
+ * Urgent moves that are ready to be sent go before all other moves, in the
+ * order in which they were submitted.  This way, routine game moves do not
+ * delay resolutions of disputes that are about to expire.
+ *
+ * The underlying TransactionSender is invoked from the queue's worker
+ * thread, so it must be safe to call it from there concurrently with
+ * IsPending calls from the thread using the queue.
+ */
+class TransactionQueue
+{
+
+public:
+
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * Configuration options for the retry behaviour.
+   */
+  struct Options
+  {
+
+    /** Maximum number of attempts for sending a single move.  */
+    unsigned maxAttempts = 5;
+
+    /** Delay before the first retry of a failed move.  */
+    std::chrono::milliseconds initialBackoff{500};
+
+    /** Upper bound for the delay between retries.  */
+    std::chrono::milliseconds maxBackoff{30'000};
+
+  };
+
+  /**
+   * Statistics about the moves processed by the queue.
+   */
+  struct Stats
+  {
+
+    /** Number of moves sent successfully.  */
+    unsigned sent = 0;
+
+    /** Number of moves that were given up after all attempts failed.  */
+    unsigned failed = 0;
+
+    /** Number of failed attempts that were retried later.  */
+    unsigned retries = 0;
+
+    /** Number of queued moves replaced by a newer one with the same key.  */
+    unsigned replaced = 0;
+
+    /**
+     * Sum of the submission latencies of all successfully sent moves,
+     * measured from the first submission to the txid being known.
+     */
+    std::chrono::microseconds totalLatency{0};
+
+    /** Maximum submission latency of any move sent.  */
+    std::chrono::microseconds maxLatency{0};
+
+  };
+
+private:
+
+  /**
+   * A move that is waiting to be sent (either for the first time or
+   * for a retry).
+   */
+  struct Entry
+  {
+
+    /** The deduplication key (may be empty for none).  */
+    std::string key;
+
+    /** The name to send the move with.  */
+    std::string name;
+
+    /** The raw move value.  */
+    std::string value;
+
+    /**
+     * Promises to fulfil with the txid.  There can be more than one if an
+     * entry that was in-flight failed and got merged into a newer one with
+     * the same key.
+     */
+    std::vector<std::promise<uint256>> promises;
+
+    /** The future corresponding to the first promise.  */
+    std::shared_future<uint256> future;
+
+    /** Time when the move was first submitted.  */
+    Clock::time_point submitted;
+
+    /** Earliest time at which the next attempt may be done.  */
+    Clock::time_point notBefore;
+
+    /** Number of attempts made already.  */
+    unsigned attempts = 0;
+
+    /** Whether this move should be sent before non-urgent ones.  */
+    bool urgent = false;
+
+  };
+
+  /** The underlying transaction sender.  */
+  TransactionSender& sender;
+
+  /** The configured options.  */
+  const Options options;
+
+  /** Lock for the internal state.  */
+  mutable std::mutex mut;
+
+  /** Condition variable signalled when the queue changes.  */
+  std::condition_variable cv;
+
+  /** The queued entries, in order of submission.  */
+  std::deque<Entry> entries;
+
+  /** Statistics collected so far.  */
+  Stats stats;
+
+  /** Set to true when the worker should shut down.  */
+  bool shouldStop = false;
+
+  /** The background thread sending the moves.  */
+  std::thread worker;
+
+  /**
+   * Returns an iterator to the queued entry with the given key, or end()
+   * if there is none.  Must be called with mut locked.
+   */
+  std::deque<Entry>::iterator FindKey (const std::string& key);
+
+  /**
+   * Fulfils all promises of the given entry with the given txid.
+   */
+  static void Resolve (Entry& e, const uint256& txid);
+
+  /**
+   * Processes the result of an attempt to send the given entry.  Must be
+   * called with mut locked.
+   */
+  void FinishAttempt (Entry&& e, const uint256& txid);
+
+  /**
+   * Main loop of the worker thread.
+   */
+  void RunWorker ();
+
+public:
+
+  explicit TransactionQueue (TransactionSender& s);
+  explicit TransactionQueue (TransactionSender& s, const Options& o);
+
+  /**
+   * Stops the worker thread.  Moves that are still queued at this point
+   * are not sent, and their futures resolve to null.
+   */
+  ~TransactionQueue ();
+
+  TransactionQueue () = delete;
+  TransactionQueue (const TransactionQueue&) = delete;
+  void operator= (const TransactionQueue&) = delete;
+
+  /**
+   * Queues a move for sending, and returns a future for its txid.  If key
+   * is non-empty and another move with the same key is still waiting
+   * in the queue, then it is replaced by this one.  If urgent is true,
+   * the move is sent before all queued non-urgent moves.
+   */
+  std::shared_future<uint256> Submit (const std::string& name,
+                                      const std::string& value,
+                                      const std::string& key = "",
+                                      bool urgent = false);
+
+  /**
+   * Returns the number of moves currently waiting in the queue.
+   */
+  size_t GetQueueSize () const;
+
+  /**
+   * Returns a snapshot of the statistics.
+   */
+  Stats GetStats () const;
+
+  /**
+   * Checks if the given transaction is pending, using the underlying
+   * TransactionSender.
+   */
+  bool
+  IsPending (const uint256& txid) const
+  {
+    return sender.IsPending (txid);
+  }
+
+};
+
+} // namespace xaya
+
+#endif // GAMECHANNEL_TRANSACTIONQUEUE_HPP
@@ -0,0 +1,248 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "transactionqueue.hpp"
+
+#include "testutils.hpp"
+
+#include <xayautil/hash.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <glog/logging.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace xaya
+{
+namespace
+{
+
+using testing::_;
+using testing::ElementsAre;
+using testing::InSequence;
+using testing::Return;
+
+/**
+ * TransactionSender that blocks in SendRawMove until it is released
+ * explicitly.  This allows tests to control what is still queued.
+ */
+class BlockingSender : public TransactionSender
+{
+
+private:
+
+  std::mutex mut;
+  std::condition_variable cv;
+
+  /** Number of calls that may go through without blocking.  */
+  unsigned allowed = 0;
+
+  /** The values that have been sent.  */
+  std::vector<std::string> sent;
+
+public:
+
+  const uint256 txid = SHA256::Hash ("txid");
+
+  uint256
+  SendRawMove (const std::string& name, const std::string& value) override
+  {
+    std::unique_lock<std::mutex> lock(mut);
+    sent.push_back (value);
+    cv.notify_all ();
+    while (allowed == 0)
+      cv.wait (lock);
+    --allowed;
+    return txid;
+  }
+
+  bool
+  IsPending (const uint256& id) const override
+  {
+    return false;
+  }
+
+  /**
+   * Waits until n moves have been passed to SendRawMove.
+   */
+  void
+  WaitForCalls (const unsigned n)
+  {
+    std::unique_lock<std::mutex> lock(mut);
+    while (sent.size () < n)
+      cv.wait (lock);
+  }
+
+  /**
+   * Allows n more calls to return.
+   */
+  void
+  Release (const unsigned n)
+  {
+    std::lock_guard<std::mutex> lock(mut);
+    allowed += n;
+    cv.notify_all ();
+  }
+
+  std::vector<std::string>
+  GetSent ()
+  {
+    std::lock_guard<std::mutex> lock(mut);
+    return sent;
+  }
+
+};
+
+class TransactionQueueTests : public testing::Test
+{
+
+protected:
+
+  MockTransactionSender txSender;
+  TransactionQueue::Options options;
+
+  TransactionQueueTests ()
+  {
+    options.maxAttempts = 3;
+    options.initialBackoff = std::chrono::milliseconds (1);
+    options.maxBackoff = std::chrono::milliseconds (5);
+  }
+
+};
+
+TEST_F (TransactionQueueTests, Success)
+{
+  const uint256 txid = txSender.ExpectSuccess ("name", "value");
+
+  TransactionQueue queue(txSender, options);
+  EXPECT_EQ (queue.Submit ("name", "value").get (), txid);
+  EXPECT_TRUE (queue.IsPending (txid));
+
+  const auto stats = queue.GetStats ();
+  EXPECT_EQ (stats.sent, 1);
+  EXPECT_EQ (stats.failed, 0);
+  EXPECT_EQ (stats.retries, 0);
+  EXPECT_EQ (stats.maxLatency, stats.totalLatency);
+}
+
+TEST_F (TransactionQueueTests, RetriesAfterFailure)
+{
+  uint256 txid;
+  {
+    InSequence seq;
+    txSender.ExpectFailure ("name", "value");
+    txid = txSender.ExpectSuccess ("name", "value");
+  }
+
+  TransactionQueue queue(txSender, options);
+  EXPECT_EQ (queue.Submit ("name", "value").get (), txid);
+
+  const auto stats = queue.GetStats ();
+  EXPECT_EQ (stats.sent, 1);
+  EXPECT_EQ (stats.retries, 1);
+}
+
+TEST_F (TransactionQueueTests, NullTxidIsRetried)
+{
+  uint256 nullTxid;
+  nullTxid.SetNull ();
+
+  uint256 txid;
+  {
+    InSequence seq;
+    EXPECT_CALL (txSender, SendRawMove ("name", "value"))
+        .WillOnce (Return (nullTxid));
+    txid = txSender.ExpectSuccess ("name", "value");
+  }
+
+  TransactionQueue queue(txSender, options);
+  EXPECT_EQ (queue.Submit ("name", "value").get (), txid);
+}
+
+TEST_F (TransactionQueueTests, GivesUp)
+{
+  EXPECT_CALL (txSender, SendRawMove ("name", "value"))
+      .Times (options.maxAttempts)
+      .WillRepeatedly (testing::Throw (std::runtime_error ("error")));
+
+  TransactionQueue queue(txSender, options);
+  EXPECT_TRUE (queue.Submit ("name", "value").get ().IsNull ());
+
+  const auto stats = queue.GetStats ();
+  EXPECT_EQ (stats.sent, 0);
+  EXPECT_EQ (stats.failed, 1);
+  EXPECT_EQ (stats.retries, options.maxAttempts - 1);
+}
+
+TEST_F (TransactionQueueTests, ReplacesQueuedMove)
+{
+  BlockingSender sender;
+  TransactionQueue queue(sender, options);
+
+  /* The first move gets picked up by the worker and blocks there, so that
+     the following ones stay in the queue.  */
+  auto first = queue.Submit ("name", "first");
+  sender.WaitForCalls (1);
+
+  auto old = queue.Submit ("name", "old", "key");
+  auto other = queue.Submit ("name", "other", "other key");
+  auto updated = queue.Submit ("name", "new", "key");
+  EXPECT_EQ (queue.GetQueueSize (), 2);
+
+  sender.Release (3);
+  EXPECT_EQ (first.get (), sender.txid);
+  EXPECT_EQ (old.get (), sender.txid);
+  EXPECT_EQ (updated.get (), sender.txid);
+  EXPECT_EQ (other.get (), sender.txid);
+
+  EXPECT_THAT (sender.GetSent (), ElementsAre ("first", "new", "other"));
+  EXPECT_EQ (queue.GetStats ().replaced, 1);
+}
+
+TEST_F (TransactionQueueTests, InFlightMoveIsNotReplaced)
+{
+  BlockingSender sender;
+  TransactionQueue queue(sender, options);
+
+  auto first = queue.Submit ("name", "first", "key");
+  sender.WaitForCalls (1);
+  auto second = queue.Submit ("name", "second", "key");
+
+  sender.Release (2);
+  EXPECT_EQ (first.get (), sender.txid);
+  EXPECT_EQ (second.get (), sender.txid);
+
+  EXPECT_THAT (sender.GetSent (), ElementsAre ("first", "second"));
+  EXPECT_EQ (queue.GetStats ().replaced, 0);
+}
+
+TEST_F (TransactionQueueTests, UrgentMovesFirst)
+{
+  BlockingSender sender;
+  TransactionQueue queue(sender, options);
+
+  auto first = queue.Submit ("name", "first");
+  sender.WaitForCalls (1);
+
+  auto normal = queue.Submit ("name", "normal");
+  auto urgent1 = queue.Submit ("name", "urgent 1", "", true);
+  auto other = queue.Submit ("name", "other", "key");
+  auto urgent2 = queue.Submit ("name", "urgent 2", "", true);
+  auto upgraded = queue.Submit ("name", "upgraded", "key", true);
+
+  sender.Release (5);
+  for (auto* f : {&first, &normal, &urgent1, &upgraded, &urgent2})
+    EXPECT_EQ (f->get (), sender.txid);
+
+  EXPECT_THAT (sender.GetSent (),
+               ElementsAre ("first", "urgent 1", "upgraded", "urgent 2",
+                            "normal"));
+}
+
+} // anonymous namespace
+} // namespace xaya
@@ -1,106 +1,508 @@
-// Copyright (C) 2019-2020 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "base64.hpp"
 
-#include <openssl/evp.h>
-
 #include <glog/logging.h>
 
-#include <cstddef>
-#include <sstream>
-#include <vector>
+#include <array>
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+# define XAYAUTIL_BASE64_X86 1
+# include <immintrin.h>
+#endif
 
 namespace xaya
 {
 
-std::string
-EncodeBase64 (const std::string& data)
+namespace
+{
+
+/** The base64 alphabet.  */
+const char ALPHABET[]
+    = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/** Table value for characters that are not in the alphabet.  */
+constexpr int8_t INVALID = -1;
+
+/**
+ * Builds the reverse lookup table from characters to their values.
+ */
+std::array<int8_t, 256>
+BuildDecodeTable ()
 {
-  /* We need an upper bound on the length of the generated data, so that we
-     can reserve a buffer large enough.  The output will be four bytes for
-     every three in the input, plus newlines every 64 bytes, plus one NUL at
-     the end.  By doubling the input data plus some extra bytes in the case
-     of very short input, we are certainly above that.  */
-  const size_t bufSize = 3 + 2 * data.size ();
-
-  std::vector<unsigned char> encoded(bufSize, 0);
-  const int n
-      = EVP_EncodeBlock (encoded.data (),
-                         reinterpret_cast<const unsigned char*> (data.data ()),
-                         data.size ());
-  CHECK_LE (n + 1, bufSize);
-
-  /* Strip out all newline characters from the generated string.  */
-  std::ostringstream res;
-  for (int i = 0; i < n; ++i)
-    if (encoded[i] != '\n')
-      res << encoded[i];
-
-  return res.str ();
+  std::array<int8_t, 256> res;
+  res.fill (INVALID);
+  for (int i = 0; i < 64; ++i)
+    res[static_cast<unsigned char> (ALPHABET[i])] = i;
+
+  return res;
 }
 
-bool
-DecodeBase64 (const std::string& encoded, std::string& data)
+const std::array<int8_t, 256> DECODE_TABLE = BuildDecodeTable ();
+
+/**
+ * Encodes one group of three input bytes to four characters.
+ */
+inline void
+EncodeTriple (const unsigned char* in, char* out)
+{
+  const uint32_t val = (in[0] << 16) | (in[1] << 8) | in[2];
+  out[0] = ALPHABET[(val >> 18) & 0x3F];
+  out[1] = ALPHABET[(val >> 12) & 0x3F];
+  out[2] = ALPHABET[(val >> 6) & 0x3F];
+  out[3] = ALPHABET[val & 0x3F];
+}
+
+/**
+ * Decodes a group of four characters (without padding) into three bytes.
+ * Returns false if any of them is invalid.
+ */
+inline bool
+DecodeQuartet (const char* in, unsigned char* out)
+{
+  const int a = DECODE_TABLE[static_cast<unsigned char> (in[0])];
+  const int b = DECODE_TABLE[static_cast<unsigned char> (in[1])];
+  const int c = DECODE_TABLE[static_cast<unsigned char> (in[2])];
+  const int d = DECODE_TABLE[static_cast<unsigned char> (in[3])];
+  if ((a | b | c | d) < 0)
+    return false;
+
+  const uint32_t val = (a << 18) | (b << 12) | (c << 6) | d;
+  out[0] = val >> 16;
+  out[1] = (val >> 8) & 0xFF;
+  out[2] = val & 0xFF;
+  return true;
+}
+
+/* ************************************************************************** */
+
+#ifdef XAYAUTIL_BASE64_X86
+
+/* The vectorised code below follows the well-known algorithms by Wojciech Muła
+   and Daniel Lemire.  Encoding splits groups of three bytes into four
+   six-bit indices with shuffles and multiplications, and then maps them
+   to ASCII with a small lookup of offsets.  Decoding validates all characters
+   with two nibble lookups, maps them back to their six-bit values and packs
+   them with multiply-add instructions.  */
+
+/**
+ * Processes the core SSE encoding step on a vector of twelve input bytes
+ * (in the low 12 bytes of the register), returning 16 base64 characters.
+ */
+__attribute__ ((target ("ssse3")))
+inline __m128i
+EncodeVectorSse (__m128i in)
+{
+  in = _mm_shuffle_epi8 (in, _mm_set_epi8 (10, 11, 9, 10, 7, 8, 6, 7,
+                                           4, 5, 3, 4, 1, 2, 0, 1));
+
+  const __m128i t0 = _mm_and_si128 (in, _mm_set1_epi32 (0x0FC0FC00));
+  const __m128i t1 = _mm_mulhi_epu16 (t0, _mm_set1_epi32 (0x04000040));
+  const __m128i t2 = _mm_and_si128 (in, _mm_set1_epi32 (0x003F03F0));
+  const __m128i t3 = _mm_mullo_epi16 (t2, _mm_set1_epi32 (0x01000010));
+  const __m128i indices = _mm_or_si128 (t1, t3);
+
+  __m128i offsets = _mm_subs_epu8 (indices, _mm_set1_epi8 (51));
+  const __m128i less = _mm_cmpgt_epi8 (_mm_set1_epi8 (26), indices);
+  offsets = _mm_or_si128 (offsets, _mm_and_si128 (less, _mm_set1_epi8 (13)));
+
+  const __m128i lut = _mm_setr_epi8 ('a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                                     '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                     '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                     '/' - 63, 'A', 0, 0);
+  offsets = _mm_shuffle_epi8 (lut, offsets);
+
+  return _mm_add_epi8 (offsets, indices);
+}
+
+/**
+ * Encodes as many full blocks of input as possible with SSE, and returns
+ * the number of input bytes processed.
+ */
+__attribute__ ((target ("ssse3")))
+size_t
+EncodeSse (const unsigned char* in, const size_t len, char* out)
 {
-  if (encoded.size () % 4 != 0)
+  size_t i = 0;
+  for (; i + 16 <= len; i += 12, out += 16)
     {
-      LOG (ERROR) << "Base64 data has invalid length " << encoded.size ();
-      return false;
+      const __m128i block
+          = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (in + i));
+      _mm_storeu_si128 (reinterpret_cast<__m128i*> (out),
+                        EncodeVectorSse (block));
     }
 
-  /* EVP_DecodeBlock is quite lenient with respect to padding
-     characters.  We want strict rules here, namely only accept 0-3
-     padding characters at the very end of the input string.  */
-  size_t padding = 0;
-  for (const char c : encoded)
+  return i;
+}
+
+/**
+ * Encodes as many full blocks of input as possible with AVX2, and returns
+ * the number of input bytes processed.
+ */
+__attribute__ ((target ("avx2")))
+size_t
+EncodeAvx2 (const unsigned char* in, const size_t len, char* out)
+{
+  const __m256i shuffle
+      = _mm256_setr_epi8 (1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                          1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+  const __m256i lut
+      = _mm256_setr_epi8 ('a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                          '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                          '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                          '/' - 63, 'A', 0, 0,
+                          'a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                          '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                          '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                          '/' - 63, 'A', 0, 0);
+
+  size_t i = 0;
+  for (; i + 28 <= len; i += 24, out += 32)
     {
-      if (c != '=')
-        {
-          if (padding > 0)
-            {
-              LOG (ERROR) << "Padding in the middle of base64 data";
-              return false;
-            }
-          continue;
-        }
+      const __m128i lo
+          = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (in + i));
+      const __m128i hi
+          = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (in + i + 12));
+      __m256i v = _mm256_inserti128_si256 (_mm256_castsi128_si256 (lo), hi, 1);
+      v = _mm256_shuffle_epi8 (v, shuffle);
 
-      ++padding;
+      const __m256i t0 = _mm256_and_si256 (v, _mm256_set1_epi32 (0x0FC0FC00));
+      const __m256i t1
+          = _mm256_mulhi_epu16 (t0, _mm256_set1_epi32 (0x04000040));
+      const __m256i t2 = _mm256_and_si256 (v, _mm256_set1_epi32 (0x003F03F0));
+      const __m256i t3
+          = _mm256_mullo_epi16 (t2, _mm256_set1_epi32 (0x01000010));
+      const __m256i indices = _mm256_or_si256 (t1, t3);
+
+      __m256i offsets = _mm256_subs_epu8 (indices, _mm256_set1_epi8 (51));
+      const __m256i less
+          = _mm256_cmpgt_epi8 (_mm256_set1_epi8 (26), indices);
+      offsets = _mm256_or_si256 (
+          offsets, _mm256_and_si256 (less, _mm256_set1_epi8 (13)));
+      offsets = _mm256_shuffle_epi8 (lut, offsets);
+
+      _mm256_storeu_si256 (reinterpret_cast<__m256i*> (out),
+                           _mm256_add_epi8 (offsets, indices));
     }
-  if (padding >= 4)
+
+  return i;
+}
+
+/**
+ * Decodes as many full blocks of 16 characters as possible with SSE.  Stops
+ * at the first block containing a character outside the alphabet (which is
+ * then handled by the scalar code).  outLen is the total size of the output
+ * buffer, which must not be overrun by the 16-byte stores.  Returns the
+ * number of input characters processed.
+ */
+__attribute__ ((target ("sse4.1")))
+size_t
+DecodeSse (const char* in, const size_t len, unsigned char* out,
+           const size_t outLen)
+{
+  const __m128i lutLo = _mm_setr_epi8 (0x15, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                       0x11, 0x11, 0x11, 0x11, 0x13, 0x1A,
+                                       0x1B, 0x1B, 0x1B, 0x1A);
+  const __m128i lutHi = _mm_setr_epi8 (0x10, 0x10, 0x01, 0x02, 0x04, 0x08,
+                                       0x04, 0x08, 0x10, 0x10, 0x10, 0x10,
+                                       0x10, 0x10, 0x10, 0x10);
+  const __m128i lutRoll = _mm_setr_epi8 (0, 16, 19, 4, -65, -65, -71, -71,
+                                         0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i nibbleMask = _mm_set1_epi8 (0x0F);
+
+  size_t i = 0;
+  for (; i + 16 <= len && i / 4 * 3 + 16 <= outLen; i += 16, out += 12)
     {
-      LOG (ERROR) << "Too many padding characters in base64 data";
-      return false;
+      __m128i v = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (in + i));
+
+      const __m128i hiNibbles
+          = _mm_and_si128 (_mm_srli_epi32 (v, 4), nibbleMask);
+      const __m128i loNibbles = _mm_and_si128 (v, nibbleMask);
+      const __m128i lo = _mm_shuffle_epi8 (lutLo, loNibbles);
+      const __m128i hi = _mm_shuffle_epi8 (lutHi, hiNibbles);
+      if (!_mm_testz_si128 (lo, hi))
+        break;
+
+      const __m128i eqSlash = _mm_cmpeq_epi8 (v, _mm_set1_epi8 ('/'));
+      const __m128i roll
+          = _mm_shuffle_epi8 (lutRoll, _mm_add_epi8 (eqSlash, hiNibbles));
+      v = _mm_add_epi8 (v, roll);
+
+      const __m128i merged
+          = _mm_maddubs_epi16 (v, _mm_set1_epi32 (0x01400140));
+      __m128i packed = _mm_madd_epi16 (merged, _mm_set1_epi32 (0x00011000));
+      packed = _mm_shuffle_epi8 (packed,
+                                 _mm_setr_epi8 (2, 1, 0, 6, 5, 4, 10, 9,
+                                                8, 14, 13, 12, -1, -1, -1, -1));
+      _mm_storeu_si128 (reinterpret_cast<__m128i*> (out), packed);
     }
 
-  /* The output data will have a length of three bytes for every four input
-     characters.  */
-  const size_t outputSize = encoded.size () / 4 * 3;
-  data.resize (outputSize);
+  return i;
+}
 
-  const unsigned char* in
-      = reinterpret_cast<const unsigned char*> (encoded.data ());
-  unsigned char* out = reinterpret_cast<unsigned char*> (&data[0]);
-  const int n = EVP_DecodeBlock (out, in, encoded.size ());
-  if (n == -1)
+/**
+ * Decodes as many full blocks of 32 characters as possible with AVX2.
+ * This works like DecodeSse.
+ */
+__attribute__ ((target ("avx2")))
+size_t
+DecodeAvx2 (const char* in, const size_t len, unsigned char* out,
+            const size_t outLen)
+{
+  const __m256i lutLo
+      = _mm256_setr_epi8 (0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                          0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                          0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                          0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+  const __m256i lutHi
+      = _mm256_setr_epi8 (0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                          0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                          0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                          0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m256i lutRoll
+      = _mm256_setr_epi8 (0, 16, 19, 4, -65, -65, -71, -71,
+                          0, 0, 0, 0, 0, 0, 0, 0,
+                          0, 16, 19, 4, -65, -65, -71, -71,
+                          0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i packShuffle
+      = _mm256_setr_epi8 (2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                          -1, -1, -1, -1,
+                          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                          -1, -1, -1, -1);
+  const __m256i nibbleMask = _mm256_set1_epi8 (0x0F);
+
+  size_t i = 0;
+  for (; i + 32 <= len && i / 4 * 3 + 32 <= outLen; i += 32, out += 24)
+    {
+      __m256i v
+          = _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (in + i));
+
+      const __m256i hiNibbles
+          = _mm256_and_si256 (_mm256_srli_epi32 (v, 4), nibbleMask);
+      const __m256i loNibbles = _mm256_and_si256 (v, nibbleMask);
+      const __m256i lo = _mm256_shuffle_epi8 (lutLo, loNibbles);
+      const __m256i hi = _mm256_shuffle_epi8 (lutHi, hiNibbles);
+      if (!_mm256_testz_si256 (lo, hi))
+        break;
+
+      const __m256i eqSlash = _mm256_cmpeq_epi8 (v, _mm256_set1_epi8 ('/'));
+      const __m256i roll
+          = _mm256_shuffle_epi8 (lutRoll,
+                                 _mm256_add_epi8 (eqSlash, hiNibbles));
+      v = _mm256_add_epi8 (v, roll);
+
+      const __m256i merged
+          = _mm256_maddubs_epi16 (v, _mm256_set1_epi32 (0x01400140));
+      __m256i packed
+          = _mm256_madd_epi16 (merged, _mm256_set1_epi32 (0x00011000));
+      packed = _mm256_shuffle_epi8 (packed, packShuffle);
+      packed = _mm256_permutevar8x32_epi32 (
+          packed, _mm256_setr_epi32 (0, 1, 2, 4, 5, 6, 3, 7));
+      _mm256_storeu_si256 (reinterpret_cast<__m256i*> (out), packed);
+    }
+
+  return i;
+}
+
+/**
+ * The instruction sets available at runtime, which determine which
+ * vectorised implementation to use.
+ */
+enum class SimdLevel
+{
+  NONE,
+  SSE,
+  AVX2,
+};
+
+SimdLevel
+DetectSimdLevel ()
+{
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2"))
+    return SimdLevel::AVX2;
+  if (__builtin_cpu_supports ("sse4.1") && __builtin_cpu_supports ("ssse3"))
+    return SimdLevel::SSE;
+  return SimdLevel::NONE;
+}
+
+const SimdLevel SIMD_LEVEL = DetectSimdLevel ();
+
+#endif // XAYAUTIL_BASE64_X86
+
+} // anonymous namespace
+
+/* ************************************************************************** */
+
+size_t
+GetBase64EncodedSize (const size_t n)
+{
+  return (n + 2) / 3 * 4;
+}
+
+size_t
+GetBase64MaxDecodedSize (const size_t n)
+{
+  return n / 4 * 3;
+}
+
+size_t
+EncodeBase64 (const unsigned char* data, const size_t len, char* out)
+{
+  size_t i = 0;
+#ifdef XAYAUTIL_BASE64_X86
+  switch (SIMD_LEVEL)
+    {
+    case SimdLevel::AVX2:
+      i = EncodeAvx2 (data, len, out);
+      i += EncodeSse (data + i, len - i, out + i / 3 * 4);
+      break;
+    case SimdLevel::SSE:
+      i = EncodeSse (data, len, out);
+      break;
+    case SimdLevel::NONE:
+      break;
+    }
+#endif // XAYAUTIL_BASE64_X86
+
+  char* o = out + i / 3 * 4;
+  for (; i + 3 <= len; i += 3, o += 4)
+    EncodeTriple (data + i, o);
+
+  switch (len - i)
+    {
+    case 0:
+      break;
+
+    case 1:
+      {
+        const unsigned char last[3] = {data[i], 0, 0};
+        EncodeTriple (last, o);
+        o[2] = '=';
+        o[3] = '=';
+        o += 4;
+        break;
+      }
+
+    case 2:
+      {
+        const unsigned char last[3] = {data[i], data[i + 1], 0};
+        EncodeTriple (last, o);
+        o[3] = '=';
+        o += 4;
+        break;
+      }
+
+    default:
+      LOG (FATAL) << "Unexpected remaining length: " << (len - i);
+    }
+
+  const size_t written = o - out;
+  CHECK_EQ (written, GetBase64EncodedSize (len));
+  return written;
+}
+
+bool
+DecodeBase64 (const char* encoded, const size_t len,
+              unsigned char* out, size_t& outLen)
+{
+  if (len % 4 != 0)
+    {
+      LOG (ERROR) << "Base64 data has invalid length " << len;
+      return false;
+    }
+
+  /* We only accept up to three padding characters at the very end of the
+     input (which is what the previous implementation based on OpenSSL's
+     EVP_DecodeBlock allowed).  Any other '=' is rejected as invalid
+     character below.  */
+  size_t padding = 0;
+  while (padding < 3 && padding < len && encoded[len - 1 - padding] == '=')
+    ++padding;
+  if (padding == 3 && len == 4)
     {
-      LOG (ERROR) << "OpenSSL base64 decode returned error";
+      LOG (ERROR) << "Base64 data consists only of padding";
       return false;
     }
-  CHECK_EQ (n, outputSize);
 
-  /* Strip the zero padding bytes off the end.  There will be as many padding
-     bytes as there were "=" characters at the end of encoded.  */
-  if (n == 0)
-    CHECK_EQ (padding, 0);
-  else
+  /* All full groups of four characters without padding.  */
+  const size_t fullLen = (padding > 0 ? len - 4 : len);
+  outLen = fullLen / 4 * 3 + (padding > 0 ? 3 - padding : 0);
+
+  size_t i = 0;
+#ifdef XAYAUTIL_BASE64_X86
+  switch (SIMD_LEVEL)
     {
-      CHECK_LT (padding, data.size ());
-      data.resize (data.size () - padding);
+    case SimdLevel::AVX2:
+      i = DecodeAvx2 (encoded, fullLen, out, outLen);
+      i += DecodeSse (encoded + i, fullLen - i, out + i / 4 * 3,
+                      outLen - i / 4 * 3);
+      break;
+    case SimdLevel::SSE:
+      i = DecodeSse (encoded, fullLen, out, outLen);
+      break;
+    case SimdLevel::NONE:
+      break;
+    }
+#endif // XAYAUTIL_BASE64_X86
+
+  unsigned char* o = out + i / 4 * 3;
+  for (; i < fullLen; i += 4, o += 3)
+    if (!DecodeQuartet (encoded + i, o))
+      {
+        LOG (ERROR) << "Invalid character in base64 data";
+        return false;
+      }
+
+  if (padding > 0)
+    {
+      /* Fill in the padding characters with a valid one, so that we can
+         reuse DecodeQuartet.  Like OpenSSL, we ignore any non-zero bits
+         in the last character that do not make it into the output.  */
+      char last[4] = {encoded[i], encoded[i + 1], encoded[i + 2], 'A'};
+      for (size_t j = 0; j < padding; ++j)
+        last[3 - j] = 'A';
+
+      unsigned char bytes[3];
+      if (!DecodeQuartet (last, bytes))
+        {
+          LOG (ERROR) << "Invalid character in base64 data";
+          return false;
+        }
+
+      for (size_t j = 0; j < 3 - padding; ++j)
+        o[j] = bytes[j];
     }
 
   return true;
 }
 
+std::string
+EncodeBase64 (const std::string& data)
+{
+  std::string res(GetBase64EncodedSize (data.size ()), '\0');
+  if (!res.empty ())
+    EncodeBase64 (reinterpret_cast<const unsigned char*> (data.data ()),
+                  data.size (), &res[0]);
+
+  return res;
+}
+
+bool
+DecodeBase64 (const std::string& encoded, std::string& data)
+{
+  data.resize (GetBase64MaxDecodedSize (encoded.size ()));
+
+  size_t n;
+  unsigned char* out = reinterpret_cast<unsigned char*> (&data[0]);
+  if (!DecodeBase64 (encoded.data (), encoded.size (), out, n))
+    return false;
+
+  data.resize (n);
+  return true;
+}
+
 } // namespace xaya
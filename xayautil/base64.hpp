@@ -1,10 +1,11 @@
-// Copyright (C) 2019 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #ifndef XAYAUTIL_BASE64_HPP
 #define XAYAUTIL_BASE64_HPP
 
+#include <cstddef>
 #include <string>
 
 namespace xaya
@@ -22,6 +23,33 @@ std::string EncodeBase64 (const std::string& data);
  */
 bool DecodeBase64 (const std::string& encoded, std::string& data);
 
+/**
+ * Returns the length of the base64 encoding of n bytes of data.
+ */
+size_t GetBase64EncodedSize (size_t n);
+
+/**
+ * Returns an upper bound for the length of data decoded from n characters
+ * of base64 (the exact length depends on the padding).
+ */
+size_t GetBase64MaxDecodedSize (size_t n);
+
+/**
+ * Encodes len bytes of data into a caller-provided buffer, which must have
+ * room for at least GetBase64EncodedSize (len) characters.  No terminating
+ * NUL character is written.  Returns the number of characters written.
+ */
+size_t EncodeBase64 (const unsigned char* data, size_t len, char* out);
+
+/**
+ * Decodes len characters of base64 data into a caller-provided buffer,
+ * which must have room for GetBase64MaxDecodedSize (len) bytes.  Applies
+ * the same validation as the string-based DecodeBase64.  On success,
+ * outLen is set to the number of bytes written.
+ */
+bool DecodeBase64 (const char* encoded, size_t len,
+                   unsigned char* out, size_t& outLen);
+
 } // namespace xaya
 
 #endif // XAYAUTIL_BASE64_HPP
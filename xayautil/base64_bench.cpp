@@ -0,0 +1,146 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "base64.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <openssl/evp.h>
+
+#include <glog/logging.h>
+
+#include <string>
+#include <vector>
+
+namespace xaya
+{
+namespace
+{
+
+/**
+ * Encodes data with OpenSSL's EVP_EncodeBlock, which is what the original
+ * implementation of EncodeBase64 did.  It is kept here as baseline.
+ */
+std::string
+EvpEncodeBase64 (const std::string& data)
+{
+  std::vector<unsigned char> encoded(3 + 2 * data.size (), 0);
+  const int n
+      = EVP_EncodeBlock (encoded.data (),
+                         reinterpret_cast<const unsigned char*> (data.data ()),
+                         data.size ());
+
+  std::string res;
+  res.reserve (n);
+  for (int i = 0; i < n; ++i)
+    if (encoded[i] != '\n')
+      res.push_back (encoded[i]);
+
+  return res;
+}
+
+/**
+ * Decodes data with OpenSSL's EVP_DecodeBlock, like the original
+ * implementation of DecodeBase64 (without its extra padding checks).
+ */
+bool
+EvpDecodeBase64 (const std::string& encoded, std::string& data)
+{
+  data.resize (encoded.size () / 4 * 3);
+  const int n = EVP_DecodeBlock (
+      reinterpret_cast<unsigned char*> (&data[0]),
+      reinterpret_cast<const unsigned char*> (encoded.data ()),
+      encoded.size ());
+  return n != -1;
+}
+
+/**
+ * Constructs binary test data of the given size.
+ */
+std::string
+BuildData (const size_t n)
+{
+  std::string res;
+  for (size_t i = 0; i < n; ++i)
+    res.push_back (static_cast<char> (i * 37));
+  return res;
+}
+
+void
+EvpEncode (benchmark::State& state)
+{
+  const std::string data = BuildData (state.range (0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize (EvpEncodeBase64 (data));
+  state.SetBytesProcessed (state.iterations () * data.size ());
+}
+BENCHMARK (EvpEncode)->Arg (32)->Arg (1 << 10)->Arg (1 << 16);
+
+void
+Base64Encode (benchmark::State& state)
+{
+  const std::string data = BuildData (state.range (0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize (EncodeBase64 (data));
+  state.SetBytesProcessed (state.iterations () * data.size ());
+}
+BENCHMARK (Base64Encode)->Arg (32)->Arg (1 << 10)->Arg (1 << 16);
+
+void
+Base64EncodeIntoBuffer (benchmark::State& state)
+{
+  const std::string data = BuildData (state.range (0));
+  std::vector<char> out(GetBase64EncodedSize (data.size ()));
+  for (auto _ : state)
+    benchmark::DoNotOptimize (EncodeBase64 (
+        reinterpret_cast<const unsigned char*> (data.data ()), data.size (),
+        out.data ()));
+  state.SetBytesProcessed (state.iterations () * data.size ());
+}
+BENCHMARK (Base64EncodeIntoBuffer)->Arg (32)->Arg (1 << 10)->Arg (1 << 16);
+
+void
+EvpDecode (benchmark::State& state)
+{
+  const std::string encoded = EncodeBase64 (BuildData (state.range (0)));
+  for (auto _ : state)
+    {
+      std::string data;
+      benchmark::DoNotOptimize (EvpDecodeBase64 (encoded, data));
+    }
+  state.SetBytesProcessed (state.iterations () * encoded.size ());
+}
+BENCHMARK (EvpDecode)->Arg (32)->Arg (1 << 10)->Arg (1 << 16);
+
+void
+Base64Decode (benchmark::State& state)
+{
+  const std::string encoded = EncodeBase64 (BuildData (state.range (0)));
+  for (auto _ : state)
+    {
+      std::string data;
+      benchmark::DoNotOptimize (DecodeBase64 (encoded, data));
+    }
+  state.SetBytesProcessed (state.iterations () * encoded.size ());
+}
+BENCHMARK (Base64Decode)->Arg (32)->Arg (1 << 10)->Arg (1 << 16);
+
+void
+Base64DecodeIntoBuffer (benchmark::State& state)
+{
+  const std::string encoded = EncodeBase64 (BuildData (state.range (0)));
+  std::vector<unsigned char> out(GetBase64MaxDecodedSize (encoded.size ()));
+  for (auto _ : state)
+    {
+      size_t outLen;
+      CHECK (DecodeBase64 (encoded.data (), encoded.size (), out.data (),
+                           outLen));
+      benchmark::DoNotOptimize (outLen);
+    }
+  state.SetBytesProcessed (state.iterations () * encoded.size ());
+}
+BENCHMARK (Base64DecodeIntoBuffer)->Arg (32)->Arg (1 << 10)->Arg (1 << 16);
+
+} // anonymous namespace
+} // namespace xaya
@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2020 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -6,7 +6,9 @@
 
 #include <gtest/gtest.h>
 
+#include <sstream>
 #include <string>
+#include <vector>
 
 namespace xaya
 {
@@ -83,5 +85,85 @@ TEST_F (Base64Tests, InvalidDecode)
     }
 }
 
+TEST_F (Base64Tests, PaddingCompatibility)
+{
+  /* Up to three padding characters are accepted, as long as there is
+     some actual data left.  */
+  std::string decoded;
+  ASSERT_TRUE (DecodeBase64 ("YWJjZ===", decoded));
+  EXPECT_EQ (decoded, "abc");
+  EXPECT_FALSE (DecodeBase64 ("Z===", decoded));
+
+  /* Non-zero bits in the last character that do not make it into the
+     output are ignored.  */
+  ASSERT_TRUE (DecodeBase64 ("eB==", decoded));
+  EXPECT_EQ (decoded, "x");
+}
+
+TEST_F (Base64Tests, BufferApi)
+{
+  EXPECT_EQ (GetBase64EncodedSize (0), 0);
+  EXPECT_EQ (GetBase64EncodedSize (1), 4);
+  EXPECT_EQ (GetBase64EncodedSize (3), 4);
+  EXPECT_EQ (GetBase64EncodedSize (4), 8);
+  EXPECT_EQ (GetBase64MaxDecodedSize (0), 0);
+  EXPECT_EQ (GetBase64MaxDecodedSize (8), 6);
+
+  const std::string data = "foobar!";
+  std::vector<char> encoded(GetBase64EncodedSize (data.size ()));
+  const size_t n = EncodeBase64 (
+      reinterpret_cast<const unsigned char*> (data.data ()), data.size (),
+      encoded.data ());
+  ASSERT_EQ (n, encoded.size ());
+  EXPECT_EQ (std::string (encoded.data (), n), "Zm9vYmFyIQ==");
+
+  std::vector<unsigned char> decoded(GetBase64MaxDecodedSize (n));
+  size_t decodedLen;
+  ASSERT_TRUE (DecodeBase64 (encoded.data (), n, decoded.data (),
+                             decodedLen));
+  EXPECT_EQ (std::string (reinterpret_cast<const char*> (decoded.data ()),
+                          decodedLen),
+             data);
+}
+
+TEST_F (Base64Tests, LongInputs)
+{
+  /* Longer inputs are processed (partially) in vectorised chunks.
+     Make sure that all lengths around the chunk sizes work.  */
+  for (int n = 0; n < 300; ++n)
+    {
+      std::string data;
+      for (int i = 0; i < n; ++i)
+        data.push_back (static_cast<char> (i * 37 + n));
+
+      const std::string encoded = EncodeBase64 (data);
+      EXPECT_EQ (encoded.size (), GetBase64EncodedSize (n));
+
+      std::string decoded;
+      ASSERT_TRUE (DecodeBase64 (encoded, decoded));
+      EXPECT_EQ (decoded, data);
+    }
+}
+
+TEST_F (Base64Tests, LongInvalidDecode)
+{
+  const std::string valid = EncodeBase64 (std::string (150, 'x'));
+  ASSERT_EQ (valid.size (), 200);
+
+  for (size_t pos = 0; pos < valid.size (); ++pos)
+    for (const char c : {'.', '=', '\n', '\0', '\x80', '-', '_'})
+      {
+        /* A single '=' at the very end is valid padding.  */
+        if (c == '=' && pos + 1 == valid.size ())
+          continue;
+
+        std::string s = valid;
+        s[pos] = c;
+        std::string decoded;
+        EXPECT_FALSE (DecodeBase64 (s, decoded))
+            << "Accepted invalid character at position " << pos;
+      }
+}
+
 } // anonymous namespace
 } // namespace xaya
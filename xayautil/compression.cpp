@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2020 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -6,6 +6,14 @@
 
 #include "base64.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
 namespace xaya
 {
 
@@ -20,12 +28,53 @@ constexpr int WINDOW_BITS = 15;
 /** Compression level we use.  */
 constexpr int LEVEL = 9;
 
+/**
+ * Size of the history window matching WINDOW_BITS.  This is how much of the
+ * preceding data is used to prime the compressor for a chunk.
+ */
+constexpr size_t WINDOW_SIZE = size_t (1) << WINDOW_BITS;
+
+/**
+ * Initial size of the output buffer for inflating, relative to the size of
+ * the compressed input.  The buffer is grown geometrically from there
+ * (up to the maximum output size) as needed.
+ */
+constexpr size_t INITIAL_OUTPUT_FACTOR = 4;
+
+/** Minimum initial size of the output buffer for inflating.  */
+constexpr size_t MIN_INITIAL_OUTPUT = 1'024;
+
+/**
+ * Maximum capacity of the thread-local buffers (for decoded input and
+ * inflated output) that are kept between calls to UncompressJson.  Larger
+ * buffers are released after use, so that a single large (and possibly
+ * malicious) input does not pin its memory in every thread that has
+ * seen one.
+ */
+constexpr size_t MAX_RETAINED_BUFFER = 64 << 10;
+
 /**
  * Utility class wrapping a z_stream instance used for inflating data.
+ * Instances are meant to be reused for multiple calls to Uncompress
+ * (see GetInflateStream), to avoid the cost of setting up the zlib state
+ * each time.
  */
 class InflateStream : public BasicZlibStream
 {
 
+private:
+
+  /**
+   * Sets the output window of the stream to the given part of the buffer.
+   */
+  void
+  SetOutputWindow (char* out, const size_t len)
+  {
+    stream.next_out = reinterpret_cast<Bytef*> (out);
+    stream.avail_out = std::min<size_t> (len,
+                                         std::numeric_limits<uInt>::max ());
+  }
+
 public:
 
   /**
@@ -47,41 +96,137 @@ public:
   }
 
   /**
-   * Performs the actual uncompression step of data.
+   * Performs the actual uncompression step of data into buf.  The buffer is
+   * grown geometrically as needed, so that its size is proportional to
+   * the actual output rather than maxOutputSize.  Memory already allocated
+   * for buf is reused.  If false is returned, the content of buf is
+   * unspecified.
    */
   bool
   Uncompress (const std::string& input, const size_t maxOutputSize,
-              std::string& output)
+              std::string& buf)
   {
+    const auto res = inflateReset (&stream);
+    CHECK_EQ (res, Z_OK) << "Inflate reset error " << res << ": " << GetError ();
+
     SetInput (input);
-    SetOutputSize (maxOutputSize);
 
-    const auto res = inflate (&stream, Z_FINISH);
-    switch (res)
-      {
-      case Z_STREAM_END:
-        CHECK_EQ (stream.total_in, input.size ());
-        output = ExtractOutput ();
-        return true;
-
-      case Z_BUF_ERROR:
-        VLOG (1)
-            << "Uncompress produced too much output data; processed "
-            << stream.total_in << " input bytes of the total " << input.size ();
-        return false;
+    size_t capacity = std::max (MIN_INITIAL_OUTPUT,
+                                INITIAL_OUTPUT_FACTOR * input.size ());
+    capacity = std::min (capacity, maxOutputSize);
 
-      case Z_NEED_DICT:
-      case Z_DATA_ERROR:
-        VLOG (1) << "Invalid data provided to uncompress: " << GetError ();
-        return false;
+    buf.resize (capacity);
+    SetOutputWindow (&buf[0], capacity);
 
-      default:
-        LOG (FATAL) << "Inflate error " << res << ": " << GetError ();
+    /* Once the output reaches maxOutputSize, we let inflate write into an
+       extra "overflow" byte.  If it does, the output is too large.  If it
+       does not but the stream ends, the output fits exactly.  */
+    char overflow;
+
+    while (true)
+      {
+        const size_t written = stream.total_out;
+        if (stream.avail_out == 0)
+          {
+            if (written > maxOutputSize)
+              {
+                VLOG (1)
+                    << "Uncompress produced too much output data; processed "
+                    << stream.total_in << " input bytes of the total "
+                    << input.size ();
+                return false;
+              }
+
+            if (written == maxOutputSize)
+              SetOutputWindow (&overflow, 1);
+            else
+              {
+                if (written == buf.size ())
+                  {
+                    capacity = std::min (2 * capacity, maxOutputSize);
+                    buf.resize (capacity);
+                  }
+                SetOutputWindow (&buf[written], buf.size () - written);
+              }
+          }
+
+        const auto res = inflate (&stream, Z_NO_FLUSH);
+        switch (res)
+          {
+          case Z_OK:
+            continue;
+
+          case Z_STREAM_END:
+            if (stream.total_out > maxOutputSize)
+              {
+                VLOG (1) << "Uncompress produced too much output data";
+                return false;
+              }
+            if (stream.avail_in != 0)
+              {
+                VLOG (1)
+                    << "Uncompress has " << stream.avail_in
+                    << " bytes of trailing input data";
+                return false;
+              }
+            CHECK_EQ (stream.total_in, input.size ());
+            buf.resize (stream.total_out);
+            return true;
+
+          case Z_BUF_ERROR:
+            /* We always provide output space, so this means that no
+               progress is possible because the input is truncated.  */
+            VLOG (1) << "Uncompress input data is incomplete";
+            return false;
+
+          case Z_NEED_DICT:
+          case Z_DATA_ERROR:
+            VLOG (1) << "Invalid data provided to uncompress: " << GetError ();
+            return false;
+
+          default:
+            LOG (FATAL) << "Inflate error " << res << ": " << GetError ();
+          }
       }
   }
 
 };
 
+/**
+ * Returns the inflate stream to use for the current thread.  The stream
+ * state is reused between calls (after resetting it), which saves the
+ * allocation and initialisation of zlib's internal state and window.
+ */
+InflateStream&
+GetInflateStream ()
+{
+  static thread_local InflateStream instance;
+  return instance;
+}
+
+/**
+ * Compresses the chunk with the given index for CompressDataParallel.
+ * The result is a piece of the overall raw deflate stream; it is primed
+ * with the preceding data (if any), and completes the stream only for
+ * the last chunk.
+ */
+std::string
+CompressChunk (const std::string& data, const size_t chunkSize,
+               const size_t index, const bool last)
+{
+  DeflateStream compressor(-WINDOW_BITS, LEVEL);
+
+  const size_t begin = index * chunkSize;
+  const size_t len = std::min (chunkSize, data.size () - begin);
+
+  const size_t historyLen = std::min (begin, WINDOW_SIZE);
+  if (historyLen > 0)
+    compressor.PrimeHistory (data.data () + begin - historyLen, historyLen);
+
+  return compressor.Deflate (data.data () + begin, len,
+                             last ? Z_FINISH : Z_SYNC_FLUSH);
+}
+
 } // anonymous namespace
 
 std::string
@@ -91,12 +236,69 @@ CompressData (const std::string& data)
   return compressor.Compress (data);
 }
 
+std::string
+CompressDataParallel (const std::string& data, const size_t chunkSize,
+                      unsigned numThreads)
+{
+  CHECK_GT (chunkSize, 0);
+
+  const size_t numChunks = (data.size () + chunkSize - 1) / chunkSize;
+  if (numChunks <= 1)
+    return CompressData (data);
+
+  if (numThreads == 0)
+    numThreads = std::max (1u, std::thread::hardware_concurrency ());
+  numThreads = std::min<size_t> (numThreads, numChunks);
+
+  std::vector<std::string> parts(numChunks);
+  std::atomic<size_t> nextChunk(0);
+  const auto worker = [&] ()
+    {
+      while (true)
+        {
+          const size_t index = nextChunk++;
+          if (index >= numChunks)
+            break;
+          parts[index] = CompressChunk (data, chunkSize, index,
+                                        index + 1 == numChunks);
+        }
+    };
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < numThreads; ++i)
+    threads.emplace_back (worker);
+  worker ();
+  for (auto& t : threads)
+    t.join ();
+
+  size_t totalSize = 0;
+  for (const auto& p : parts)
+    totalSize += p.size ();
+
+  std::string res;
+  res.reserve (totalSize);
+  for (const auto& p : parts)
+    res.append (p);
+
+  VLOG (1)
+      << "Compressed " << data.size () << " bytes in " << numChunks
+      << " chunks with " << numThreads << " threads to " << res.size ();
+
+  return res;
+}
+
 bool
 UncompressData (const std::string& input, const size_t maxOutputSize,
                 std::string& output)
 {
-  InflateStream uncompressor;
-  return uncompressor.Uncompress (input, maxOutputSize, output);
+  /* Inflate into a separate buffer, so that output is left untouched
+     if the data is invalid.  */
+  std::string buf;
+  if (!GetInflateStream ().Uncompress (input, maxOutputSize, buf))
+    return false;
+
+  output = std::move (buf);
+  return true;
 }
 
 /* ************************************************************************** */
@@ -124,37 +326,80 @@ CompressJson (const Json::Value& val,
   return true;
 }
 
+namespace
+{
+
+/**
+ * Returns the JSON reader used by UncompressJson for the given stack limit.
+ * Readers are not thread-safe but can be reused for multiple documents,
+ * so we cache one per stack limit and thread.
+ */
+Json::CharReader&
+GetJsonReader (const unsigned stackLimit)
+{
+  static thread_local std::map<unsigned, std::unique_ptr<Json::CharReader>>
+      readers;
+
+  auto& reader = readers[stackLimit];
+  if (reader == nullptr)
+    {
+      Json::CharReaderBuilder rbuilder;
+      rbuilder["allowComments"] = false;
+      /* Without strictRoot, versions of jsoncpp before
+         https://github.com/open-source-parsers/jsoncpp/pull/1014 did not
+         properly enforce failIfExtra (which we want).  */
+      rbuilder["strictRoot"] = true;
+      rbuilder["allowDroppedNullPlaceholders"] = false;
+      rbuilder["allowNumericKeys"] = false;
+      rbuilder["allowSingleQuotes"] = false;
+      rbuilder["stackLimit"] = stackLimit;
+      rbuilder["failIfExtra"] = true;
+      rbuilder["rejectDupKeys"] = true;
+      rbuilder["allowSpecialFloats"] = false;
+
+      reader.reset (rbuilder.newCharReader ());
+    }
+
+  return *reader;
+}
+
+/**
+ * Decodes the base64 input and inflates the result into buf, reusing
+ * the memory already allocated for it.  If false is returned, the content
+ * of buf is unspecified.
+ */
 bool
-UncompressJson (const std::string& input,
-                const size_t maxOutputSize, const unsigned stackLimit,
-                Json::Value& output, std::string& uncompressed)
+DecodeAndInflate (const std::string& input, const size_t maxOutputSize,
+                  std::string& buf)
 {
-  Json::CharReaderBuilder rbuilder;
-  rbuilder["allowComments"] = false;
-  /* Without strictRoot, versions of jsoncpp before
-     https://github.com/open-source-parsers/jsoncpp/pull/1014 did not
-     properly enforce failIfExtra (which we want).  */
-  rbuilder["strictRoot"] = true;
-  rbuilder["allowDroppedNullPlaceholders"] = false;
-  rbuilder["allowNumericKeys"] = false;
-  rbuilder["allowSingleQuotes"] = false;
-  rbuilder["stackLimit"] = stackLimit;
-  rbuilder["failIfExtra"] = true;
-  rbuilder["rejectDupKeys"] = true;
-  rbuilder["allowSpecialFloats"] = false;
-
-  std::string compressed;
-  if (!DecodeBase64 (input, compressed))
-    return false;
+  /* The decoded data is only needed temporarily, so we reuse the
+     buffer (and its allocated memory) between calls, as long as it
+     is not too large.  */
+  static thread_local std::string compressed;
+  const bool ok
+      = DecodeBase64 (input, compressed)
+          && GetInflateStream ().Uncompress (compressed, maxOutputSize, buf);
+  if (compressed.capacity () > MAX_RETAINED_BUFFER)
+    std::string ().swap (compressed);
+
+  return ok;
+}
 
-  if (!UncompressData (compressed, maxOutputSize, uncompressed))
-    return false;
+/**
+ * Parses serialised JSON data with the given stack limit.  Returns true
+ * if it is valid and a JSON object or array.
+ */
+bool
+ParseJsonData (const std::string& data, const unsigned stackLimit,
+               Json::Value& output)
+{
+  const char* begin = data.data ();
+  const char* end = begin + data.size ();
 
   std::string parseErrs;
-  std::istringstream in(uncompressed);
   try
     {
-      if (!Json::parseFromStream (rbuilder, in, &output, &parseErrs))
+      if (!GetJsonReader (stackLimit).parse (begin, end, &output, &parseErrs))
         return false;
     }
   catch (const Json::Exception& exc)
@@ -165,6 +410,37 @@ UncompressJson (const std::string& input,
   return output.isObject () || output.isArray ();
 }
 
+} // anonymous namespace
+
+bool
+UncompressJson (const std::string& input,
+                const size_t maxOutputSize, const unsigned stackLimit,
+                Json::Value& output, std::string& uncompressed)
+{
+  std::string buf;
+  if (!DecodeAndInflate (input, maxOutputSize, buf))
+    return false;
+
+  uncompressed = std::move (buf);
+  return ParseJsonData (uncompressed, stackLimit, output);
+}
+
+bool
+UncompressJson (const std::string& input,
+                const size_t maxOutputSize, const unsigned stackLimit,
+                Json::Value& output)
+{
+  /* The caller does not need the uncompressed data, so we inflate it into
+     a reused buffer like the decoded input.  */
+  static thread_local std::string uncompressed;
+  const bool ok = DecodeAndInflate (input, maxOutputSize, uncompressed)
+                    && ParseJsonData (uncompressed, stackLimit, output);
+  if (uncompressed.capacity () > MAX_RETAINED_BUFFER)
+    std::string ().swap (uncompressed);
+
+  return ok;
+}
+
 /* ************************************************************************** */
 
 } // namespace xaya
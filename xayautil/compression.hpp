@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2020 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -28,6 +28,26 @@ namespace xaya
  */
 std::string CompressData (const std::string& data);
 
+/** Default chunk size used by CompressDataParallel.  */
+constexpr size_t DEFAULT_COMPRESSION_CHUNK_SIZE = 128 << 10;
+
+/**
+ * Compresses the given data like CompressData, but splits it into chunks
+ * of chunkSize bytes that are compressed independently on numThreads
+ * worker threads (or as many as the hardware supports, if numThreads is
+ * zero).  Each chunk is primed with the data preceding it, and all but the
+ * last end with a sync flush, so that the concatenated output is a single
+ * raw deflate stream accepted by UncompressData.
+ *
+ * The output depends only on the data and chunkSize (not on the number of
+ * threads), and is identical to CompressData if the data fits into a single
+ * chunk.  For larger data, it is usually slightly bigger.
+ */
+std::string CompressDataParallel (const std::string& data,
+                                  size_t chunkSize
+                                      = DEFAULT_COMPRESSION_CHUNK_SIZE,
+                                  unsigned numThreads = 0);
+
 /**
  * Tries to uncompress the given byte-string, returning the original data.
  * If the input data is invalid or the output size is larger than maxOutputSize,
@@ -37,7 +57,9 @@ std::string CompressData (const std::string& data);
  * crafted data cannot be used to DoS a node on memory (i.e. "zip bomb").
  * Thus users should ensure they pass a reasonable and not insanely large
  * value for this parameter, as fits to the application in question.  The value
- * used here is then relevant for consensus!
+ * used here is then relevant for consensus!  Memory is only allocated
+ * as the output actually grows, so a large maxOutputSize does not by itself
+ * cost anything for small inputs.
  *
  * This tries to decompress the data as raw deflate stream with windowBits
  * set to 15.  It is guaranteed to stay stable (in particular also with
@@ -82,6 +104,14 @@ bool UncompressJson (const std::string& input,
                      size_t maxOutputSize, unsigned stackLimit,
                      Json::Value& output, std::string& uncompressed);
 
+/**
+ * Uncompresses an encoded JSON value like the other overload, but without
+ * returning the serialised JSON string for callers that do not need it.
+ */
+bool UncompressJson (const std::string& input,
+                     size_t maxOutputSize, unsigned stackLimit,
+                     Json::Value& output);
+
 } // namespace xaya
 
 #endif // XAYAUTIL_COMPRESSION_HPP
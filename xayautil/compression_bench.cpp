@@ -0,0 +1,121 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "compression.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <glog/logging.h>
+
+#include <string>
+
+namespace xaya
+{
+namespace
+{
+
+/**
+ * Constructs JSON-like test data (similar to game moves or archived
+ * state) of roughly the given size.
+ */
+std::string
+BuildData (const size_t size)
+{
+  std::string res;
+  for (unsigned i = 0; res.size () < size; ++i)
+    res.append (R"({"player":"p)" + std::to_string (i % 331)
+                  + R"(","move":{"x":)" + std::to_string (i * i % 977)
+                  + R"(,"y":)" + std::to_string (i % 101) + "}},");
+  res.resize (size);
+  return res;
+}
+
+void
+CompressSerial (benchmark::State& state)
+{
+  const std::string data = BuildData (state.range (0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize (CompressData (data));
+  state.SetBytesProcessed (state.iterations () * data.size ());
+}
+BENCHMARK (CompressSerial)->Arg (1 << 16)->Arg (1 << 22)->UseRealTime ();
+
+void
+CompressParallel (benchmark::State& state)
+{
+  const std::string data = BuildData (state.range (0));
+  const unsigned threads = state.range (1);
+  for (auto _ : state)
+    benchmark::DoNotOptimize (
+        CompressDataParallel (data, DEFAULT_COMPRESSION_CHUNK_SIZE, threads));
+  state.SetBytesProcessed (state.iterations () * data.size ());
+}
+BENCHMARK (CompressParallel)
+    ->Args ({1 << 22, 1})
+    ->Args ({1 << 22, 2})
+    ->Args ({1 << 22, 4})
+    ->Args ({1 << 22, 0})
+    ->UseRealTime ();
+
+void
+Uncompress (benchmark::State& state)
+{
+  const std::string data = BuildData (state.range (0));
+  const std::string compressed = CompressData (data);
+  for (auto _ : state)
+    {
+      std::string output;
+      benchmark::DoNotOptimize (
+          UncompressData (compressed, data.size (), output));
+    }
+  state.SetBytesProcessed (state.iterations () * data.size ());
+}
+BENCHMARK (Uncompress)->Arg (1 << 10)->Arg (1 << 16)->Arg (1 << 22);
+
+/**
+ * Constructs a JSON move with the given number of entries.
+ */
+Json::Value
+BuildMove (const size_t n)
+{
+  Json::Value move(Json::arrayValue);
+  for (size_t i = 0; i < n; ++i)
+    {
+      Json::Value entry(Json::objectValue);
+      entry["x"] = static_cast<Json::UInt64> (i);
+      entry["name"] = "entry " + std::to_string (i);
+      move.append (entry);
+    }
+  return move;
+}
+
+void
+CompressJsonMove (benchmark::State& state)
+{
+  const Json::Value move = BuildMove (state.range (0));
+  std::string encoded, uncompressed;
+  for (auto _ : state)
+    benchmark::DoNotOptimize (CompressJson (move, encoded, uncompressed));
+  state.SetBytesProcessed (state.iterations () * uncompressed.size ());
+}
+BENCHMARK (CompressJsonMove)->Arg (10)->Arg (1'000);
+
+void
+UncompressJsonMove (benchmark::State& state)
+{
+  std::string encoded, uncompressed;
+  CHECK (CompressJson (BuildMove (state.range (0)), encoded, uncompressed));
+
+  for (auto _ : state)
+    {
+      Json::Value output;
+      benchmark::DoNotOptimize (
+          UncompressJson (encoded, uncompressed.size (), 10, output));
+    }
+  state.SetBytesProcessed (state.iterations () * uncompressed.size ());
+}
+BENCHMARK (UncompressJsonMove)->Arg (10)->Arg (1'000);
+
+} // anonymous namespace
+} // namespace xaya
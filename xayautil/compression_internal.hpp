@@ -1,4 +1,4 @@
-// Copyright (C) 2019 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -14,7 +14,7 @@
 
 #include <zlib.h>
 
-#include <memory>
+#include <string>
 
 namespace xaya
 {
@@ -32,19 +32,6 @@ constexpr int MEM_LEVEL = 9;
 class BasicZlibStream
 {
 
-private:
-
-  /**
-   * Buffer for the output data.  We allocate it up to the maximum size,
-   * which might be a lot bigger than what we really need.  Thus we avoid
-   * using std::string here, which would unnecessarily fill the buffer up
-   * with zeros of that larger length.
-   */
-  std::unique_ptr<char[]> output;
-
-  /** Size of the allocated buffer.  */
-  size_t outputSize;
-
 protected:
 
   /** The underlying zlib stream struct.  */
@@ -76,32 +63,19 @@ protected:
   void
   SetInput (const std::string& input)
   {
-    const Bytef* inputBuf = reinterpret_cast<const Bytef*> (input.data ());
-    stream.next_in = const_cast<Bytef*> (inputBuf);
-    stream.avail_in = input.size ();
+    SetInput (input.data (), input.size ());
   }
 
   /**
-   * Sets the size of the output buffer, and points the stream to it.
+   * Fills in the input in the stream struct to reference the given
+   * memory range.
    */
   void
-  SetOutputSize (const size_t sz)
+  SetInput (const char* data, const size_t len)
   {
-    outputSize = sz;
-    output.reset (new char[outputSize]);
-    stream.next_out = reinterpret_cast<Bytef*> (output.get ());
-    stream.avail_out = outputSize;
-  }
-
-  /**
-   * Returns the output with correct length (as per the stream's total_out)
-   * as a string.
-   */
-  std::string
-  ExtractOutput () const
-  {
-    CHECK_LE (stream.total_out, outputSize);
-    return std::string (output.get (), stream.total_out);
+    const Bytef* inputBuf = reinterpret_cast<const Bytef*> (data);
+    stream.next_in = const_cast<Bytef*> (inputBuf);
+    stream.avail_in = len;
   }
 
 };
@@ -133,8 +107,11 @@ public:
    */
   ~DeflateStream ()
   {
+    /* Z_DATA_ERROR signals that the stream was not finished, which is the
+       case for chunks compressed with Z_SYNC_FLUSH.  */
     const auto res = deflateEnd (&stream);
-    CHECK_EQ (res, Z_OK) << "Deflate end error " << res << ": " << GetError ();
+    CHECK (res == Z_OK || res == Z_DATA_ERROR)
+        << "Deflate end error " << res << ": " << GetError ();
   }
 
   /**
@@ -153,6 +130,66 @@ public:
         << "Set dictionary error " << res << ": " << GetError ();
   }
 
+  /**
+   * Primes the compressor with preceding data, which the decompressor
+   * will already have in its history window when it reaches the data
+   * compressed next.  This is used to compress data in independent chunks
+   * (where each chunk's output is a continuation of the same raw deflate
+   * stream).  Unlike SetDictionary, the result is still accepted by
+   * UncompressData.
+   */
+  void
+  PrimeHistory (const char* data, const size_t len)
+  {
+    const Bytef* buf = reinterpret_cast<const Bytef*> (data);
+    const auto res = deflateSetDictionary (&stream, buf, len);
+    CHECK_EQ (res, Z_OK) << "Prime history error " << res << ": " << GetError ();
+  }
+
+  /**
+   * Compresses the given range of data with the given flush mode, and returns
+   * the output produced.  With Z_FINISH, this completes the stream.  With
+   * Z_SYNC_FLUSH, the output ends on a byte boundary without marking the
+   * final block, so that more compressed data can be appended to it.
+   */
+  std::string
+  Deflate (const char* data, const size_t len, const int flush)
+  {
+    CHECK (flush == Z_FINISH || flush == Z_SYNC_FLUSH)
+        << "Unsupported flush mode " << flush;
+
+    SetInput (data, len);
+
+    /* deflateBound is usually enough, but not necessarily in all cases
+       (e.g. with compression level zero or when flushing), so we grow the
+       buffer if needed.  */
+    std::string output(deflateBound (&stream, len), '\0');
+    size_t written = 0;
+    while (true)
+      {
+        stream.next_out = reinterpret_cast<Bytef*> (&output[written]);
+        stream.avail_out = output.size () - written;
+
+        const auto res = deflate (&stream, flush);
+        written = output.size () - stream.avail_out;
+
+        if (flush == Z_FINISH && res == Z_STREAM_END)
+          break;
+        CHECK (res == Z_OK || res == Z_BUF_ERROR)
+            << "Deflate error " << res << ": " << GetError ();
+        if (flush == Z_SYNC_FLUSH && stream.avail_out > 0)
+          break;
+
+        output.resize (2 * output.size () + 64);
+      }
+    CHECK_EQ (stream.avail_in, 0);
+
+    output.resize (written);
+    VLOG (2) << "Compressed " << len << " bytes to " << output.size ();
+
+    return output;
+  }
+
   /**
    * Performs the actual compression of input data, using our stream.
    * This function must be called only once on the instance.
@@ -161,21 +198,13 @@ public:
   Compress (const std::string& data)
   {
     uInt dictLength;
-    auto res = deflateGetDictionary (&stream, Z_NULL, &dictLength);
+    const auto res = deflateGetDictionary (&stream, Z_NULL, &dictLength);
     CHECK_EQ (res, Z_OK)
         << "Get dictionary length error " << res << ": " << GetError ();
 
-    SetInput (data);
-    SetOutputSize (deflateBound (&stream, data.size ()));
-
-    res = deflate (&stream, Z_FINISH);
-    CHECK_EQ (res, Z_STREAM_END)
-        << "Deflate error " << res << ": " << GetError ();
+    std::string output = Deflate (data.data (), data.size (), Z_FINISH);
     CHECK_EQ (stream.total_in, dictLength + data.size ());
 
-    const std::string output = ExtractOutput ();
-    VLOG (2) << "Compressed " << data.size () << " bytes to " << output.size ();
-
     return output;
   }
 
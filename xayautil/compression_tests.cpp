@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2020 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -9,6 +9,7 @@
 #include <gtest/gtest.h>
 
 #include <sstream>
+#include <string>
 #include <vector>
 
 namespace xaya
@@ -79,6 +80,116 @@ TEST_F (CompressionTests, MaxOutputSize)
   ExpectInvalidUncompress (compressed, input.size () - 1);
 }
 
+TEST_F (CompressionTests, OutputGrowth)
+{
+  /* Data that compresses very well, so that the output buffer needs to
+     be grown multiple times from its initial size.  */
+  std::string input;
+  for (unsigned i = 0; i < 100'000; ++i)
+    input.push_back ('a' + i % 3);
+  const std::string compressed = CompressData (input);
+
+  ExpectValidUncompress (compressed, input.size (), input);
+  ExpectValidUncompress (compressed, input.size () + 1, input);
+  ExpectValidUncompress (compressed, 1'000'000'000, input);
+  ExpectInvalidUncompress (compressed, input.size () - 1);
+  ExpectInvalidUncompress (compressed, input.size () / 2);
+  ExpectInvalidUncompress (compressed, 0);
+}
+
+TEST_F (CompressionTests, TruncatedAndTrailingData)
+{
+  std::string input;
+  for (unsigned i = 0; i < 10'000; ++i)
+    input.append (std::to_string (i));
+  const std::string compressed = CompressData (input);
+
+  ExpectInvalidUncompress (compressed.substr (0, compressed.size () - 1),
+                           input.size ());
+  ExpectInvalidUncompress (compressed.substr (0, compressed.size () / 2),
+                           input.size ());
+  ExpectInvalidUncompress (compressed + "x", input.size ());
+}
+
+TEST_F (CompressionTests, RepeatedCalls)
+{
+  /* The inflate state is reused between calls, so make sure that an
+     invalid or aborted call does not affect later ones.  */
+  const std::string input = "foobar";
+  const std::string compressed = CompressData (input);
+
+  for (unsigned i = 0; i < 10; ++i)
+    {
+      ExpectInvalidUncompress ("invalid", 1'000);
+      ExpectInvalidUncompress (compressed, input.size () - 1);
+      ExpectInvalidUncompress (compressed.substr (0, 3), input.size ());
+      ExpectValidUncompress (compressed, input.size (), input);
+    }
+}
+
+TEST_F (CompressionTests, ParallelRoundTrip)
+{
+  std::string text;
+  for (unsigned i = 0; text.size () < 500'000; ++i)
+    text.append (R"({"move":)" + std::to_string (i * i % 977) + "},");
+
+  std::string binary;
+  for (unsigned i = 0; i < 200'000; ++i)
+    binary.push_back (static_cast<char> ((i * 2'654'435'761u) >> 24));
+
+  for (const auto& str : {text, binary})
+    for (const size_t chunkSize : {1, 1'000, 40'000, 65'536, 1'000'000})
+      {
+        if (chunkSize == 1 && str.size () > 10'000)
+          {
+            const std::string part = str.substr (0, 10'000);
+            ExpectValidUncompress (CompressDataParallel (part, chunkSize),
+                                   part.size (), part);
+            continue;
+          }
+
+        const std::string compressed = CompressDataParallel (str, chunkSize);
+        ExpectValidUncompress (compressed, str.size (), str);
+        ExpectInvalidUncompress (compressed, str.size () - 1);
+      }
+}
+
+TEST_F (CompressionTests, ParallelDeterministic)
+{
+  std::string input;
+  for (unsigned i = 0; i < 300'000; ++i)
+    input.append (std::to_string (i % 1'234));
+
+  const std::string expected = CompressDataParallel (input, 50'000, 1);
+  for (const unsigned threads : {0, 2, 3, 8, 100})
+    EXPECT_EQ (CompressDataParallel (input, 50'000, threads), expected);
+}
+
+TEST_F (CompressionTests, ParallelSingleChunk)
+{
+  const std::string input = "foobar foobar foobar";
+  EXPECT_EQ (CompressDataParallel (input), CompressData (input));
+  EXPECT_EQ (CompressDataParallel (input, input.size (), 4),
+             CompressData (input));
+  EXPECT_EQ (CompressDataParallel (""), CompressData (""));
+}
+
+TEST_F (CompressionTests, ParallelUsesHistory)
+{
+  /* Each chunk is primed with the preceding data, so that repetitions across
+     chunk boundaries are still compressed well.  */
+  std::string block;
+  for (unsigned i = 0; i < 10'000; ++i)
+    block.push_back (static_cast<char> ((i * 2'654'435'761u) >> 24));
+  std::string input;
+  for (unsigned i = 0; i < 10; ++i)
+    input.append (block);
+
+  const std::string compressed = CompressDataParallel (input, block.size ());
+  ExpectValidUncompress (compressed, input.size (), input);
+  EXPECT_LT (compressed.size (), 2 * block.size ());
+}
+
 TEST_F (CompressionTests, InvalidData)
 {
   ExpectInvalidUncompress ("not valid compressed data", 100);
@@ -253,6 +364,71 @@ TEST_F (JsonCompressionTests, StackLimit)
   EXPECT_EQ (output, input);
 }
 
+TEST_F (JsonCompressionTests, WithoutUncompressedString)
+{
+  const auto input = ParseJson (R"({"foo":[1,2,3],"bar":null})");
+
+  std::string encoded;
+  std::string uncompressed;
+  ASSERT_TRUE (CompressJson (input, encoded, uncompressed));
+
+  Json::Value output;
+  ASSERT_TRUE (UncompressJson (encoded, 100, 10, output));
+  EXPECT_EQ (output, input);
+
+  EXPECT_FALSE (UncompressJson (encoded, uncompressed.size () - 1, 10,
+                                output));
+  EXPECT_FALSE (UncompressJson ("invalid base64", 100, 10, output));
+}
+
+TEST_F (JsonCompressionTests, WithoutUncompressedStringBufferReuse)
+{
+  /* The uncompressed data is inflated into a reused buffer, so make sure
+     that data from earlier (larger) calls does not leak into later ones.  */
+  Json::Value large(Json::arrayValue);
+  for (unsigned i = 0; i < 20'000; ++i)
+    large.append (static_cast<int> (i));
+  Json::Value medium(Json::arrayValue);
+  for (unsigned i = 0; i < 1'000; ++i)
+    medium.append ("foo");
+  const auto small = ParseJson (R"({"a":1})");
+
+  for (const auto& input : {large, medium, small, medium})
+    {
+      std::string encoded;
+      std::string uncompressed;
+      ASSERT_TRUE (CompressJson (input, encoded, uncompressed));
+
+      Json::Value output;
+      ASSERT_TRUE (UncompressJson (encoded, 1 << 20, 10, output));
+      EXPECT_EQ (output, input);
+    }
+}
+
+TEST_F (JsonCompressionTests, RepeatedCalls)
+{
+  /* The JSON readers are reused between calls, so make sure that failures
+     and different stack limits do not affect later calls.  */
+  const auto nested = ParseJson (R"([[[[{}]]]])");
+  const auto flat = ParseJson (R"({"a":1})");
+
+  std::string encodedNested, encodedFlat, encodedInvalid, uncompressed;
+  ASSERT_TRUE (CompressJson (nested, encodedNested, uncompressed));
+  ASSERT_TRUE (CompressJson (flat, encodedFlat, uncompressed));
+  encodedInvalid = EncodeBase64 (CompressData (R"({"a":1,"a":2})"));
+
+  for (unsigned i = 0; i < 5; ++i)
+    {
+      Json::Value output;
+      EXPECT_FALSE (UncompressJson (encodedNested, 100, 4, output));
+      EXPECT_FALSE (UncompressJson (encodedInvalid, 100, 4, output));
+      ASSERT_TRUE (UncompressJson (encodedFlat, 100, 4, output));
+      EXPECT_EQ (output, flat);
+      ASSERT_TRUE (UncompressJson (encodedNested, 100, 5, output));
+      EXPECT_EQ (output, nested);
+    }
+}
+
 TEST_F (JsonCompressionTests, InvalidBase64)
 {
   Json::Value output;
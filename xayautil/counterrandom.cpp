@@ -0,0 +1,179 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "counterrandom.hpp"
+
+#include "hash.hpp"
+#include "random_internal.hpp"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <string>
+
+namespace xaya
+{
+
+namespace
+{
+
+/**
+ * Maximum number of blocks that Fill computes in one batch.  This bounds
+ * the temporary memory used for very large requests.
+ */
+constexpr size_t MAX_BATCH_BLOCKS = 64;
+
+/**
+ * Returns the message that is hashed for the block with the given index.
+ */
+std::string
+GetBlockMessage (const uint256& seed, const uint64_t index)
+{
+  std::string res = seed.GetBinaryString ();
+  for (int shift = 56; shift >= 0; shift -= 8)
+    res.push_back (static_cast<char> ((index >> shift) & 0xFF));
+
+  return res;
+}
+
+} // anonymous namespace
+
+CounterRandom::CounterRandom ()
+  : position(0), blockIndex(0), haveBlock(false)
+{
+  seed.SetNull ();
+}
+
+void
+CounterRandom::Seed (const uint256& s)
+{
+  seed = s;
+  position = 0;
+  haveBlock = false;
+}
+
+void
+CounterRandom::Seek (const uint64_t pos)
+{
+  position = pos;
+}
+
+std::vector<uint256>
+CounterRandom::ComputeBlocks (const uint256& seed, const uint64_t first,
+                              const size_t n)
+{
+  std::vector<std::string> messages;
+  messages.reserve (n);
+  for (size_t i = 0; i < n; ++i)
+    messages.push_back (GetBlockMessage (seed, first + i));
+
+  return SHA256::HashBatch (messages);
+}
+
+const uint256&
+CounterRandom::GetBlock (const uint64_t index)
+{
+  if (!haveBlock || blockIndex != index)
+    {
+      block = SHA256::Hash (GetBlockMessage (seed, index));
+      blockIndex = index;
+      haveBlock = true;
+    }
+
+  return block;
+}
+
+void
+CounterRandom::Fill (unsigned char* out, size_t n)
+{
+  CHECK (!seed.IsNull ()) << "CounterRandom instance has not been seeded";
+
+  while (n > 0)
+    {
+      const uint64_t index = position / BLOCK_SIZE;
+      const size_t offset = position % BLOCK_SIZE;
+
+      /* If we need multiple full blocks, compute them in a batch.  */
+      const size_t fullBlocks = n / BLOCK_SIZE;
+      if (offset == 0 && fullBlocks > 1)
+        {
+          const size_t cnt = std::min (fullBlocks, MAX_BATCH_BLOCKS);
+          for (const auto& b : ComputeBlocks (seed, index, cnt))
+            {
+              std::copy (b.GetBlob (), b.GetBlob () + BLOCK_SIZE, out);
+              out += BLOCK_SIZE;
+            }
+
+          n -= cnt * BLOCK_SIZE;
+          position += cnt * BLOCK_SIZE;
+          continue;
+        }
+
+      const size_t cnt = std::min (n, BLOCK_SIZE - offset);
+      const unsigned char* data = GetBlock (index).GetBlob () + offset;
+      std::copy (data, data + cnt, out);
+
+      out += cnt;
+      n -= cnt;
+      position += cnt;
+    }
+}
+
+template <>
+  unsigned char
+  CounterRandom::Next<unsigned char> ()
+{
+  unsigned char res;
+  Fill (&res, 1);
+  return res;
+}
+
+template <>
+  bool
+  CounterRandom::Next<bool> ()
+{
+  return Next<unsigned char> () & 1;
+}
+
+template <>
+  uint16_t
+  CounterRandom::Next<uint16_t> ()
+{
+  return NextBigEndian<uint16_t> (*this);
+}
+
+template <>
+  uint32_t
+  CounterRandom::Next<uint32_t> ()
+{
+  return NextBigEndian<uint32_t> (*this);
+}
+
+template <>
+  uint64_t
+  CounterRandom::Next<uint64_t> ()
+{
+  return NextBigEndian<uint64_t> (*this);
+}
+
+uint32_t
+CounterRandom::NextInt (const uint32_t n)
+{
+  return NextIntFrom (*this, n);
+}
+
+bool
+CounterRandom::ProbabilityRoll (uint32_t numer, uint32_t denom)
+{
+  const auto val = NextInt (denom);
+  return val < numer;
+}
+
+size_t
+CounterRandom::SelectByWeight (const std::vector<uint32_t>& weights)
+{
+  return SelectByWeightFrom (*this, weights);
+}
+
+} // namespace xaya
@@ -0,0 +1,165 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef XAYAUTIL_COUNTERRANDOM_HPP
+#define XAYAUTIL_COUNTERRANDOM_HPP
+
+#include "uint256.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace xaya
+{
+
+/**
+ * Deterministic "random" number generator based on an initial seed, like
+ * Random, but in counter mode:  The byte stream consists of 32-byte blocks,
+ * where block k is SHA-256 of the seed's 32 bytes followed by k as 64-bit
+ * big-endian integer.  Since each block can be computed independently, the
+ * position in the stream can be changed freely (e.g. to jump ahead), and
+ * many blocks can be computed in one batched hash call.
+ *
+ * This allows splitting up computations across threads with reproducible
+ * results, for instance by having each entity use its own CounterRandom
+ * seeded from a block of a parent stream (see ComputeBlocks), or by giving
+ * each worker a fixed range of positions in one stream.
+ *
+ * The interface for extracting numbers mirrors Random, and the methods
+ * that do not directly extract bytes (e.g. NextInt or Shuffle) use exactly
+ * the same algorithms.  The byte streams of the two classes differ, though.
+ */
+class CounterRandom
+{
+
+private:
+
+  /** The seed of the stream.  */
+  uint256 seed;
+
+  /** Position (in bytes) of the next byte to give out.  */
+  uint64_t position;
+
+  /** The most recently computed block.  */
+  uint256 block;
+
+  /** Index of the block that is cached in block.  */
+  uint64_t blockIndex;
+
+  /** Whether or not block holds a valid cached value.  */
+  bool haveBlock;
+
+  /**
+   * Returns the block with the given index, using the cached one
+   * if possible.
+   */
+  const uint256& GetBlock (uint64_t index);
+
+public:
+
+  /** Number of bytes per block of the stream.  */
+  static constexpr size_t BLOCK_SIZE = uint256::NUM_BYTES;
+
+  /**
+   * Constructs an empty instance that is not yet seeded.  It must not be
+   * used to extract any random bytes before Seed() has been called.
+   */
+  CounterRandom ();
+
+  CounterRandom (CounterRandom&&) = default;
+  CounterRandom& operator= (CounterRandom&&) = default;
+
+  CounterRandom (const CounterRandom&) = delete;
+  void operator= (const CounterRandom&) = delete;
+
+  /**
+   * Sets / replaces the seed with the given value, and resets the position
+   * to the start of the stream.
+   */
+  void Seed (const uint256& s);
+
+  /**
+   * Returns the current position (in bytes) in the stream.
+   */
+  uint64_t
+  GetPosition () const
+  {
+    return position;
+  }
+
+  /**
+   * Sets the position (in bytes) in the stream.  This is cheap, as no
+   * blocks need to be computed for the skipped-over range.
+   */
+  void Seek (uint64_t pos);
+
+  /**
+   * Skips over the next n bytes of the stream.
+   */
+  void
+  Skip (const uint64_t n)
+  {
+    Seek (position + n);
+  }
+
+  /**
+   * Fills the given buffer with the next n bytes of the stream.  Longer
+   * requests compute all the required blocks in batches with
+   * SHA256::HashBatch.
+   */
+  void Fill (unsigned char* out, size_t n);
+
+  /**
+   * Extracts the next byte or perhaps other type (e.g. uint32_t).
+   * Integers are assembled from the bytes in big-endian order.
+   */
+  template <typename T>
+    T Next ();
+
+  /**
+   * Returns a random integer i with 0 <= i < n.
+   */
+  uint32_t NextInt (uint32_t n);
+
+  /**
+   * Performs a random roll and returns true with probability numer/denom.
+   */
+  bool ProbabilityRoll (uint32_t numer, uint32_t denom);
+
+  /**
+   * Selects one entry randomly from a given set of choices,
+   * like Random::SelectByWeight.
+   */
+  size_t SelectByWeight (const std::vector<uint32_t>& weights);
+
+  /**
+   * Randomly permutes the given range of random-access iterators.
+   */
+  template <typename Iterator>
+    void Shuffle (Iterator begin, Iterator end);
+
+  /**
+   * Randomly permutes the given range with at most N operations performed,
+   * like Random::ShuffleN.
+   */
+  template <typename Iterator>
+    void ShuffleN (Iterator begin, Iterator end, size_t n);
+
+  /**
+   * Computes n consecutive blocks of the stream for the given seed,
+   * starting at block index first.  This uses a single batched hash
+   * call, and can e.g. be used to derive seeds for many independent
+   * substreams at once.
+   */
+  static std::vector<uint256> ComputeBlocks (const uint256& seed,
+                                             uint64_t first, size_t n);
+
+};
+
+} // namespace xaya
+
+#include "counterrandom.tpp"
+
+#endif // XAYAUTIL_COUNTERRANDOM_HPP
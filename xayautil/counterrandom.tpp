@@ -0,0 +1,32 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+/* Template code for counterrandom.hpp.  */
+
+#include <algorithm>
+
+namespace xaya
+{
+
+template <typename Iterator>
+  void
+  CounterRandom::Shuffle (Iterator begin, Iterator end)
+{
+  ShuffleN (begin, end, end - begin);
+}
+
+template <typename Iterator>
+  void
+  CounterRandom::ShuffleN (Iterator begin, Iterator end, const size_t n)
+{
+  size_t steps = n;
+  for (; end - begin > 1 && steps > 0; ++begin, --steps)
+    {
+      const Iterator mid = begin + NextInt (end - begin);
+      if (begin != mid)
+        std::swap (*begin, *mid);
+    }
+}
+
+} // namespace xaya
@@ -1,4 +1,4 @@
-// Copyright (C) 2019 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -8,55 +8,313 @@
 
 #include <openssl/sha.h>
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <new>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+# define XAYAUTIL_SHA256_X86 1
+# include <immintrin.h>
+#endif
 
 namespace xaya
 {
 
+namespace
+{
+
+#ifdef XAYAUTIL_SHA256_X86
+
+/** Size of an input block.  */
+constexpr size_t BLOCK_SIZE = 64;
+
+/** Initial chaining state of SHA-256.  */
+constexpr uint32_t INITIAL_STATE[8] = {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+  0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+/** The SHA-256 round constants.  */
+constexpr uint32_t K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+  0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+  0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+  0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+  0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+  0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+/** Size of the final length field in the padding.  */
+constexpr size_t LENGTH_SIZE = 8;
+
+inline uint32_t
+ReadBE32 (const unsigned char* ptr)
+{
+  return (static_cast<uint32_t> (ptr[0]) << 24)
+            | (static_cast<uint32_t> (ptr[1]) << 16)
+            | (static_cast<uint32_t> (ptr[2]) << 8)
+            | static_cast<uint32_t> (ptr[3]);
+}
+
+inline void
+WriteBE32 (unsigned char* ptr, const uint32_t val)
+{
+  ptr[0] = val >> 24;
+  ptr[1] = val >> 16;
+  ptr[2] = val >> 8;
+  ptr[3] = val;
+}
+
+/**
+ * Writes the final digest for a chaining state into a uint256.
+ */
+uint256
+StateToDigest (const uint32_t* s)
+{
+  unsigned char bytes[uint256::NUM_BYTES];
+  for (size_t i = 0; i < 8; ++i)
+    WriteBE32 (bytes + 4 * i, s[i]);
+
+  uint256 res;
+  res.FromBlob (bytes);
+  return res;
+}
+
 /**
- * The actual implementation for the SHA256 state.  This is just a wrapper
- * around OpenSSL's SHA256_CTX.
+ * Fills in the final padding blocks for a message of the given total length,
+ * whose last, incomplete block is passed in tail.  The output buffer must
+ * have space for two blocks.  Returns the number of blocks written (either
+ * one or two).
  */
-class SHA256::State
+size_t
+BuildPaddingBlocks (const unsigned char* tail, const uint64_t len,
+                    unsigned char* out)
 {
+  const size_t rem = len % BLOCK_SIZE;
+  const size_t blocks
+      = (rem + 1 + LENGTH_SIZE <= BLOCK_SIZE ? 1 : 2);
 
-private:
+  std::fill (out, out + blocks * BLOCK_SIZE, 0);
+  std::copy (tail, tail + rem, out);
+  out[rem] = 0x80;
 
-  /** The underlying OpenSSL SHA256 state.  */
-  SHA256_CTX ctx;
+  const uint64_t bits = len << 3;
+  unsigned char* lenPtr = out + blocks * BLOCK_SIZE - LENGTH_SIZE;
+  WriteBE32 (lenPtr, bits >> 32);
+  WriteBE32 (lenPtr + 4, bits);
 
-public:
+  return blocks;
+}
 
-  State ();
+/** Number of messages processed in parallel by the AVX2 code.  */
+constexpr size_t AVX2_LANES = 8;
 
-  State (const State&) = delete;
-  void operator= (const State&) = delete;
+#define XAYAUTIL_AVX2 __attribute__ ((target ("avx2")))
 
-  void Update (const unsigned char* data, size_t len);
-  void Finalise (unsigned char* out);
+XAYAUTIL_AVX2 inline __m256i
+Ror8 (const __m256i x, const int n)
+{
+  return _mm256_or_si256 (_mm256_srli_epi32 (x, n),
+                          _mm256_slli_epi32 (x, 32 - n));
+}
 
-};
+XAYAUTIL_AVX2 inline __m256i
+Xor3 (const __m256i a, const __m256i b, const __m256i c)
+{
+  return _mm256_xor_si256 (_mm256_xor_si256 (a, b), c);
+}
 
-SHA256::State::State ()
+/**
+ * Applies the SHA-256 compression function to one block each of eight
+ * independent messages, using one AVX2 lane (32 bits) per message.
+ * The state is held "transposed", i.e. s[i] contains word i of the
+ * state of all messages.
+ */
+XAYAUTIL_AVX2 void
+TransformAvx2 (__m256i* s, const unsigned char* const* chunks)
 {
-  SHA256_Init (&ctx);
+  __m256i w[16];
+  for (int i = 0; i < 16; ++i)
+    w[i] = _mm256_setr_epi32 (
+        ReadBE32 (chunks[0] + 4 * i), ReadBE32 (chunks[1] + 4 * i),
+        ReadBE32 (chunks[2] + 4 * i), ReadBE32 (chunks[3] + 4 * i),
+        ReadBE32 (chunks[4] + 4 * i), ReadBE32 (chunks[5] + 4 * i),
+        ReadBE32 (chunks[6] + 4 * i), ReadBE32 (chunks[7] + 4 * i));
+
+  __m256i a = s[0], b = s[1], c = s[2], d = s[3];
+  __m256i e = s[4], f = s[5], g = s[6], h = s[7];
+  for (int i = 0; i < 64; ++i)
+    {
+      /* The message schedule is computed on the fly in a rolling window
+         of the last 16 words.  */
+      if (i >= 16)
+        {
+          const __m256i w15 = w[(i - 15) % 16];
+          const __m256i w2 = w[(i - 2) % 16];
+          const __m256i s0 = Xor3 (Ror8 (w15, 7), Ror8 (w15, 18),
+                                   _mm256_srli_epi32 (w15, 3));
+          const __m256i s1 = Xor3 (Ror8 (w2, 17), Ror8 (w2, 19),
+                                   _mm256_srli_epi32 (w2, 10));
+          w[i % 16] = _mm256_add_epi32 (
+              _mm256_add_epi32 (w[i % 16], s0),
+              _mm256_add_epi32 (w[(i - 7) % 16], s1));
+        }
+
+      const __m256i ch
+          = _mm256_xor_si256 (g, _mm256_and_si256 (e, _mm256_xor_si256 (f, g)));
+      const __m256i maj
+          = _mm256_or_si256 (_mm256_and_si256 (a, b),
+                             _mm256_and_si256 (c, _mm256_or_si256 (a, b)));
+
+      __m256i t1 = _mm256_add_epi32 (h, Xor3 (Ror8 (e, 6), Ror8 (e, 11),
+                                              Ror8 (e, 25)));
+      t1 = _mm256_add_epi32 (t1, ch);
+      t1 = _mm256_add_epi32 (t1, _mm256_set1_epi32 (K[i]));
+      t1 = _mm256_add_epi32 (t1, w[i % 16]);
+      const __m256i t2 = _mm256_add_epi32 (
+          Xor3 (Ror8 (a, 2), Ror8 (a, 13), Ror8 (a, 22)), maj);
+
+      h = g;
+      g = f;
+      f = e;
+      e = _mm256_add_epi32 (d, t1);
+      d = c;
+      c = b;
+      b = a;
+      a = _mm256_add_epi32 (t1, t2);
+    }
+
+  s[0] = _mm256_add_epi32 (s[0], a);
+  s[1] = _mm256_add_epi32 (s[1], b);
+  s[2] = _mm256_add_epi32 (s[2], c);
+  s[3] = _mm256_add_epi32 (s[3], d);
+  s[4] = _mm256_add_epi32 (s[4], e);
+  s[5] = _mm256_add_epi32 (s[5], f);
+  s[6] = _mm256_add_epi32 (s[6], g);
+  s[7] = _mm256_add_epi32 (s[7], h);
 }
 
-void
-SHA256::State::Update (const unsigned char* data, const size_t len)
+/**
+ * Hashes up to eight messages in parallel with AVX2.  Messages of different
+ * lengths are supported; lanes whose message is already finished process
+ * dummy blocks, and their state is left unchanged.
+ */
+XAYAUTIL_AVX2 void
+HashAvx2 (const std::string* data, const size_t num, uint256* out)
 {
-  SHA256_Update (&ctx, data, len);
+  CHECK_LE (num, AVX2_LANES);
+
+  static const unsigned char zeroBlock[BLOCK_SIZE] = {};
+
+  size_t fullBlocks[AVX2_LANES];
+  size_t totalBlocks[AVX2_LANES];
+  unsigned char tails[AVX2_LANES][2 * BLOCK_SIZE];
+  size_t maxBlocks = 0;
+  for (size_t l = 0; l < num; ++l)
+    {
+      const auto* ptr
+          = reinterpret_cast<const unsigned char*> (data[l].data ());
+      fullBlocks[l] = data[l].size () / BLOCK_SIZE;
+      totalBlocks[l] = fullBlocks[l]
+          + BuildPaddingBlocks (ptr + fullBlocks[l] * BLOCK_SIZE,
+                                data[l].size (), tails[l]);
+      maxBlocks = std::max (maxBlocks, totalBlocks[l]);
+    }
+
+  __m256i s[8];
+  for (int i = 0; i < 8; ++i)
+    s[i] = _mm256_set1_epi32 (INITIAL_STATE[i]);
+
+  for (size_t j = 0; j < maxBlocks; ++j)
+    {
+      const unsigned char* chunks[AVX2_LANES];
+      alignas (32) int32_t active[AVX2_LANES];
+      for (size_t l = 0; l < AVX2_LANES; ++l)
+        {
+          active[l] = (l < num && j < totalBlocks[l] ? -1 : 0);
+          if (!active[l])
+            chunks[l] = zeroBlock;
+          else if (j < fullBlocks[l])
+            chunks[l] = reinterpret_cast<const unsigned char*> (data[l].data ())
+                          + j * BLOCK_SIZE;
+          else
+            chunks[l] = tails[l] + (j - fullBlocks[l]) * BLOCK_SIZE;
+        }
+
+      __m256i updated[8];
+      std::copy (s, s + 8, updated);
+      TransformAvx2 (updated, chunks);
+
+      const __m256i mask
+          = _mm256_load_si256 (reinterpret_cast<const __m256i*> (active));
+      for (int i = 0; i < 8; ++i)
+        s[i] = _mm256_blendv_epi8 (s[i], updated[i], mask);
+    }
+
+  alignas (32) uint32_t words[8][AVX2_LANES];
+  for (int i = 0; i < 8; ++i)
+    _mm256_store_si256 (reinterpret_cast<__m256i*> (words[i]), s[i]);
+
+  for (size_t l = 0; l < num; ++l)
+    {
+      uint32_t laneState[8];
+      for (int i = 0; i < 8; ++i)
+        laneState[i] = words[i][l];
+      out[l] = StateToDigest (laneState);
+    }
 }
 
-void
-SHA256::State::Finalise (unsigned char* out)
+#undef XAYAUTIL_AVX2
+
+/**
+ * Returns true if HashBatch should use the AVX2 code.  This is the case
+ * if AVX2 is supported, but not the SHA extensions (with which OpenSSL's
+ * single-message implementation is faster).
+ */
+bool
+UseAvx2Batch ()
 {
-  SHA256_Final (out, &ctx);
+  static const bool res = [] ()
+    {
+      /* __builtin_cpu_supports also checks that the OS has enabled the
+         AVX register state, so that we do not run into SIGILL on systems
+         (e.g. VMs) that mask AVX even if the CPU supports it.  */
+      __builtin_cpu_init ();
+      const bool avx2 = __builtin_cpu_supports ("avx2");
+      const bool sha = __builtin_cpu_supports ("sha");
+      VLOG (1) << "CPU support for SHA-256: AVX2 " << avx2 << ", SHA " << sha;
+
+      return avx2 && !sha;
+    } ();
+
+  return res;
 }
 
+#endif // XAYAUTIL_SHA256_X86
+
+} // anonymous namespace
+
 SHA256::SHA256 ()
+  : finalised(false)
 {
-  state = std::make_unique<State> ();
+  static_assert (sizeof (SHA256_CTX) <= STATE_SIZE,
+                 "SHA256::STATE_SIZE is too small for SHA256_CTX");
+  static_assert (alignof (SHA256_CTX) <= 16,
+                 "SHA256::state is not aligned enough for SHA256_CTX");
+
+  auto* ctx = new (state) SHA256_CTX;
+  SHA256_Init (ctx);
 }
 
 SHA256::~SHA256 () = default;
@@ -64,17 +322,18 @@ SHA256::~SHA256 () = default;
 SHA256&
 SHA256::operator<< (const std::string& data)
 {
-  CHECK (state != nullptr);
-  state->Update (reinterpret_cast<const unsigned char*> (&data[0]),
-                 data.size ());
+  CHECK (!finalised);
+  SHA256_Update (reinterpret_cast<SHA256_CTX*> (state),
+                 data.data (), data.size ());
   return *this;
 }
 
 SHA256&
 SHA256::operator<< (const uint256& data)
 {
-  CHECK (state != nullptr);
-  state->Update (data.GetBlob (), uint256::NUM_BYTES);
+  CHECK (!finalised);
+  SHA256_Update (reinterpret_cast<SHA256_CTX*> (state),
+                 data.GetBlob (), uint256::NUM_BYTES);
   return *this;
 }
 
@@ -84,10 +343,11 @@ SHA256::Finalise ()
   static_assert (SHA256_DIGEST_LENGTH == uint256::NUM_BYTES,
                  "uint256 is not a valid output for SHA-256");
 
-  CHECK (state != nullptr);
+  CHECK (!finalised);
+  finalised = true;
 
   unsigned char data[SHA256_DIGEST_LENGTH];
-  state->Finalise (data);
+  SHA256_Final (data, reinterpret_cast<SHA256_CTX*> (state));
 
   uint256 res;
   res.FromBlob (data);
@@ -103,4 +363,25 @@ SHA256::Hash (const std::string& data)
   return hasher.Finalise ();
 }
 
+std::vector<uint256>
+SHA256::HashBatch (const std::vector<std::string>& data)
+{
+  std::vector<uint256> res(data.size ());
+
+#ifdef XAYAUTIL_SHA256_X86
+  if (UseAvx2Batch ())
+    {
+      for (size_t i = 0; i < data.size (); i += AVX2_LANES)
+        HashAvx2 (data.data () + i,
+                  std::min (AVX2_LANES, data.size () - i), res.data () + i);
+      return res;
+    }
+#endif // XAYAUTIL_SHA256_X86
+
+  for (size_t i = 0; i < data.size (); ++i)
+    res[i] = Hash (data[i]);
+
+  return res;
+}
+
 } // namespace xaya
@@ -1,4 +1,4 @@
-// Copyright (C) 2019 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -7,8 +7,9 @@
 
 #include "uint256.hpp"
 
-#include <memory>
+#include <cstddef>
 #include <string>
+#include <vector>
 
 namespace xaya
 {
@@ -23,15 +24,18 @@ class SHA256
 
 private:
 
+  /** Size reserved for the underlying hasher state.  */
+  static constexpr size_t STATE_SIZE = 128;
+
   /**
-   * Holder for the internal state.  This is not exposed here in the header,
-   * so that the dependency on the underlying library (e.g. OpenSSL) is
-   * kept as a pure implementation detail.
+   * Storage for the underlying hasher state.  The concrete type (e.g. from
+   * OpenSSL) is kept as implementation detail in hash.cpp, but its storage
+   * is held inline so that hashing does not require any heap allocations.
    */
-  class State;
+  alignas (16) unsigned char state[STATE_SIZE];
 
-  /** The underlying current state of the hasher.  */
-  std::unique_ptr<State> state;
+  /** Set to true once Finalise has been called.  */
+  bool finalised;
 
 public:
 
@@ -56,6 +60,15 @@ public:
    */
   static uint256 Hash (const std::string& data);
 
+  /**
+   * Hashes a batch of independent messages and returns their hashes
+   * (in the same order).  It yields the same results as calling Hash
+   * on each message, but uses the fastest method available on the CPU.
+   * In particular, if the CPU supports AVX2 but not the SHA extensions,
+   * eight messages are processed in parallel.
+   */
+  static std::vector<uint256> HashBatch (const std::vector<std::string>& data);
+
 };
 
 } // namespace xaya
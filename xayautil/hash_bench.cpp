@@ -0,0 +1,94 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "hash.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <openssl/sha.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace xaya
+{
+namespace
+{
+
+/**
+ * Hashes data with OpenSSL's legacy SHA256 API and a heap-allocated
+ * context, which is what the original implementation of SHA256 did.
+ * It is kept here as baseline.
+ */
+uint256
+OpenSslHash (const std::string& data)
+{
+  auto ctx = std::make_unique<SHA256_CTX> ();
+  SHA256_Init (ctx.get ());
+  SHA256_Update (ctx.get (), data.data (), data.size ());
+
+  unsigned char out[SHA256_DIGEST_LENGTH];
+  SHA256_Final (out, ctx.get ());
+
+  uint256 res;
+  res.FromBlob (out);
+  return res;
+}
+
+/**
+ * Constructs a list of n messages, each of the given size.
+ */
+std::vector<std::string>
+BuildMessages (const size_t n, const size_t size)
+{
+  std::vector<std::string> res;
+  for (size_t i = 0; i < n; ++i)
+    res.push_back (std::string (size, static_cast<char> (i)));
+  return res;
+}
+
+void
+OpenSslSingle (benchmark::State& state)
+{
+  const std::string data(state.range (0), 'x');
+  for (auto _ : state)
+    benchmark::DoNotOptimize (OpenSslHash (data));
+  state.SetBytesProcessed (state.iterations () * data.size ());
+}
+BENCHMARK (OpenSslSingle)->Arg (32)->Arg (200)->Arg (1 << 14);
+
+void
+Sha256Single (benchmark::State& state)
+{
+  const std::string data(state.range (0), 'x');
+  for (auto _ : state)
+    benchmark::DoNotOptimize (SHA256::Hash (data));
+  state.SetBytesProcessed (state.iterations () * data.size ());
+}
+BENCHMARK (Sha256Single)->Arg (32)->Arg (200)->Arg (1 << 14);
+
+void
+OpenSslMany (benchmark::State& state)
+{
+  const auto msg = BuildMessages (64, state.range (0));
+  for (auto _ : state)
+    for (const auto& m : msg)
+      benchmark::DoNotOptimize (OpenSslHash (m));
+  state.SetItemsProcessed (state.iterations () * msg.size ());
+}
+BENCHMARK (OpenSslMany)->Arg (32)->Arg (200);
+
+void
+Sha256Batch (benchmark::State& state)
+{
+  const auto msg = BuildMessages (64, state.range (0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize (SHA256::HashBatch (msg));
+  state.SetItemsProcessed (state.iterations () * msg.size ());
+}
+BENCHMARK (Sha256Batch)->Arg (32)->Arg (200);
+
+} // anonymous namespace
+} // namespace xaya
@@ -1,4 +1,4 @@
-// Copyright (C) 2019 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -6,6 +6,9 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
+#include <vector>
+
 namespace xaya
 {
 namespace
@@ -55,5 +58,45 @@ TEST_F (SHA256Tests, UtilityHash)
       "c3ab8ff13720e8ad9047dd39466b3c8974e592c2fa383d4a3960714caef0c4f2");
 }
 
+TEST_F (SHA256Tests, PiecewiseUpdate)
+{
+  std::string data;
+  for (int i = 0; i < 300; ++i)
+    data.push_back (static_cast<char> (i));
+
+  for (const size_t piece : {1, 7, 63, 64, 65, 200})
+    {
+      SHA256 h;
+      for (size_t pos = 0; pos < data.size (); pos += piece)
+        h << data.substr (pos, piece);
+      EXPECT_EQ (h.Finalise (), SHA256::Hash (data)) << "Piece size " << piece;
+    }
+}
+
+TEST_F (SHA256Tests, Batch)
+{
+  EXPECT_TRUE (SHA256::HashBatch ({}).empty ());
+
+  /* Use messages with lengths around the padding boundaries, and a number
+     of them that is not a multiple of the parallel lanes used internally
+     by the AVX2 code.  */
+  std::vector<std::string> data;
+  for (const size_t len : {0, 1, 32, 55, 56, 63, 64, 65, 119, 120, 128, 300})
+    {
+      std::string cur;
+      for (size_t i = 0; i < len; ++i)
+        cur.push_back (static_cast<char> (i * 7 + len));
+      data.push_back (cur);
+    }
+  data.push_back ("foobar");
+
+  const auto hashes = SHA256::HashBatch (data);
+  ASSERT_EQ (hashes.size (), data.size ());
+  for (size_t i = 0; i < data.size (); ++i)
+    EXPECT_EQ (hashes[i], SHA256::Hash (data[i])) << "Message " << i;
+  EXPECT_EQ (hashes.back ().ToHex (),
+      "c3ab8ff13720e8ad9047dd39466b3c8974e592c2fa383d4a3960714caef0c4f2");
+}
+
 } // anonymous namespace
 } // namespace xaya
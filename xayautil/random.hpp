@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2022 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -7,6 +7,8 @@
 
 #include "uint256.hpp"
 
+#include <cstddef>
+#include <string>
 #include <vector>
 
 namespace xaya
@@ -31,6 +33,12 @@ private:
   /** Index of the next byte to give out for the current seed.  */
   unsigned nextIndex;
 
+  /**
+   * Replaces the seed by the next one (its hash), after all its bytes
+   * have been given out.
+   */
+  void NextSeed ();
+
 public:
 
   /**
@@ -74,6 +82,13 @@ public:
   template <typename T>
     T Next ();
 
+  /**
+   * Fills the given buffer with the next n bytes of the random stream.
+   * This yields exactly the same bytes as n calls to Next<unsigned char>,
+   * but copies them over a full seed block at a time.
+   */
+  void Fill (unsigned char* out, size_t n);
+
   /**
    * Returns a random integer i with 0 <= i < n based on this instance's
    * random number stream.
@@ -1,4 +1,4 @@
-// Copyright (C) 2020 The Xaya developers
+// Copyright (C) 2020-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -20,14 +20,15 @@ template <typename Iterator>
   void
   Random::ShuffleN (Iterator begin, Iterator end, const size_t n)
 {
-  if (end - begin <= 1 || n == 0)
-    return;
-
-  const Iterator mid = begin + NextInt (end - begin);
-  if (begin != mid)
-    std::swap (*begin, *mid);
-
-  ShuffleN (begin + 1, end, n - 1);
+  /* In each step, a random element of the remaining range is moved to
+     its front, and the range is shrunk by one.  */
+  size_t steps = n;
+  for (; end - begin > 1 && steps > 0; ++begin, --steps)
+    {
+      const Iterator mid = begin + NextInt (end - begin);
+      if (begin != mid)
+        std::swap (*begin, *mid);
+    }
 }
 
 } // namespace xaya
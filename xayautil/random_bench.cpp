@@ -0,0 +1,83 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "random.hpp"
+
+#include "hash.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <numeric>
+#include <vector>
+
+namespace xaya
+{
+namespace
+{
+
+/**
+ * Returns a Random instance seeded with a fixed value.
+ */
+Random
+SeededRandom ()
+{
+  Random rnd;
+  rnd.Seed (SHA256::Hash ("bench"));
+  return rnd;
+}
+
+template <typename T>
+  void
+  RandomNext (benchmark::State& state)
+{
+  Random rnd = SeededRandom ();
+  for (auto _ : state)
+    benchmark::DoNotOptimize (rnd.Next<T> ());
+  state.SetBytesProcessed (state.iterations () * sizeof (T));
+}
+BENCHMARK_TEMPLATE (RandomNext, unsigned char);
+BENCHMARK_TEMPLATE (RandomNext, uint32_t);
+BENCHMARK_TEMPLATE (RandomNext, uint64_t);
+
+void
+RandomFill (benchmark::State& state)
+{
+  Random rnd = SeededRandom ();
+  std::vector<unsigned char> buf(state.range (0));
+  for (auto _ : state)
+    {
+      rnd.Fill (buf.data (), buf.size ());
+      benchmark::DoNotOptimize (buf.data ());
+    }
+  state.SetBytesProcessed (state.iterations () * buf.size ());
+}
+BENCHMARK (RandomFill)->Arg (32)->Arg (1 << 10)->Arg (1 << 16);
+
+void
+RandomNextInt (benchmark::State& state)
+{
+  Random rnd = SeededRandom ();
+  const uint32_t n = state.range (0);
+  for (auto _ : state)
+    benchmark::DoNotOptimize (rnd.NextInt (n));
+}
+BENCHMARK (RandomNextInt)->Arg (6)->Arg (1'000'000);
+
+void
+RandomShuffle (benchmark::State& state)
+{
+  Random rnd = SeededRandom ();
+  std::vector<unsigned> data(state.range (0));
+  std::iota (data.begin (), data.end (), 0);
+  for (auto _ : state)
+    {
+      rnd.Shuffle (data.begin (), data.end ());
+      benchmark::DoNotOptimize (data.data ());
+    }
+  state.SetItemsProcessed (state.iterations () * data.size ());
+}
+BENCHMARK (RandomShuffle)->Arg (10)->Arg (1'000)->Arg (100'000);
+
+} // anonymous namespace
+} // namespace xaya
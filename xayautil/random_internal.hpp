@@ -0,0 +1,102 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+/* This file contains implementation details shared between the different
+   deterministic random-number generators (Random and CounterRandom).  They
+   are written against a generic generator type, which only needs to
+   provide the Fill method and Next<uint64_t>.  */
+
+#ifndef XAYAUTIL_RANDOM_INTERNAL_HPP
+#define XAYAUTIL_RANDOM_INTERNAL_HPP
+
+#include <glog/logging.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace xaya
+{
+
+namespace
+{
+
+/**
+ * Extracts an integer of type T from the generator.  The bytes are
+ * combined in a big-endian fashion.
+ */
+template <typename T, typename Gen>
+  T
+  NextBigEndian (Gen& rnd)
+{
+  unsigned char bytes[sizeof (T)];
+  rnd.Fill (bytes, sizeof (T));
+
+  T res = 0;
+  for (const unsigned char b : bytes)
+    {
+      res <<= 8;
+      res |= b;
+    }
+
+  return res;
+}
+
+/**
+ * Returns a uniformly distributed integer i with 0 <= i < n.
+ */
+template <typename Gen>
+  uint32_t
+  NextIntFrom (Gen& rnd, const uint32_t n)
+{
+  CHECK_GT (n, 0);
+
+  /* If we just take a random uint64 x and return "x % n", then smaller numbers
+     are (very slightly) more probable than larger ones.  But if we make sure
+     that x is from a range [0, m) where m is a multiple of n, then all
+     numbers are equally likely to occur from the mod.  We can achieve this
+     by rerolling x if it is larger than m.  This is negligible probability of
+     occuring, so it is not hard performance wise either.  */
+
+  const uint64_t factor = std::numeric_limits<uint64_t>::max () / n;
+  const uint64_t m = factor * n;
+
+  while (true)
+    {
+      const uint64_t x = rnd.template Next<uint64_t> ();
+      if (x < m)
+        return x % n;
+    }
+}
+
+/**
+ * Selects an index into the weights array, with probability proportional
+ * to the weight at each index.
+ */
+template <typename Gen>
+  size_t
+  SelectByWeightFrom (Gen& rnd, const std::vector<uint32_t>& weights)
+{
+  uint64_t totalWeights = 0;
+  for (const auto w : weights)
+    totalWeights += w;
+  CHECK_LE (totalWeights, std::numeric_limits<uint32_t>::max ());
+
+  uint32_t roll = NextIntFrom (rnd, totalWeights);
+  for (size_t i = 0; i < weights.size (); ++i)
+    {
+      if (roll < weights[i])
+        return i;
+      roll -= weights[i];
+    }
+
+  LOG (FATAL) << "No option selected";
+}
+
+} // anonymous namespace
+
+} // namespace xaya
+
+#endif // XAYAUTIL_RANDOM_INTERNAL_HPP
@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2020 The Xaya developers
+// Copyright (C) 2019-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -9,6 +9,7 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <limits>
 #include <map>
 #include <sstream>
@@ -65,6 +66,26 @@ TEST_F (RandomTests, Bytes)
     ASSERT_EQ (rnd.Next<uint8_t> (), b);
 }
 
+TEST_F (RandomTests, Fill)
+{
+  /* Fill should yield the same bytes as Next<uint8_t>, independently of
+     how the requests are split up and aligned to the seed blocks.  */
+  Random other;
+  uint256 seed;
+  ASSERT_TRUE (seed.FromHex (SEED));
+  other.Seed (seed);
+
+  for (const size_t n : {0, 1, 5, 32, 27, 100, 64})
+    {
+      std::vector<unsigned char> buf(n);
+      rnd.Fill (buf.data (), n);
+      for (const auto b : buf)
+        ASSERT_EQ (b, other.Next<uint8_t> ());
+    }
+
+  EXPECT_EQ (rnd.Next<uint64_t> (), other.Next<uint64_t> ());
+}
+
 TEST_F (RandomTests, Bits)
 {
   ASSERT_EQ (rnd.Next<bool> (), false);
@@ -247,6 +268,20 @@ TEST_F (ShuffleTests, AllPermutationsPossible)
     EXPECT_GE (entry.second, threshold);
 }
 
+TEST_F (ShuffleTests, LargeRange)
+{
+  /* Shuffling is iterative, so even very large ranges work without
+     running out of stack space.  */
+  std::vector<int> input(1'000'000);
+  for (size_t i = 0; i < input.size (); ++i)
+    input[i] = i;
+
+  auto shuffled = Shuffle (input);
+  EXPECT_NE (shuffled, input);
+  std::sort (shuffled.begin (), shuffled.end ());
+  EXPECT_EQ (shuffled, input);
+}
+
 TEST_F (ShuffleTests, DegenerateShuffleN)
 {
   EXPECT_THAT (ShuffleN ({}, 10), ElementsAre ());
@@ -1,4 +1,4 @@
-// Copyright (C) 2018 The Xaya developers
+// Copyright (C) 2018-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -7,66 +7,106 @@
 #include <glog/logging.h>
 
 #include <algorithm>
-#include <cstdio>
+#include <cstring>
 
 namespace xaya
 {
 
+namespace
+{
+
+/** The hex digits used for output.  */
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+/** Marker in the decoding table for invalid characters.  */
+constexpr int8_t INVALID_DIGIT = -1;
+
+/**
+ * Lookup table for encoding a byte to two hex characters.  Entry i
+ * contains the characters for byte i at positions 2 * i and 2 * i + 1.
+ */
+const std::array<char, 2 * 256> ENCODE_TABLE = [] ()
+  {
+    std::array<char, 2 * 256> res;
+    for (int i = 0; i < 256; ++i)
+      {
+        res[2 * i] = HEX_DIGITS[i >> 4];
+        res[2 * i + 1] = HEX_DIGITS[i & 0xF];
+      }
+    return res;
+  } ();
+
+/**
+ * Lookup table for decoding hex characters to their values.
+ */
+const std::array<int8_t, 256> DECODE_TABLE = [] ()
+  {
+    std::array<int8_t, 256> res;
+    res.fill (INVALID_DIGIT);
+    for (int i = 0; i < 10; ++i)
+      res['0' + i] = i;
+    for (int i = 0; i < 6; ++i)
+      {
+        res['a' + i] = 0xA + i;
+        res['A' + i] = 0xA + i;
+      }
+    return res;
+  } ();
+
+} // anonymous namespace
+
 std::string
 uint256::ToHex () const
 {
-  std::string result(NUM_BYTES * 2, 'x');
-  for (size_t i = 0; i < NUM_BYTES; ++i)
-    std::sprintf (&result[2 * i], "%02x", static_cast<uint8_t> (data[i]));
+  std::string result(HEX_LENGTH, 'x');
+  ToHex (&result[0]);
   return result;
 }
 
-namespace
-{
-
-bool
-ParseHexDigit (const char digit, uint_fast8_t& target)
+void
+uint256::ToHex (char* out) const
 {
-  if (digit >= '0' && digit <= '9')
-    {
-      target = (digit - '0');
-      return true;
-    }
-
-  if (digit >= 'a' && digit <= 'f')
-    {
-      target = 0xA + (digit - 'a');
-      return true;
-    }
-  if (digit >= 'A' && digit <= 'F')
+  for (size_t i = 0; i < NUM_BYTES; ++i)
     {
-      target = 0xA + (digit - 'A');
-      return true;
+      const char* digits = &ENCODE_TABLE[2 * data[i]];
+      out[2 * i] = digits[0];
+      out[2 * i + 1] = digits[1];
     }
-
-  LOG (ERROR) << "Invalid hex digit: '" << digit << "'";
-  return false;
 }
 
-} // anonymous namespace
-
 bool
 uint256::FromHex (const std::string& hex)
 {
-  if (hex.size () != NUM_BYTES * 2)
+  return FromHex (hex.data (), hex.size ());
+}
+
+bool
+uint256::FromHex (const char* hex, const size_t len)
+{
+  if (len != HEX_LENGTH)
     {
-      LOG (ERROR) << "Invalid-sized string for uint256: " << hex;
+      LOG (ERROR)
+          << "Invalid-sized string for uint256: " << std::string (hex, len);
       return false;
     }
 
+  /* We decode all digits and only check afterwards whether any of them was
+     invalid, so that the loop has no data-dependent branches.  */
   Array newData;
+  int8_t invalid = 0;
   for (size_t i = 0; i < NUM_BYTES; ++i)
     {
-      uint_fast8_t hi, lo;
-      if (!ParseHexDigit (hex[2 * i], hi)
-            || !ParseHexDigit (hex[2 * i + 1], lo))
-        return false;
-      newData[i] = (hi << 4) | lo;
+      const int8_t hi = DECODE_TABLE[static_cast<unsigned char> (hex[2 * i])];
+      const int8_t lo
+          = DECODE_TABLE[static_cast<unsigned char> (hex[2 * i + 1])];
+      invalid |= hi | lo;
+      newData[i] = ((hi & 0xF) << 4) | (lo & 0xF);
+    }
+
+  if (invalid < 0)
+    {
+      LOG (ERROR) << "Invalid hex digit in: " << std::string (hex, len);
+      return false;
     }
 
   data = std::move (newData);
@@ -98,4 +138,23 @@ uint256::SetNull ()
   std::fill (data.begin (), data.end (), 0);
 }
 
+uint64_t
+uint256::GetFingerprint () const
+{
+  /* Load the bytes as four 64-bit words (in native byte order, since the
+     result only has to be consistent within the process) and fold them
+     with a multiplicative mix.  A plain XOR would map e.g. all values with
+     four identical words to zero.  */
+  constexpr uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ull;
+  uint64_t res = 0;
+  for (size_t i = 0; i < NUM_BYTES; i += sizeof (uint64_t))
+    {
+      uint64_t word;
+      std::memcpy (&word, data.data () + i, sizeof (word));
+      res = (res ^ word) * MULTIPLIER;
+    }
+
+  return res;
+}
+
 } // namespace xaya
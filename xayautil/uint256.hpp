@@ -1,4 +1,4 @@
-// Copyright (C) 2018-2019 The Xaya developers
+// Copyright (C) 2018-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -6,6 +6,9 @@
 #define XAYAUTIL_UINT256_HPP
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <string>
 
 namespace xaya
@@ -23,6 +26,9 @@ public:
 
   static constexpr size_t NUM_BYTES = 256 / 8;
 
+  /** Number of characters in the hex representation.  */
+  static constexpr size_t HEX_LENGTH = 2 * NUM_BYTES;
+
 private:
 
   using Array = std::array<unsigned char, NUM_BYTES>;
@@ -46,12 +52,25 @@ public:
    */
   std::string ToHex () const;
 
+  /**
+   * Writes the lower-case, big-endian hex representation into the given
+   * buffer, which must have room for HEX_LENGTH characters.  No terminating
+   * NUL character is written.  This does not allocate any memory.
+   */
+  void ToHex (char* out) const;
+
   /**
    * Parses a hex string as big-endian into this object.  Returns false if
    * the string is not valid (wrong size or invalid characters).
    */
   bool FromHex (const std::string& hex);
 
+  /**
+   * Parses hex characters from a buffer of the given length (which must
+   * be HEX_LENGTH for the data to be valid).
+   */
+  bool FromHex (const char* hex, size_t len);
+
   /**
    * Returns a pointer to the data blob that holds the raw binary data.
    * Its length is NUM_BYTES.
@@ -84,6 +103,15 @@ public:
    */
   void SetNull ();
 
+  /**
+   * Returns a 64-bit fingerprint of the value, which can be used for
+   * hashing.  Since uint256 values are typically hashes themselves,
+   * this just cheaply folds the raw bytes together.  It is not suitable in
+   * situations where an attacker may choose the values freely to
+   * provoke collisions.
+   */
+  uint64_t GetFingerprint () const;
+
   friend bool
   operator== (const uint256& a, const uint256& b)
   {
@@ -106,4 +134,25 @@ public:
 
 } // namespace xaya
 
+namespace std
+{
+
+/**
+ * Hash specialisation, so that uint256 can be used as key
+ * in unordered containers.
+ */
+template <>
+  struct hash<xaya::uint256>
+{
+
+  size_t
+  operator() (const xaya::uint256& val) const
+  {
+    return static_cast<size_t> (val.GetFingerprint ());
+  }
+
+};
+
+} // namespace std
+
 #endif // XAYAUTIL_UINT256_HPP
@@ -0,0 +1,65 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "uint256.hpp"
+
+#include "hash.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+namespace xaya
+{
+namespace
+{
+
+void
+Uint256ToHexString (benchmark::State& state)
+{
+  const uint256 val = SHA256::Hash ("bench");
+  for (auto _ : state)
+    benchmark::DoNotOptimize (val.ToHex ());
+  state.SetBytesProcessed (state.iterations () * uint256::NUM_BYTES);
+}
+BENCHMARK (Uint256ToHexString);
+
+void
+Uint256ToHexBuffer (benchmark::State& state)
+{
+  const uint256 val = SHA256::Hash ("bench");
+  char out[uint256::HEX_LENGTH];
+  for (auto _ : state)
+    {
+      val.ToHex (out);
+      benchmark::DoNotOptimize (out);
+    }
+  state.SetBytesProcessed (state.iterations () * uint256::NUM_BYTES);
+}
+BENCHMARK (Uint256ToHexBuffer);
+
+void
+Uint256FromHex (benchmark::State& state)
+{
+  const std::string hex = SHA256::Hash ("bench").ToHex ();
+  uint256 val;
+  for (auto _ : state)
+    benchmark::DoNotOptimize (val.FromHex (hex));
+  state.SetBytesProcessed (state.iterations () * uint256::NUM_BYTES);
+}
+BENCHMARK (Uint256FromHex);
+
+void
+Uint256FromHexInvalid (benchmark::State& state)
+{
+  std::string hex = SHA256::Hash ("bench").ToHex ();
+  hex.back () = 'x';
+  uint256 val;
+  for (auto _ : state)
+    benchmark::DoNotOptimize (val.FromHex (hex));
+}
+BENCHMARK (Uint256FromHexInvalid);
+
+} // anonymous namespace
+} // namespace xaya
@@ -1,4 +1,4 @@
-// Copyright (C) 2018 The Xaya developers
+// Copyright (C) 2018-2026 The Xaya developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -6,7 +6,9 @@
 
 #include <gtest/gtest.h>
 
+#include <cctype>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 namespace xaya
@@ -50,6 +52,46 @@ TEST (Uint256Tests, ToHex)
   EXPECT_EQ (obj.ToHex (), hex);
 }
 
+TEST (Uint256Tests, ToHexBuffer)
+{
+  const std::string hex("0123456789abcdef" + std::string (46, '0') + "ff");
+
+  uint256 obj;
+  ASSERT_TRUE (obj.FromHex (hex));
+
+  char buf[uint256::HEX_LENGTH + 1];
+  buf[uint256::HEX_LENGTH] = '!';
+  obj.ToHex (buf);
+  EXPECT_EQ (std::string (buf, uint256::HEX_LENGTH), hex);
+  EXPECT_EQ (buf[uint256::HEX_LENGTH], '!');
+}
+
+TEST (Uint256Tests, HexDigits)
+{
+  for (int c = 0; c < 256; ++c)
+    {
+      const char chr = static_cast<char> (c);
+      const bool valid = (chr >= '0' && chr <= '9')
+                            || (chr >= 'a' && chr <= 'f')
+                            || (chr >= 'A' && chr <= 'F');
+
+      for (const size_t pos : {0, 1, 33, 63})
+        {
+          std::string hex(64, '0');
+          hex[pos] = chr;
+
+          uint256 obj;
+          ASSERT_EQ (obj.FromHex (hex), valid) << "Character " << c;
+          if (valid)
+            {
+              for (auto& h : hex)
+                h = std::tolower (h);
+              EXPECT_EQ (obj.ToHex (), hex);
+            }
+        }
+    }
+}
+
 TEST (Uint256Tests, Comparison)
 {
   const std::string strLow(std::string (62, '0') + "ff");
@@ -116,5 +158,25 @@ TEST (Uint256Tests, SetNull)
   EXPECT_EQ (obj.ToHex (), std::string (64, '0'));
 }
 
+TEST (Uint256Tests, Hashing)
+{
+  uint256 a, b, c;
+  ASSERT_TRUE (a.FromHex (std::string (64, '1')));
+  ASSERT_TRUE (b.FromHex (std::string (64, '1')));
+  ASSERT_TRUE (c.FromHex (std::string (62, '1') + "12"));
+
+  EXPECT_EQ (a.GetFingerprint (), b.GetFingerprint ());
+  EXPECT_NE (a.GetFingerprint (), c.GetFingerprint ());
+
+  uint256 null;
+  null.SetNull ();
+  EXPECT_NE (a.GetFingerprint (), null.GetFingerprint ());
+
+  std::unordered_set<uint256> set = {a, b, c};
+  EXPECT_EQ (set.size (), 2);
+  EXPECT_EQ (set.count (a), 1);
+  EXPECT_EQ (set.count (null), 0);
+}
+
 } // anonymous namespace
 } // namespace xaya
@@ -0,0 +1,102 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "weightedsampler.hpp"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace xaya
+{
+
+WeightedSampler::WeightedSampler (const std::vector<uint32_t>& weights)
+{
+  CHECK (!weights.empty ()) << "No weights given for WeightedSampler";
+  CHECK_LE (weights.size (), std::numeric_limits<uint32_t>::max ());
+
+  uint64_t sum = 0;
+  cumulative.reserve (weights.size ());
+  for (const auto w : weights)
+    {
+      sum += w;
+      CHECK_LE (sum, std::numeric_limits<uint32_t>::max ());
+      cumulative.push_back (sum);
+    }
+
+  CHECK_GT (sum, 0) << "Total weight for WeightedSampler is zero";
+  totalWeight = sum;
+
+  BuildAliasTable (weights);
+}
+
+void
+WeightedSampler::BuildAliasTable (const std::vector<uint32_t>& weights)
+{
+  const uint64_t n = weights.size ();
+
+  /* All weights are scaled by n, so that their average is exactly the total
+     weight.  This way, all computations are exact in integers (and thus
+     deterministic), and the thresholds end up in the range [0, total].  */
+  std::vector<uint64_t> scaled(n);
+  std::vector<uint32_t> small, large;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      scaled[i] = weights[i] * n;
+      if (scaled[i] < totalWeight)
+        small.push_back (i);
+      else
+        large.push_back (i);
+    }
+
+  threshold.assign (n, totalWeight);
+  alias.resize (n);
+  for (uint32_t i = 0; i < n; ++i)
+    alias[i] = i;
+
+  while (!small.empty () && !large.empty ())
+    {
+      const uint32_t s = small.back ();
+      small.pop_back ();
+      const uint32_t l = large.back ();
+
+      threshold[s] = scaled[s];
+      alias[s] = l;
+
+      scaled[l] -= totalWeight - scaled[s];
+      if (scaled[l] < totalWeight)
+        {
+          large.pop_back ();
+          small.push_back (l);
+        }
+    }
+
+  /* Since everything is exact, all remaining entries must be exactly
+     at the average.  They keep the default threshold of "total".  */
+  for (const auto i : small)
+    CHECK_EQ (scaled[i], totalWeight);
+  for (const auto i : large)
+    CHECK_EQ (scaled[i], totalWeight);
+}
+
+size_t
+WeightedSampler::Select (Random& rnd) const
+{
+  const uint32_t roll = rnd.NextInt (totalWeight);
+  const auto mit = std::upper_bound (cumulative.begin (), cumulative.end (),
+                                     roll);
+  CHECK (mit != cumulative.end ());
+  return mit - cumulative.begin ();
+}
+
+size_t
+WeightedSampler::SelectConstantTime (Random& rnd) const
+{
+  const uint32_t i = rnd.NextInt (threshold.size ());
+  const uint32_t roll = rnd.NextInt (totalWeight);
+  return roll < threshold[i] ? i : alias[i];
+}
+
+} // namespace xaya
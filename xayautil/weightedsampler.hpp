@@ -0,0 +1,106 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef XAYAUTIL_WEIGHTEDSAMPLER_HPP
+#define XAYAUTIL_WEIGHTEDSAMPLER_HPP
+
+#include "random.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace xaya
+{
+
+/**
+ * A precomputed table for repeatedly selecting an index based on a fixed
+ * set of weights, like Random::SelectByWeight does.  This is useful if
+ * games draw many times from the same distribution (e.g. loot tables),
+ * as the weights are validated and preprocessed only once.
+ *
+ * Since the results are consensus-relevant for games, the exact mapping
+ * from the Random stream to the selected index is specified (and fixed)
+ * for both of the selection methods below.
+ */
+class WeightedSampler
+{
+
+private:
+
+  /** Sum of all weights.  */
+  uint32_t totalWeight;
+
+  /**
+   * Cumulative weights, i.e. cumulative[i] is the sum of all weights up to
+   * and including index i.
+   */
+  std::vector<uint32_t> cumulative;
+
+  /**
+   * Threshold values of the alias table.  These are scaled such that
+   * totalWeight means "always take the index itself".
+   */
+  std::vector<uint32_t> threshold;
+
+  /** Alias indices of the alias table.  */
+  std::vector<uint32_t> alias;
+
+  /**
+   * Builds up the alias table.
+   */
+  void BuildAliasTable (const std::vector<uint32_t>& weights);
+
+public:
+
+  /**
+   * Constructs the sampler for the given weights.  The weights must
+   * not be empty, and their sum must be positive and representable in
+   * an uint32 (the same conditions as for Random::SelectByWeight).
+   * Individual weights may be zero; such indices are never selected.
+   */
+  explicit WeightedSampler (const std::vector<uint32_t>& weights);
+
+  WeightedSampler () = delete;
+  WeightedSampler (const WeightedSampler&) = default;
+  WeightedSampler& operator= (const WeightedSampler&) = default;
+
+  /**
+   * Returns the number of entries.
+   */
+  size_t
+  GetSize () const
+  {
+    return cumulative.size ();
+  }
+
+  /**
+   * Selects an index in O(log n) time by binary search over the cumulative
+   * weights.  The result (and the consumed random numbers) are exactly the
+   * same as for Random::SelectByWeight with the same weights:  A single
+   * value r = rnd.NextInt (total) is drawn, and the smallest index i is
+   * returned whose cumulative weight is larger than r.
+   */
+  size_t Select (Random& rnd) const;
+
+  /**
+   * Selects an index in O(1) time using the alias method.  The probability
+   * of each index is the same as with Select, but the mapping from the
+   * random stream to the result is different:  First i = rnd.NextInt (n)
+   * and then r = rnd.NextInt (total) are drawn (always both).  If r is
+   * less than the threshold of i, i is returned, and otherwise its alias.
+   *
+   * The alias table is built with exact integer arithmetic (Vose's method),
+   * where indices with scaled weight below the average are paired with ones
+   * above it.  Both worklists are initialised in increasing index order
+   * and processed from the back, which makes the table unique for a given
+   * set of weights.
+   */
+  size_t SelectConstantTime (Random& rnd) const;
+
+};
+
+} // namespace xaya
+
+#endif // XAYAUTIL_WEIGHTEDSAMPLER_HPP
@@ -0,0 +1,77 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "weightedsampler.hpp"
+
+#include "hash.hpp"
+#include "random.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace xaya
+{
+namespace
+{
+
+/**
+ * Constructs a list of n (non-uniform) weights.
+ */
+std::vector<uint32_t>
+BuildWeights (const size_t n)
+{
+  std::vector<uint32_t> res;
+  for (size_t i = 0; i < n; ++i)
+    res.push_back (1 + (i * 7919) % 1'000);
+  return res;
+}
+
+void
+SelectByWeight (benchmark::State& state)
+{
+  const auto weights = BuildWeights (state.range (0));
+  Random rnd;
+  rnd.Seed (SHA256::Hash ("bench"));
+  for (auto _ : state)
+    benchmark::DoNotOptimize (rnd.SelectByWeight (weights));
+}
+BENCHMARK (SelectByWeight)->Arg (10)->Arg (1'000)->Arg (100'000);
+
+void
+SamplerSelect (benchmark::State& state)
+{
+  const WeightedSampler sampler(BuildWeights (state.range (0)));
+  Random rnd;
+  rnd.Seed (SHA256::Hash ("bench"));
+  for (auto _ : state)
+    benchmark::DoNotOptimize (sampler.Select (rnd));
+}
+BENCHMARK (SamplerSelect)->Arg (10)->Arg (1'000)->Arg (100'000);
+
+void
+SamplerSelectConstantTime (benchmark::State& state)
+{
+  const WeightedSampler sampler(BuildWeights (state.range (0)));
+  Random rnd;
+  rnd.Seed (SHA256::Hash ("bench"));
+  for (auto _ : state)
+    benchmark::DoNotOptimize (sampler.SelectConstantTime (rnd));
+}
+BENCHMARK (SamplerSelectConstantTime)->Arg (10)->Arg (1'000)->Arg (100'000);
+
+void
+SamplerConstruction (benchmark::State& state)
+{
+  const auto weights = BuildWeights (state.range (0));
+  for (auto _ : state)
+    {
+      WeightedSampler sampler(weights);
+      benchmark::DoNotOptimize (sampler.GetSize ());
+    }
+}
+BENCHMARK (SamplerConstruction)->Arg (1'000)->Arg (100'000);
+
+} // anonymous namespace
+} // namespace xaya
@@ -0,0 +1,110 @@
+// Copyright (C) 2026 The Xaya developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "weightedsampler.hpp"
+
+#include "hash.hpp"
+
+#include <gtest/gtest.h>
+
+#include <glog/logging.h>
+
+#include <limits>
+#include <vector>
+
+namespace xaya
+{
+namespace
+{
+
+class WeightedSamplerTests : public testing::Test
+{
+
+protected:
+
+  Random rnd;
+
+  WeightedSamplerTests ()
+  {
+    rnd.Seed (SHA256::Hash ("weighted sampler"));
+  }
+
+};
+
+TEST_F (WeightedSamplerTests, SelectMatchesSelectByWeight)
+{
+  Random other;
+  other.Seed (SHA256::Hash ("weighted sampler"));
+
+  const std::vector<std::vector<uint32_t>> tests = {
+    {1},
+    {55, 10, 35},
+    {0, 5, 0, 0, 3, 0},
+    {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13},
+    {std::numeric_limits<uint32_t>::max () - 1, 1},
+  };
+
+  for (const auto& weights : tests)
+    {
+      const WeightedSampler sampler(weights);
+      ASSERT_EQ (sampler.GetSize (), weights.size ());
+      for (unsigned i = 0; i < 1'000; ++i)
+        ASSERT_EQ (sampler.Select (rnd), other.SelectByWeight (weights));
+    }
+}
+
+TEST_F (WeightedSamplerTests, ConstantTimeDistribution)
+{
+  const std::vector<uint32_t> weights = {55, 10, 0, 35};
+  constexpr unsigned rolls = 1'000'000;
+
+  const WeightedSampler sampler(weights);
+  unsigned counts[] = {0, 0, 0, 0};
+  for (unsigned i = 0; i < rolls; ++i)
+    ++counts[sampler.SelectConstantTime (rnd)];
+
+  for (unsigned i = 0; i < weights.size (); ++i)
+    {
+      LOG (INFO)
+          << "Choice " << i << " with weight " << weights[i]
+          << " was selected " << counts[i] << " times";
+      EXPECT_GE (counts[i] + 10'000, 10'000 * weights[i]);
+      EXPECT_LE (counts[i], 10'000 * weights[i] + 10'000);
+    }
+
+  EXPECT_EQ (counts[2], 0);
+}
+
+TEST_F (WeightedSamplerTests, ConstantTimeGolden)
+{
+  /* The exact results are consensus-relevant for games, so we check them
+     against golden data to notice any accidental changes.  */
+  const std::vector<uint32_t> weights = {5, 1, 0, 2, 8, 3};
+  const WeightedSampler sampler(weights);
+
+  std::vector<size_t> actual;
+  for (unsigned i = 0; i < 20; ++i)
+    actual.push_back (sampler.SelectConstantTime (rnd));
+
+  const std::vector<size_t> expected = {
+    0, 4, 5, 4, 4, 5, 0, 1, 4, 5, 1, 1, 3, 4, 0, 5, 0, 0, 4, 0,
+  };
+  EXPECT_EQ (actual, expected);
+}
+
+TEST_F (WeightedSamplerTests, InvalidWeights)
+{
+  const std::vector<uint32_t> empty;
+  EXPECT_DEATH (WeightedSampler {empty}, "No weights");
+
+  const std::vector<uint32_t> zero = {0, 0};
+  EXPECT_DEATH (WeightedSampler {zero}, "Total weight");
+
+  const std::vector<uint32_t> overflow
+      = {std::numeric_limits<uint32_t>::max (), 1};
+  EXPECT_DEATH (WeightedSampler {overflow}, "");
+}
+
+} // anonymous namespace
+} // namespace xaya